@@ -0,0 +1,200 @@
+#pragma once
+
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Vertex.h"
+#include "Platform.h"
+
+/**
+ * @brief Scene and run settings taken from the command line.
+ *
+ *   --headless            Render offscreen for --frames frames and print timings, no window or input
+ *   --frames <n>          Frames rendered in headless mode
+ *   --cubes <n>           Number of cubes in the scene
+ *   --point-lights <n>    Number of point lights (at most MaxPointLights)
+ *   --spot-lights <n>     Number of spot lights (at most MaxSpotLights)
+ *   --width <px>          Offscreen framebuffer width
+ *   --height <px>         Offscreen framebuffer height
+ *   --mode <name>         Submission mode: per-draw, instanced, mdi, pull, gpu or meshlet
+ *                         (compare mdi and pull to measure vertex pulling against the VAO attribute path;
+ *                         the second copy of the geometry pull needs is only uploaded with --mode pull;
+ *                         meshlet draws a meshlet-culled terrain instead of the cubes and checks the
+ *                         compute pass against the CPU culler)
+ *   --no-sort             Submit draws in push order instead of sort key order
+ *   --octree              Cull through the loose octree instead of the flat SIMD scan
+ *   --no-occlusion        Skip the CPU occlusion test after frustum culling
+ *   --cull-bench          Check occlusion culling, compare octree and flat culling at 10k, 100k and 1M objects
+ *                         and time meshlet culling, CPU only
+ *   --transform-bench     Compare incremental and full transform hierarchy updates, CPU only
+ *   --import-bench        Check that a generated OBJ of more than one weld slice imports with smooth normals
+ *                         and report the vertex cache optimizer results, CPU only
+ *   --import <file>       Import a glTF/OBJ file at startup, print the import time and register its meshes
+ */
+struct BenchmarkOptions
+{
+    // Array sizes declared in TestLight.shader
+    static constexpr int MaxPointLights = 10;
+    static constexpr int MaxSpotLights = 10;
+
+    bool Headless = false;
+    uint32 Frames = 1000;
+    size_t Cubes = 10000;
+    int PointLights = 10;
+    int SpotLights = 10;
+    uint32 Width = 1920;
+    uint32 Height = 1080;
+    std::string Mode;
+    bool SortDraws = true;
+    bool OctreeCulling = false;
+    bool OcclusionCulling = true;
+    bool CullingBenchmark = false;
+    bool TransformBenchmark = false;
+    bool ImportBenchmark = false;
+    std::string ImportPath;
+
+    /**
+     * @brief Parses argv, prints the usage and returns nothing on unknown or malformed arguments.
+     */
+    [[nodiscard]] static std::optional<BenchmarkOptions> Parse(int argc, char** argv);
+
+    static void PrintUsage(std::ostream& stream, const char* program);
+};
+
+/**
+ * @brief Deterministic camera flight used by the headless benchmark.
+ *
+ * The camera orbits the scene once over the run while the radius and height
+ * oscillate, so every run sees the same mix of dense and sparse views.
+ */
+class CameraPath
+{
+public:
+    struct Sample
+    {
+        glm::vec3 Position;
+        glm::vec3 Target;
+    };
+
+    CameraPath(float worldSize, uint32 frameCount);
+
+    [[nodiscard]] Sample Evaluate(uint32 frame) const;
+
+private:
+    float WorldSize;
+    uint32 FrameCount;
+};
+
+/**
+ * @brief Rolling heightfield over [-worldSize, worldSize]^2 used by the meshlet benchmark and --mode meshlet.
+ *
+ * Triangles are emitted in tiles of TileQuads x TileQuads quads, 64 vertices
+ * each, so MeshletBuilder turns every tile into exactly one meshlet. The
+ * surface stays within a few units of y = 0, which the benchmark camera path
+ * dips below, so the normal cones get culled as well.
+ */
+struct TerrainGrid
+{
+    static constexpr uint32 TileQuads = 7;
+
+    std::vector<VertexPosNormalTangentUV3D> Vertices;
+    std::vector<uint32> Indices;
+
+    [[nodiscard]] static TerrainGrid Generate(float worldSize, uint32 tilesPerSide);
+};
+
+/**
+ * @brief Per-frame CPU timings of a benchmark run.
+ */
+class FrameTimings
+{
+public:
+    struct Frame
+    {
+        double CpuMs;     // Culling, sorting and command submission
+        double TotalMs;   // Whole frame including the wait for the GPU
+        size_t Visible;   // Objects submitted for drawing
+        size_t Occluded;  // Frustum survivors rejected by occlusion culling
+        uint32 Jobs;      // Jobs run on the job system
+        uint32 Steals;    // Jobs taken from another thread's deque
+        float WorkerUtilization;  // Busy fraction of the worker threads, 0-1
+    };
+
+    void Reserve(size_t frameCount) { Frames.reserve(frameCount); }
+
+    void Add(const Frame& frame) { Frames.push_back(frame); }
+
+    // One CSV line per frame: frame,cpu_ms,total_ms,visible,occluded,jobs,steals,worker_utilization
+    void PrintFrames(std::ostream& stream) const;
+
+    // Average, min, percentiles and max of both timings
+    void PrintSummary(std::ostream& stream) const;
+
+    [[nodiscard]] const std::vector<Frame>& GetFrames() const noexcept { return Frames; }
+
+private:
+    std::vector<Frame> Frames;
+};
+
+/**
+ * @brief Checks OcclusionCuller against a single box occluder in front of the camera.
+ *
+ * A sphere entirely behind the box must be occluded, spheres partly beside
+ * it or in front of it must be kept. Needs no GL context; returns false after
+ * reporting the first case that fails.
+ */
+bool RunOcclusionCheck(std::ostream& stream, const glm::mat4& projection);
+
+/**
+ * @brief Times flat and octree frustum culling along the benchmark camera path.
+ *
+ * Runs at 10k, 100k and 1M spheres of `objectRadius` spread uniformly over
+ * [-worldSize, worldSize]^3 and prints one row per size. Every frame also
+ * moves 1% of the objects to measure incremental octree updates. Needs no GL
+ * context.
+ *
+ * Every frame the flat, jobified and octree results are compared; returns
+ * false after reporting the first frame in which they differ.
+ */
+bool RunCullingBenchmark(std::ostream& stream, float worldSize, float objectRadius, const glm::mat4& projection, uint32 frameCount);
+
+/**
+ * @brief Times MeshletBuilder and MeshletCuller on generated heightfield grids.
+ *
+ * Splits grids of about 130k and 2M triangles over [-worldSize, worldSize]
+ * into meshlets and culls them along the benchmark camera path, which also
+ * passes below the surface where the normal cones reject the meshlets. Prints
+ * one row per grid. Needs no GL context.
+ */
+void RunMeshletBenchmark(std::ostream& stream, float worldSize, const glm::mat4& projection, uint32 frameCount);
+
+/**
+ * @brief Times TransformHierarchy updates for scenes of 13-node models.
+ *
+ * Runs at 10k, 100k and 1M nodes and prints one row per size: a full sweep,
+ * an incremental update with 1% of the models moving and one with nothing
+ * moving. Needs no GL context.
+ */
+void RunTransformBenchmark(std::ostream& stream, uint32 frameCount);
+
+/**
+ * @brief Imports a generated OBJ heightfield and checks the generated normals and tangents.
+ *
+ * The file has more triangles than one weld slice and no normals, so the
+ * importer welds it in several jobs and generates normals and tangents.
+ * Every vertex with the same position and texture coordinate must come out
+ * once, with the same normal and tangent. Writes the file to the temporary
+ * directory and needs no GL context; returns false after reporting the first
+ * vertex that fails.
+ */
+bool RunImportCheck(std::ostream& stream);
+
+/**
+ * @brief Prints ACMR and ATVR before and after MeshOptimizer for the cube and a heightfield grid.
+ *
+ * The grid is the one the meshlet benchmark uses at about 130k triangles.
+ * Needs no GL context.
+ */
+void RunMeshOptimizerReport(std::ostream& stream, float worldSize);
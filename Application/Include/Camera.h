@@ -85,6 +85,10 @@ public:
 	void processMouseMovement(float xpos, float ypos);
 	void processMouseScroll(float yoffset);
 
+	// Scripted control (benchmark camera paths)
+	void setPosition(const glm::vec3& newPosition) { position = newPosition; }
+	void lookAt(const glm::vec3& target);      // Points the camera at a world point, keeps worldUp
+
 	// Real camera functionality
 	void setMode(Mode mode) { cameraMode = mode; }
 	void autoExpose(float targetBrightness = 0.5f); // Auto exposure calculation
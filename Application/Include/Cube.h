@@ -1,32 +1,25 @@
 #pragma once
 #include <array>
+#include <span>
 #include <Vertex.h>
-#include <VAO.h>
-#include <VBO.h>
-#include <EBO.h>
-#include <Shaders.h>
+#include <MeshRegistry.h>
 
 class Cube 
 {
 
 public:
-	Cube();
-	~Cube();
+	// Uploads the shared cube geometry into the registry (only once) and returns its handle.
+	static MeshHandle RegisterMesh(MeshRegistry& registry);
 
-
-	void Draw();
-private:
-
-	void Setup();
+	// The geometry RegisterMesh() optimizes and uploads, for reports that need no GL context.
+	static std::span<const VertexPosNormalTangentUV3D> GetMeshVertices() { return cubeVertices; }
+	static std::span<const uint32_t> GetMeshIndices() { return cubeIndices; }
 
 public:
 	glm::vec3 position{ 0.0f };
+	MeshHandle mesh;
 
 private:
-	VertexArrayObject VAO;
-	VertexBufferObject VBO;
-	ElementBufferObject EBO;
-
 	static constexpr float h = 0.5f; // half side length
 
 	static const std::array<VertexPosNormalTangentUV3D, 24> cubeVertices;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "glm/glm.hpp"
+#include "AlignedAllocator.h"
+#include "Frustum.h"
+#include "Simd.h"
+#include "Platform.h"
+
+/**
+ * @brief Bounding-sphere frustum culling, stored as structure-of-arrays.
+ *
+ * Cull() tests all spheres against the six frustum planes, BatchWidth spheres
+ * at a time (8 with AVX2, 4 with SSE2), and writes the indices of the spheres
+ * that are at least partially inside into a compacted list. The list keeps the
+ * order in which the spheres were added, so passes that follow only touch the
+ * survivors and the result does not depend on how the work was split.
+ *
+ * Spheres are conservative: an object is kept while any part of its bounds
+ * can be on screen, so objects crossing the screen edge do not pop out.
+ */
+class CullingSystem
+{
+public:
+    static constexpr size_t BatchWidth = Simd::Native::Width;
+
+    // Spheres per job when culling is split across the job system, a multiple of every batch width
+    static constexpr size_t TaskGrainSize = 4096;
+
+    CullingSystem() = default;
+
+    void Reserve(size_t count);
+
+    /**
+     * @brief Adds a bounding sphere and returns its index.
+     */
+    uint32 Add(const glm::vec3& center, float radius);
+
+    /**
+     * @brief Replaces the bounding sphere of an object that moved, `index` must come from Add().
+     */
+    void Set(uint32 index, const glm::vec3& center, float radius);
+
+    void Clear();
+
+    /**
+     * @brief Culls every sphere in parallel on the job system and returns the number of visible ones.
+     */
+    size_t Cull(const Frustum& frustum);
+
+    /**
+     * @brief Culls spheres [begin, end) and writes the visible indices, in order, to `visible`.
+     *
+     * `begin` must be a multiple of BatchWidth and `visible` must have room for
+     * end - begin indices. Returns the number of indices written.
+     */
+    size_t CullRange(const Frustum& frustum, size_t begin, size_t end, uint32* visible) const;
+
+    [[nodiscard]] size_t GetCount() const noexcept { return Count; }
+
+    // Indices of the spheres that passed the last Cull(), ascending
+    [[nodiscard]] std::span<const uint32> GetVisible() const noexcept { return { Visible.data(), VisibleCount }; }
+
+private:
+    size_t Count = 0;
+
+    AlignedVector<float> CenterX, CenterY, CenterZ;
+    AlignedVector<float> Radius;
+
+    std::vector<uint32> Visible;
+    std::vector<size_t> ChunkVisible;  // Survivors of every TaskGrainSize chunk before compaction
+    size_t VisibleCount = 0;
+};
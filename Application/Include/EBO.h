@@ -25,15 +25,19 @@ public:
 
     // Upload data to the EBO from const void*
     // This method uploads data to the EBO for the target GL_ELEMENT_ARRAY_BUFFER using raw pointers.
+    // With DSA the EBO does not need to be bound, so the element binding of the current VAO is left alone.
+    // GL_STATIC_DRAW data gets immutable storage, which later static uploads update in place while they fit.
+    // Larger data or another usage replaces the buffer object, so GetBufferID() changes and every VAO
+    // the buffer was attached to must attach it again.
     //
     // Parameters:
     // - size: The size in bytes of the data to be uploaded.
     // - data: A pointer to the data to be uploaded.
     // - usage: The expected usage pattern of the data store. Common values are GL_STATIC_DRAW, GL_DYNAMIC_DRAW, and GL_STREAM_DRAW.
-    inline void UploadData(GLsizeiptr size, const void* data, GLenum usage = GL_STATIC_DRAW) const
-    {
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
-    }
+    //
+    // Returns:
+    // - true if the buffer object was replaced and GetBufferID() changed.
+    bool UploadData(GLsizeiptr size, const void* data, GLenum usage = GL_STATIC_DRAW);
 
     // Upload data to the EBO from std::vector
     // This method uploads data to the EBO using a std::vector.
@@ -42,9 +46,9 @@ public:
     // - data: The std::vector containing the data to be uploaded.
     // - usage: The expected usage pattern of the data store.
     template <typename T>
-    inline void UploadData(const std::vector<T>& data, GLenum usage = GL_STATIC_DRAW) const
+    inline bool UploadData(const std::vector<T>& data, GLenum usage = GL_STATIC_DRAW)
     {
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(T), data.data(), usage);
+        return UploadData(static_cast<GLsizeiptr>(data.size() * sizeof(T)), data.data(), usage);
     }
 
     // Upload data to the EBO from std::array
@@ -54,9 +58,9 @@ public:
     // - data: The std::array containing the data to be uploaded.
     // - usage: The expected usage pattern of the data store.
     template <typename T, std::size_t N>
-    inline void UploadData(const std::array<T, N>& data, GLenum usage = GL_STATIC_DRAW) const
+    inline bool UploadData(const std::array<T, N>& data, GLenum usage = GL_STATIC_DRAW)
     {
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(T), data.data(), usage);
+        return UploadData(static_cast<GLsizeiptr>(data.size() * sizeof(T)), data.data(), usage);
     }
 
     // Get the buffer ID
@@ -67,7 +71,9 @@ public:
     inline const GLuint GetBufferID() const { return BufferID; }
 
 private:
-    GLuint BufferID;  // OpenGL ID for the Element Buffer Object (EBO)
+    GLuint BufferID;         // OpenGL ID for the Element Buffer Object (EBO)
+    bool Immutable = false;  // Storage was allocated with glNamedBufferStorage
+    GLsizeiptr StorageSize = 0;  // Bytes of the immutable storage
 };
 
 using IndexBufferObject = ElementBufferObject;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "Platform.h"
+
+class FrameBufferObject
+{
+public:
+    // Constructor
+    // Creates a framebuffer with an RGBA8 color and a 24-bit depth / 8-bit stencil renderbuffer.
+    //
+    // Parameters:
+    // - width: The width of the attachments in pixels.
+    // - height: The height of the attachments in pixels.
+    FrameBufferObject(uint32 width, uint32 height);
+
+    // Destructor
+    // Deletes the framebuffer and its renderbuffers.
+    ~FrameBufferObject();
+
+    // FBOs own GPU storage, copying would double-delete the IDs
+    FrameBufferObject(const FrameBufferObject&) = delete;
+    FrameBufferObject& operator=(const FrameBufferObject&) = delete;
+
+    // Bind the FBO
+    // Makes the FBO the draw and read framebuffer and sets the viewport to cover it.
+    void Bind() const;
+
+    // Unbind the FBO
+    // Binds the default framebuffer (0).
+    void Unbind() const;
+
+    // Check completeness
+    // Returns true if the framebuffer can be rendered to.
+    bool IsComplete() const;
+
+    inline GLuint GetFramebufferID() const { return FramebufferID; }
+    inline uint32 GetWidth() const { return Width; }
+    inline uint32 GetHeight() const { return Height; }
+
+private:
+    GLuint FramebufferID = 0;   // OpenGL ID for the framebuffer
+    GLuint ColorBufferID = 0;   // RGBA8 color renderbuffer
+    GLuint DepthBufferID = 0;   // Depth/stencil renderbuffer
+    uint32 Width;
+    uint32 Height;
+};
+
+using FBO = FrameBufferObject;
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include "glm/glm.hpp"
+
+/**
+ * @brief View frustum as six inward-facing planes.
+ *
+ * Each plane is stored as (normal.xyz, distance) with a unit-length normal, so
+ * dot(normal, point) + distance is the signed distance of the point to the plane.
+ */
+struct Frustum
+{
+    enum Plane : int { Left, Right, Bottom, Top, Near, Far, Count };
+
+    enum class Containment { Outside, Intersects, Inside };
+
+    std::array<glm::vec4, Plane::Count> Planes{};
+
+    /**
+     * @brief Extracts the planes of a view-projection matrix (Gribb/Hartmann, OpenGL clip space).
+     */
+    [[nodiscard]] static Frustum FromMatrix(const glm::mat4& viewProjection) noexcept;
+
+    /**
+     * @brief Returns true if the sphere is at least partially inside the frustum.
+     */
+    [[nodiscard]] bool IntersectsSphere(const glm::vec3& center, float radius) const noexcept;
+
+    /**
+     * @brief Classifies an axis-aligned box against the frustum.
+     *
+     * Conservative like IntersectsSphere: a box near a frustum corner can be
+     * reported as Intersects although it is outside, never the other way round.
+     */
+    [[nodiscard]] Containment TestBox(const glm::vec3& center, const glm::vec3& halfExtents) const noexcept;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+#include "Platform.h"
+
+// Buffer and vertex array wrappers edit objects by name through GL 4.5 direct state access,
+// which leaves the bindings (and this cache) untouched; premake --disable_dsa restores bind-to-edit
+#if defined(DISABLE_DSA)
+#define USE_DSA 0
+#else
+#define USE_DSA 1
+#endif
+
+/**
+ * @brief Kinds of state changes tracked by GLStateCache.
+ */
+enum class GLStateCall : uint8
+{
+    VertexArray,
+    Buffer,
+    BufferBase,
+    Program,
+    ActiveTexture,
+    Texture,
+    Count
+};
+
+/**
+ * @brief Shadow copy of the GL binding state.
+ *
+ * All wrappers (VAO, VBO, EBO, SSBO, indirect buffers, textures and shaders)
+ * bind through this cache, which drops calls that would not change anything.
+ * Issued and skipped calls are counted so the savings can be checked per frame.
+ *
+ * GL code that binds objects directly must call Invalidate() afterwards.
+ */
+class GLStateCache
+{
+public:
+    /**
+     * @brief Issued and skipped calls since the last ResetFrameCounters().
+     */
+    struct Counters
+    {
+        std::array<uint32, static_cast<size_t>(GLStateCall::Count)> Issued{};
+        std::array<uint32, static_cast<size_t>(GLStateCall::Count)> Skipped{};
+
+        [[nodiscard]] uint32 GetTotalIssued() const noexcept;
+        [[nodiscard]] uint32 GetTotalSkipped() const noexcept;
+    };
+
+    // Get the instance of GLStateCache (Singleton), the cache mirrors the state of the one GL context
+    static GLStateCache& GetInstance()
+    {
+        static GLStateCache instance;
+        return instance;
+    }
+
+    void BindVertexArray(GLuint arrayID);
+    void BindBuffer(GLenum target, GLuint bufferID);
+    void BindBufferBase(GLenum target, GLuint bindingIndex, GLuint bufferID);
+
+    // Range bindings are always issued, their offset usually changes every frame
+    void BindBufferRange(GLenum target, GLuint bindingIndex, GLuint bufferID, GLintptr offset, GLsizeiptr size);
+    void UseProgram(GLuint programID);
+    void ActiveTexture(GLuint unit);
+
+    // Binds a texture to the currently active texture unit
+    void BindTexture(GLenum target, GLuint textureID);
+
+    // Activates `unit` and binds the texture to it
+    void BindTextureUnit(GLuint unit, GLenum target, GLuint textureID);
+
+    // GL unbinds deleted objects implicitly, the cache has to forget them too
+    void OnVertexArrayDeleted(GLuint arrayID);
+    void OnBufferDeleted(GLuint bufferID);
+    void OnProgramDeleted(GLuint programID);
+    void OnTextureDeleted(GLuint textureID);
+
+    /**
+     * @brief Forgets all cached bindings, the next bind of every kind is issued.
+     */
+    void Invalidate();
+
+    [[nodiscard]] const Counters& GetFrameCounters() const noexcept { return FrameCounters; }
+
+    void ResetFrameCounters() noexcept { FrameCounters = Counters{}; }
+
+private:
+    static constexpr GLuint Unknown = ~0u;
+    static constexpr size_t MaxBufferBindings = 16;
+    static constexpr size_t MaxTextureUnits = 32;
+
+    enum BufferSlot : uint8 { ArrayBuffer, ElementArrayBuffer, ShaderStorageBuffer, DrawIndirectBuffer, UniformBuffer, BufferSlotCount, NoBufferSlot };
+    enum TextureSlot : uint8 { Texture2D, TextureCubeMap, Texture3D, Texture2DArray, TextureSlotCount, NoTextureSlot };
+
+    static BufferSlot ToBufferSlot(GLenum target) noexcept;
+    static TextureSlot ToTextureSlot(GLenum target) noexcept;
+
+    // Returns true if the call must be issued and records it in the counters
+    bool Track(GLStateCall call, GLuint& cached, GLuint requested) noexcept;
+
+    GLStateCache() { Invalidate(); }
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    GLuint VertexArray = Unknown;
+    GLuint Program = Unknown;
+    GLuint ActiveUnit = Unknown;
+    std::array<GLuint, BufferSlotCount> Buffers{};
+    std::array<GLuint, MaxBufferBindings> StorageBindings{};
+    std::array<GLuint, MaxBufferBindings> UniformBindings{};
+    std::array<std::array<GLuint, TextureSlotCount>, MaxTextureUnits> Textures{};
+
+    Counters FrameCounters;
+};
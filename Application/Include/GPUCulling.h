@@ -0,0 +1,82 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string_view>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Shaders.h"
+#include "SSBO.h"
+#include "IndirectBuffer.h"
+#include "MeshRegistry.h"
+#include "Frustum.h"
+#include "Platform.h"
+
+/**
+ * @brief Static description of one culled object (std430, must match FrustumCull.shader).
+ *
+ * The object spins around `AxisSpeed.xyz` at `AxisSpeed.w` degrees per second,
+ * so the compute pass can build the model matrix itself and the CPU never
+ * touches per-object data after the initial upload.
+ */
+struct CullObject
+{
+    glm::vec4 PositionRadius;  // xyz: world position, w: bounding sphere radius
+    glm::vec4 AxisSpeed;       // xyz: unit rotation axis, w: angular speed in degrees per second
+    uint32 MaterialIndex;
+    uint32 Padding[3];
+};
+static_assert(sizeof(CullObject) == 48, "CullObject must match the std430 layout in FrustumCull.shader");
+
+/**
+ * @brief GPU-driven frustum culling.
+ *
+ * Object bounds are uploaded once. Every frame a compute pass tests all objects
+ * against the frustum, appends survivors to the instance buffer and atomically
+ * bumps the instance count of a single indirect draw command, so the CPU cost
+ * per frame does not depend on the object count.
+ */
+class GPUCullingPass
+{
+public:
+    explicit GPUCullingPass(std::string_view shaderPath);
+
+    GPUCullingPass(const GPUCullingPass&) = delete;
+    GPUCullingPass& operator=(const GPUCullingPass&) = delete;
+
+    /**
+     * @brief Uploads the objects to cull and sizes the instance buffer for all of them.
+     */
+    void UploadObjects(const std::vector<CullObject>& objects);
+
+    /**
+     * @brief Culls all objects and fills the instance buffer and the indirect command.
+     *
+     * @param drawTemplate Command of the mesh to draw, its instance count is reset to 0 before culling.
+     *
+     * Leaves the compute program bound, rebind the graphics shader before drawing.
+     */
+    void Run(const Frustum& frustum, float time, const DrawElementsIndirectCommand& drawTemplate);
+
+    /**
+     * @brief Draws the surviving instances with the command written by Run().
+     */
+    void Draw(const MeshRegistry& registry, MeshHandle mesh) const;
+
+    /**
+     * @brief Reads back the number of visible instances.
+     *
+     * Waits for the GPU, only call it for statistics.
+     */
+    [[nodiscard]] uint32 ReadVisibleCount() const;
+
+    [[nodiscard]] uint32 GetObjectCount() const noexcept { return ObjectCount; }
+
+private:
+    ComputeShader Shader;
+    ShaderStorageBufferObject ObjectBuffer;
+    ShaderStorageBufferObject InstanceBuffer;
+    IndirectBufferObject CommandBuffer;
+
+    uint32 ObjectCount = 0;
+    GLuint GroupSizeX = 1;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <memory>
+#include <span>
+#include "VAO.h"
+#include "RangeAllocator.h"
+#include "Platform.h"
+
+/**
+ * @brief Large shared vertex and index buffers for every mesh of one vertex layout.
+ *
+ * Meshes are sub-allocated ranges of the two buffers: vertices are addressed
+ * through baseVertex and indices through firstIndex, so all meshes of a layout
+ * draw from the same VAO and can be batched into a single multi-draw. The index
+ * type is fixed per pool; 16-bit pools take any mesh of up to 65536 vertices,
+ * since baseVertex is added after the index is read. When a buffer runs out of space it is reallocated at twice the
+ * size and the old contents are copied on the GPU; offsets stay valid.
+ */
+class GeometryPool
+{
+public:
+    /**
+     * @brief Vertex and index ranges of one mesh, in vertices and indices.
+     */
+    struct Range
+    {
+        RangeAllocator::Allocation Vertices;
+        RangeAllocator::Allocation Indices;
+        uint32 FirstVertex = 0;  // Start of the data, Vertices.Offset rounded up to the requested alignment
+
+        [[nodiscard]] bool IsValid() const noexcept { return Vertices.IsValid() && Indices.IsValid(); }
+    };
+
+    /**
+     * @brief Creates a pool for VertexType, the attributes come from its VertexLayout.
+     *
+     * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, see MeshOptimizer::SelectIndexType().
+     */
+    template <typename VertexType>
+    static std::unique_ptr<GeometryPool> Create(GLenum indexType = GL_UNSIGNED_INT, uint32 vertexCapacity = DefaultVertexCapacity,
+        uint32 indexCapacity = DefaultIndexCapacity)
+    {
+        return std::unique_ptr<GeometryPool>(new GeometryPool(sizeof(VertexType),
+            [](const VertexArrayObject& vao) { vao.EnableVertexAttributes<VertexType>(); },
+            indexType, vertexCapacity, indexCapacity));
+    }
+
+    /**
+     * @brief Creates a pool of raw 32-bit words for vertex pulling.
+     *
+     * Meshes of any vertex type can share it; its VAO has no attributes and
+     * only supplies the index buffer, shaders read the words from a storage buffer.
+     */
+    static std::unique_ptr<GeometryPool> CreateWordPool(uint32 wordCapacity = DefaultVertexCapacity * 8, uint32 indexCapacity = DefaultIndexCapacity)
+    {
+        return std::unique_ptr<GeometryPool>(new GeometryPool(sizeof(uint32), nullptr, GL_UNSIGNED_INT, wordCapacity, indexCapacity));
+    }
+
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    /**
+     * @brief Copies a mesh into the pool, growing the buffers when needed.
+     *
+     * @param vertexData Raw vertices, `vertexCount` times the stride of the pool.
+     * @param indices Narrowed to the index type of the pool, so they must fit it.
+     * @param vertexAlignment The data starts at a multiple of this many vertices, see Range::FirstVertex.
+     */
+    [[nodiscard]] Range Allocate(const void* vertexData, uint32 vertexCount, std::span<const uint32> indices, uint32 vertexAlignment = 1)
+    {
+        return Allocate(vertexData, vertexCount, indices.data(), static_cast<uint32>(indices.size()), GL_UNSIGNED_INT, vertexAlignment);
+    }
+
+    /**
+     * @brief Like Allocate(), for indices of either type.
+     *
+     * Indices already in the pool's type go to the GPU straight from `indexData`, others are converted first.
+     *
+     * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+     */
+    [[nodiscard]] Range Allocate(const void* vertexData, uint32 vertexCount, const void* indexData, uint32 indexCount, GLenum indexType,
+        uint32 vertexAlignment = 1);
+
+    /**
+     * @brief Returns the ranges of a mesh to the pool, the data is not cleared.
+     */
+    void Free(const Range& range);
+
+    /**
+     * @brief Binds the shared VAO, which also binds the shared index buffer.
+     */
+    void Bind() const { VAO.Bind(); }
+
+    /**
+     * @brief Binds the vertex buffer to an indexed GL_SHADER_STORAGE_BUFFER binding, for vertex pulling.
+     */
+    void BindVertexStorage(GLuint bindingIndex) const;
+
+    [[nodiscard]] GLuint GetVertexBufferID() const noexcept { return VertexBufferID; }
+    [[nodiscard]] GLuint GetIndexBufferID() const noexcept { return IndexBufferID; }
+    [[nodiscard]] uint32 GetVertexStride() const noexcept { return VertexStride; }
+    [[nodiscard]] GLenum GetIndexType() const noexcept { return IndexType; }
+    [[nodiscard]] uint32 GetIndexSize() const noexcept { return IndexSize; }
+    [[nodiscard]] uint32 GetVertexCapacity() const noexcept { return Vertices.GetSize(); }
+    [[nodiscard]] uint32 GetIndexCapacity() const noexcept { return Indices.GetSize(); }
+    [[nodiscard]] uint32 GetUsedVertices() const noexcept { return Vertices.GetSize() - Vertices.GetFreeSize(); }
+    [[nodiscard]] uint32 GetUsedIndices() const noexcept { return Indices.GetSize() - Indices.GetFreeSize(); }
+
+    static constexpr uint32 DefaultVertexCapacity = 64 * 1024;
+    static constexpr uint32 DefaultIndexCapacity = 256 * 1024;
+
+private:
+    using AttributeSetup = void (*)(const VertexArrayObject&);
+
+    GeometryPool(uint32 vertexStride, AttributeSetup attributeSetup, GLenum indexType, uint32 vertexCapacity, uint32 indexCapacity);
+
+    // Reallocates the buffers to hold at least `count` more units in one free range
+    void GrowVertices(uint32 count);
+    void GrowIndices(uint32 count);
+
+    // Attaches the current buffers to the VAO
+    void AttachBuffers() const;
+
+    VertexArrayObject VAO;
+    GLuint VertexBufferID = 0;
+    GLuint IndexBufferID = 0;
+    uint32 VertexStride;
+    AttributeSetup SetupAttributes;
+    GLenum IndexType;
+    uint32 IndexSize;
+
+    RangeAllocator Vertices;
+    RangeAllocator Indices;
+};
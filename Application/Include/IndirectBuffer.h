@@ -0,0 +1,84 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include "Platform.h"
+
+// Indirect draw command consumed by glDrawElementsIndirect / glMultiDrawElementsIndirect.
+// The layout is fixed by the OpenGL specification.
+struct DrawElementsIndirectCommand
+{
+    uint32 count;          // Number of indices to draw
+    uint32 instanceCount;  // Number of instances to draw
+    uint32 firstIndex;     // First index inside the bound element buffer
+    int32 baseVertex;      // Value added to every fetched index
+    uint32 baseInstance;   // First instance, readable in shaders as gl_BaseInstance
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must be tightly packed");
+
+class IndirectBufferObject
+{
+public:
+    // Constructor
+    // Generates a buffer ID for the draw indirect buffer using OpenGL.
+    IndirectBufferObject();
+
+    // Destructor
+    // Deletes the buffer using its buffer ID to free up resources when the object goes out of scope.
+    ~IndirectBufferObject();
+
+    IndirectBufferObject(const IndirectBufferObject&) = delete;
+    IndirectBufferObject& operator=(const IndirectBufferObject&) = delete;
+
+    // Bind the buffer
+    // Binds the buffer to GL_DRAW_INDIRECT_BUFFER, indirect draw calls then read their arguments from it.
+    void Bind() const;
+
+    // Unbind the buffer
+    // Unbinds the buffer by binding 0 to GL_DRAW_INDIRECT_BUFFER.
+    void Unbind() const;
+
+    // Upload draw commands
+    // Replaces the data store with `size` bytes of commands. The buffer is left bound.
+    //
+    // Parameters:
+    // - size: The size in bytes of the data to be uploaded.
+    // - data: A pointer to the commands to be uploaded.
+    // - usage: The expected usage pattern of the data store.
+    void UploadData(GLsizeiptr size, const void* data, GLenum usage = GL_STREAM_DRAW);
+
+    // Upload draw commands from std::vector
+    //
+    // Parameters:
+    // - commands: The commands to be uploaded.
+    // - usage: The expected usage pattern of the data store.
+    inline void UploadData(const std::vector<DrawElementsIndirectCommand>& commands, GLenum usage = GL_STREAM_DRAW)
+    {
+        UploadData(static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsIndirectCommand)), commands.data(), usage);
+    }
+
+    // Update part of the draw commands
+    // Overwrites `size` bytes at `offset` without reallocating the data store. The buffer is left bound.
+    //
+    // Parameters:
+    // - offset: The byte offset into the data store.
+    // - size: The size in bytes of the data to be written.
+    // - data: A pointer to the new data.
+    void UpdateData(GLintptr offset, GLsizeiptr size, const void* data) const;
+
+    // Bind the buffer as a shader storage buffer
+    // Lets compute shaders write draw commands, e.g. atomically bump instanceCount.
+    //
+    // Parameters:
+    // - bindingIndex: The shader storage binding point.
+    void BindStorage(GLuint bindingIndex) const;
+
+    // Get the buffer ID
+    // Returns the unique OpenGL ID of the buffer.
+    inline const GLuint GetBufferID() const { return BufferID; }
+
+private:
+    GLuint BufferID;  // OpenGL ID for the draw indirect buffer
+};
+
+using DrawIndirectBuffer = IndirectBufferObject;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <GL/glew.h>
+#include "glm/glm.hpp"
+#include "Platform.h"
+
+// Shader storage binding points shared by the C++ side and the shaders
+constexpr GLuint INSTANCE_BUFFER_BINDING = 0;     // InstanceData[], read by TestLight.shader
+constexpr GLuint MATERIAL_BUFFER_BINDING = 1;     // GPUMaterial[], read by TestLight.shader
+constexpr GLuint CULL_OBJECT_BUFFER_BINDING = 2;  // CullObject[], read by FrustumCull.shader
+constexpr GLuint CULL_COMMAND_BUFFER_BINDING = 3; // DrawElementsIndirectCommand, written by FrustumCull.shader
+constexpr GLuint PULLED_VERTEX_BUFFER_BINDING = 4; // uint[] vertex words, read by TestLight.shader when vertex pulling
+constexpr GLuint VERTEX_FORMAT_BUFFER_BINDING = 5; // GPUVertexFormat[], read by TestLight.shader when vertex pulling
+constexpr GLuint MESHLET_BUFFER_BINDING = 6;         // Meshlet[], read by MeshletCull.shader
+constexpr GLuint MESHLET_COMMAND_BUFFER_BINDING = 7; // DrawElementsIndirectCommand[], written by MeshletCull.shader
+constexpr GLuint MESHLET_COUNT_BUFFER_BINDING = 8;   // Visible meshlet count, written by MeshletCull.shader
+
+// Per-instance data read by TestLight.shader at gl_BaseInstance + gl_InstanceID (std430 layout)
+struct InstanceData
+{
+    glm::mat4 model;
+    uint32 materialIndex;
+    uint32 vertexFormat;  // GPUVertexFormat of the mesh, only read when vertex pulling
+    uint32 padding[2];
+};
+static_assert(sizeof(InstanceData) == 80, "InstanceData must match the std430 layout in TestLight.shader");
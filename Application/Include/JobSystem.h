@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Platform.h"
+
+class JobCounter;
+
+/**
+ * @brief One unit of work: a function pointer, its data and the index range it covers.
+ *
+ * Jobs are small and trivially copyable so queues never allocate per job.
+ */
+struct Job
+{
+    void (*Function)(const Job& job) = nullptr;
+    void* Data = nullptr;
+    size_t Begin = 0;
+    size_t End = 0;
+    JobCounter* Counter = nullptr;
+};
+
+/**
+ * @brief Tracks a group of jobs; jobs can wait on it or depend on it.
+ *
+ * A counter is done when every job scheduled against it has finished. Jobs
+ * scheduled with a counter as their dependency are queued once it is done,
+ * so schedule the jobs of the dependency first. A counter may be reused
+ * after it is done, but must outlive its jobs.
+ */
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    [[nodiscard]] bool IsDone() const noexcept { return Outstanding.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    // Triggers the continuations when it reaches zero
+    std::atomic<uint32> Pending{ 0 };
+
+    // Reaches zero after the finishing job has released the continuations, so waiters never free a counter still in use
+    std::atomic<uint32> Outstanding{ 0 };
+
+    std::mutex ContinuationMutex;
+    std::vector<Job> Continuations;
+};
+
+/**
+ * @brief Engine-owned thread pool with per-thread work-stealing deques.
+ *
+ * Every thread owns a deque: it pops its own work LIFO (cache-warm) and, when
+ * empty, steals FIFO from the others. Batches are spread over all deques when
+ * they are scheduled, so steals measure load imbalance rather than startup.
+ * The main thread is thread 0; it runs jobs while it waits.
+ *
+ * Call BeginFrame() once per frame and read GetFrameStats() at the end to get
+ * the number of jobs, steals and worker utilization of that frame.
+ */
+class JobSystem
+{
+public:
+    struct FrameStats
+    {
+        uint32 JobsExecuted = 0;
+        uint32 Steals = 0;
+        float WorkerUtilization = 0.0f;  // Busy time of the worker threads over frame time, 0-1 (main thread excluded)
+    };
+
+    // Get the instance of JobSystem (Singleton), starts hardware_concurrency - 1 workers on first use
+    static JobSystem& GetInstance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    // Threads that execute jobs, including the main thread
+    [[nodiscard]] uint32 GetThreadCount() const noexcept { return static_cast<uint32>(Threads.size()); }
+
+    /**
+     * @brief Queues one job.
+     *
+     * @param dependency If given, the job is held back until this counter is done.
+     */
+    void Schedule(void (*function)(const Job&), void* data, JobCounter& counter, JobCounter* dependency = nullptr);
+
+    /**
+     * @brief Splits [0, count) into ranges of at most grainSize and queues one job per range.
+     *
+     * `function(begin, end)` is called on the workers. It is referenced, not
+     * copied, so it must stay alive until `counter` is done.
+     */
+    template <typename Function>
+    void ParallelForAsync(size_t count, size_t grainSize, Function& function, JobCounter& counter, JobCounter* dependency = nullptr)
+    {
+        if (count == 0)
+            return;
+
+        const size_t grain = grainSize > 0 ? grainSize : 1;
+        const size_t jobCount = (count + grain - 1) / grain;
+
+        Job job;
+        job.Function = [](const Job& range) { (*static_cast<Function*>(range.Data))(range.Begin, range.End); };
+        job.Data = const_cast<void*>(static_cast<const void*>(&function));
+        job.Counter = &counter;
+
+        std::vector<Job>& batch = ScratchBatch();
+        batch.clear();
+        batch.reserve(jobCount);
+        for (size_t i = 0; i < jobCount; ++i)
+        {
+            job.Begin = i * grain;
+            job.End = std::min(job.Begin + grain, count);
+            batch.push_back(job);
+        }
+
+        Submit(batch, counter, dependency);
+    }
+
+    /**
+     * @brief Blocking ParallelFor, the calling thread helps until every range is done.
+     */
+    template <typename Function>
+    void ParallelFor(size_t count, size_t grainSize, Function&& function)
+    {
+        if (count <= grainSize || Threads.size() == 1)
+        {
+            if (count > 0)
+                function(size_t{ 0 }, count);
+            return;
+        }
+
+        JobCounter counter;
+        ParallelForAsync(count, grainSize, function, counter);
+        Wait(counter);
+    }
+
+    /**
+     * @brief Runs queued jobs on the calling thread until `counter` is done.
+     */
+    void Wait(JobCounter& counter);
+
+    void BeginFrame();
+
+    [[nodiscard]] FrameStats GetFrameStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct alignas(64) ThreadState
+    {
+        std::mutex QueueMutex;
+        std::deque<Job> Queue;
+
+        std::atomic<uint64> BusyNanoseconds{ 0 };
+        std::atomic<uint32> JobsExecuted{ 0 };
+        std::atomic<uint32> Steals{ 0 };
+    };
+
+    JobSystem();
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void WorkerLoop(uint32 threadIndex);
+
+    // Queues jobs whose counters are already incremented, spreading them over all deques
+    void Push(const Job* jobs, size_t count);
+
+    // Increments the counter and queues the batch now or parks it on the dependency
+    void Submit(std::vector<Job>& batch, JobCounter& counter, JobCounter* dependency);
+
+    bool TryGetJob(uint32 threadIndex, Job& job);
+    void Execute(uint32 threadIndex, const Job& job);
+    void Finish(JobCounter& counter);
+
+    static uint32 GetCurrentThreadIndex() noexcept;
+
+    // Per-thread batch buffer, avoids allocating on every ParallelForAsync
+    static std::vector<Job>& ScratchBatch();
+
+    std::vector<std::unique_ptr<ThreadState>> Threads;
+    std::vector<std::thread> Workers;
+
+    std::atomic<int64> QueuedJobs{ 0 };
+    std::atomic<uint32> NextQueue{ 0 };
+    std::atomic<bool> Running{ true };
+    std::mutex SleepMutex;
+    std::condition_variable SleepCondition;
+
+    Clock::time_point FrameStart = Clock::now();
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Platform.h"
+
+/**
+ * @brief Read-only JSON document tree, enough for glTF and other asset headers.
+ *
+ * Objects keep their members in file order; lookups are linear, which is
+ * faster than hashing for the handful of keys asset formats use. Missing
+ * members and out-of-range elements return a shared null value, so chains
+ * like `json["meshes"][0]["name"]` never need intermediate checks.
+ */
+class JsonValue
+{
+public:
+    enum class Type : uint8
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    /**
+     * @brief Parses a whole document, returns false and describes the first error in `error`.
+     */
+    [[nodiscard]] static bool Parse(std::string_view text, JsonValue& result, std::string& error);
+
+    [[nodiscard]] Type GetType() const noexcept { return ValueType; }
+    [[nodiscard]] bool IsNull() const noexcept { return ValueType == Type::Null; }
+    [[nodiscard]] bool IsNumber() const noexcept { return ValueType == Type::Number; }
+    [[nodiscard]] bool IsString() const noexcept { return ValueType == Type::String; }
+    [[nodiscard]] bool IsArray() const noexcept { return ValueType == Type::Array; }
+    [[nodiscard]] bool IsObject() const noexcept { return ValueType == Type::Object; }
+
+    [[nodiscard]] bool GetBool(bool fallback = false) const noexcept { return ValueType == Type::Bool ? Boolean : fallback; }
+    [[nodiscard]] double GetNumber(double fallback = 0.0) const noexcept { return ValueType == Type::Number ? Number : fallback; }
+    [[nodiscard]] const std::string& GetString() const noexcept { return Text; }
+
+    /**
+     * @brief Number of array elements or object members.
+     */
+    [[nodiscard]] size_t Size() const noexcept { return Elements.size(); }
+
+    /**
+     * @brief Array elements or object member values, in file order.
+     */
+    [[nodiscard]] std::span<const JsonValue> GetElements() const noexcept { return Elements; }
+
+    /**
+     * @brief Member of an object, nullptr if there is none.
+     */
+    [[nodiscard]] const JsonValue* Find(std::string_view key) const noexcept;
+
+    [[nodiscard]] const JsonValue& operator[](std::string_view key) const noexcept;
+    [[nodiscard]] const JsonValue& operator[](size_t index) const noexcept;
+
+private:
+    friend class JsonParser;
+
+    Type ValueType = Type::Null;
+    bool Boolean = false;
+    double Number = 0.0;
+    std::string Text;
+    std::vector<JsonValue> Elements;
+    std::vector<std::string> Keys;  // Parallel to Elements for objects
+};
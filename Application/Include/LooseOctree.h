@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Frustum.h"
+#include "Platform.h"
+
+/**
+ * @brief Loose octree over bounding spheres, with incremental insert, move and remove.
+ *
+ * Every node owns a cubic cell; its loose bounds are twice the cell size, so
+ * an object whose radius is at most half the cell size fits the node its
+ * center falls in. Objects therefore never straddle siblings and moving an
+ * object touches at most two nodes.
+ *
+ * A node keeps its objects until it holds more than the leaf capacity, then
+ * splits and pushes down every object small enough for a child. Leaves stay
+ * near the capacity whatever the object count, so one tree works for 10k
+ * and 1M objects.
+ *
+ * Frustum queries classify whole nodes: subtrees fully outside are skipped,
+ * subtrees fully inside are accepted without per-object tests, and only
+ * objects in partially overlapping nodes are tested individually. The cost of
+ * a query follows the visible part of the scene rather than its total size.
+ *
+ * Objects outside the root cell, or too large for it, live in the root and
+ * are always tested individually.
+ */
+class LooseOctree
+{
+public:
+    struct QueryStats
+    {
+        uint32 NodesVisited = 0;
+        uint32 ObjectsTested = 0;  // Objects that needed a sphere test, the rest were accepted with their node
+    };
+
+    /**
+     * @param center Center of the root cell.
+     * @param halfSize Half the side length of the root cell.
+     * @param maxDepth Deepest level below the root, nodes there never split.
+     * @param leafCapacity Objects a node holds before it splits.
+     */
+    LooseOctree(const glm::vec3& center, float halfSize, uint32 maxDepth = 8, uint32 leafCapacity = 64);
+
+    // Ids are caller-chosen indices (e.g. draw command indices), storage grows to the largest id
+    void Reserve(size_t objectCount);
+
+    void Insert(uint32 id, const glm::vec3& center, float radius);
+
+    // Updates the bounds in place when the object stays in its node, otherwise re-inserts it
+    void Move(uint32 id, const glm::vec3& center, float radius);
+
+    void Remove(uint32 id);
+
+    void Clear();
+
+    [[nodiscard]] bool Contains(uint32 id) const noexcept { return id < Objects.size() && Objects[id].Node != InvalidNode; }
+
+    /**
+     * @brief Writes the ids of all objects whose sphere intersects the frustum to `visible`.
+     *
+     * `visible` is cleared first. Ids come out grouped by node, not sorted.
+     */
+    QueryStats Query(const Frustum& frustum, std::vector<uint32>& visible) const;
+
+    [[nodiscard]] size_t GetObjectCount() const noexcept { return ObjectCount; }
+
+    // Nodes currently in use, empty subtrees are released on Remove()
+    [[nodiscard]] size_t GetNodeCount() const noexcept { return Nodes.size() - FreeNodes.size(); }
+
+private:
+    static constexpr int32 InvalidNode = -1;
+
+    struct Node
+    {
+        glm::vec3 Center;
+        float HalfSize;
+        int32 Parent = InvalidNode;
+        uint32 Depth = 0;
+        bool Split = false;  // Objects that fit a child go to the child
+        std::array<int32, 8> Children;
+        uint32 SubtreeObjects = 0;  // Objects in this node and all of its children
+
+        // Objects of this node, packed so queries read them front to back
+        std::vector<glm::vec4> Spheres;  // Center, radius
+        std::vector<uint32> Ids;
+    };
+
+    struct Object
+    {
+        int32 Node = InvalidNode;
+        uint32 Slot = 0;  // Position in the node's object arrays
+    };
+
+    // Child cell of `node` that contains `center`, 0-7 as bit 0 = +x, bit 1 = +y, bit 2 = +z
+    static uint32 ChildIndex(const Node& node, const glm::vec3& center) noexcept;
+
+    // Node the object belongs in; with create = false returns InvalidNode if that node does not exist yet
+    int32 Locate(const glm::vec3& center, float radius, bool create);
+
+    int32 AllocateNode(int32 parent, uint32 childIndex);
+    void ReleaseEmptyNodes(int32 node);
+
+    // Splits a node that holds more than LeafCapacity objects
+    void SplitIfFull(int32 node);
+
+    [[nodiscard]] bool InsideRootCell(const glm::vec3& center) const noexcept;
+
+    void Attach(uint32 id, int32 node, const glm::vec4& sphere);
+    void Detach(uint32 id);
+
+    // Tests the node's own objects and classifies its children
+    void QueryNode(int32 node, const Frustum& frustum, std::vector<uint32>& visible, QueryStats& stats) const;
+
+    // Accepts a subtree that is fully inside the frustum
+    void CollectAll(int32 node, std::vector<uint32>& visible, QueryStats& stats) const;
+
+    uint32 MaxDepth;
+    uint32 LeafCapacity;
+    size_t ObjectCount = 0;
+
+    std::vector<Node> Nodes;  // Nodes[0] is the root
+    std::vector<int32> FreeNodes;
+    std::vector<Object> Objects;
+};
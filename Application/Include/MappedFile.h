@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include "Platform.h"
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Pages are loaded by the OS on first access, so opening is cheap and data
+ * that is never touched is never read. The mapping stays valid until the
+ * object is destroyed or another file is opened.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Maps `path`, returns false if it cannot be opened or is empty.
+     */
+    [[nodiscard]] bool Open(const std::filesystem::path& path);
+
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const noexcept { return Data != nullptr; }
+    [[nodiscard]] std::span<const uint8> GetData() const noexcept { return { Data, Size }; }
+
+private:
+    const uint8* Data = nullptr;
+    size_t Size = 0;
+#ifdef WINDOWS
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+#include "SSBO.h"
+#include "InstanceData.h"
+#include "Platform.h"
+
+// Material structure
+struct MaterialData
+{
+    glm::vec3 Color;
+    float Intensity;
+    glm::vec3 Ambient;
+    glm::vec3 Diffuse;
+    glm::vec3 Specular;
+    float Shininess;
+};
+
+// MaterialData packed into vec4s so that it matches the std430 layout of GPUMaterial in TestLight.shader
+struct GPUMaterial
+{
+    glm::vec4 ColorIntensity;
+    glm::vec4 Ambient;
+    glm::vec4 Diffuse;
+    glm::vec4 SpecularShininess;
+
+    GPUMaterial() = default;
+    explicit GPUMaterial(const MaterialData& material)
+        : ColorIntensity(material.Color, material.Intensity)
+        , Ambient(material.Ambient, 0.0f)
+        , Diffuse(material.Diffuse, 0.0f)
+        , SpecularShininess(material.Specular, material.Shininess)
+    {
+    }
+};
+static_assert(sizeof(GPUMaterial) == 64, "GPUMaterial must match the std430 layout in TestLight.shader");
+
+/**
+ * @brief All materials of the scene in one std430 shader storage buffer.
+ *
+ * Draws reference materials by index instead of uploading their parameters as
+ * uniforms. Edits are tracked as a dirty range and only that range is
+ * re-uploaded by Upload().
+ */
+class MaterialTable
+{
+public:
+    MaterialTable() = default;
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    /**
+     * @brief Appends a material and returns its index.
+     */
+    uint32 Add(const MaterialData& material);
+
+    /**
+     * @brief Replaces a material, the change reaches the GPU on the next Upload().
+     */
+    void Set(uint32 index, const MaterialData& material);
+
+    [[nodiscard]] const MaterialData& Get(uint32 index) const { return Materials[index]; }
+
+    [[nodiscard]] uint32 GetCount() const noexcept { return static_cast<uint32>(Materials.size()); }
+
+    /**
+     * @brief Sends pending changes to the GPU.
+     *
+     * Reallocates the buffer when materials were added past its capacity,
+     * otherwise only the dirty range is written.
+     */
+    void Upload();
+
+    /**
+     * @brief Binds the material buffer to the shader storage binding read by the shaders.
+     */
+    void Bind(GLuint bindingIndex = MATERIAL_BUFFER_BINDING) const;
+
+private:
+    void MarkDirty(uint32 index);
+
+    std::vector<MaterialData> Materials;
+    std::vector<GPUMaterial> Packed;
+    ShaderStorageBufferObject Buffer;
+
+    size_t Capacity = 0;   // Number of materials the GPU buffer can hold
+    uint32 DirtyBegin = 0; // Dirty range [DirtyBegin, DirtyEnd)
+    uint32 DirtyEnd = 0;
+};
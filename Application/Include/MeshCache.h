@@ -0,0 +1,241 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <concepts>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+#include "MeshImporter.h"
+#include "MeshSimplifier.h"
+#include "Vertex.h"
+#include "Platform.h"
+
+/**
+ * @brief First 64 bytes of a mesh cache file.
+ */
+struct MeshCacheHeader
+{
+    static constexpr uint32 MagicValue = 0x4843534D;  // "MSCH"
+    static constexpr uint32 CurrentVersion = 1;
+
+    uint32 Magic = MagicValue;
+    uint32 Version = CurrentVersion;
+    uint64 FileSize = 0;
+    uint64 ContentHash = 0;      // Of every byte after the header, see MeshCacheFile
+    uint64 LayoutSignature = 0;  // GetVertexLayoutSignature() of the vertex type the blobs were written for
+    uint32 SectionCount = 0;
+    uint32 MeshCount = 0;
+    uint32 Reserved[6] = {};
+};
+
+enum class MeshCacheSectionType : uint32
+{
+    MeshTable = 1,  // MeshCacheEntry per mesh
+    Lods = 2,       // MeshLod of every mesh, back to back
+    Names = 3,      // Mesh names, not terminated
+    Vertices = 4,   // Vertices of one mesh, exactly as VertexLayout describes them
+    Indices = 5     // Indices of one mesh, 16 or 32 bit
+};
+
+/**
+ * @brief Entry of the section table that follows the header; Offset is from the start of the file.
+ */
+struct MeshCacheSection
+{
+    MeshCacheSectionType Type;
+    uint32 Reserved;
+    uint64 Offset;
+    uint64 Size;
+};
+
+struct MeshCacheEntry
+{
+    uint32 NameOffset;     // In the Names section
+    uint32 NameLength;
+    uint32 VertexSection;  // Index into the section table
+    uint32 VertexCount;
+    uint32 IndexSection;
+    uint32 IndexCount;
+    uint32 IndexType;      // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32 FirstLod;       // In the Lods section
+    uint32 LodCount;
+    uint32 Reserved;
+};
+
+static_assert(sizeof(MeshCacheHeader) == 64 && sizeof(MeshCacheSection) == 24 && sizeof(MeshCacheEntry) == 40);
+static_assert(sizeof(MeshLod) == 12, "MeshLod is stored as is");
+
+/**
+ * @brief Identifies a vertex struct by its size and attribute layout.
+ *
+ * Changing a vertex struct or its VertexLayout changes the signature, so
+ * caches written for the old layout are rejected instead of drawn garbled.
+ */
+template <typename VertexType>
+consteval uint64 GetVertexLayoutSignature()
+{
+    uint64 hash = 0xCBF29CE484222325ull;
+    const auto mix = [&hash](uint64 value) { hash = (hash ^ value) * 0x100000001B3ull; };
+
+    mix(sizeof(VertexType));
+    for (const VertexAttrib& attrib : VertexLayout<VertexType>::Attributes)
+    {
+        mix(attrib.index);
+        mix(static_cast<uint64>(attrib.size));
+        mix(attrib.type);
+        mix(static_cast<uint64>(attrib.offset));
+        mix(attrib.normalized);
+        mix(attrib.integer);
+    }
+    return hash;
+}
+
+/**
+ * @brief Vertex types a cache can be built for: the importable ones and the packed format they convert to.
+ */
+template <typename VertexType>
+concept CacheableVertex = ImportableVertex<VertexType> || std::same_as<VertexType, VertexPackedPosNormalTangentUV3D>;
+
+/**
+ * @brief Versioned binary container of upload-ready meshes, loaded by mapping the file.
+ *
+ * Layout: MeshCacheHeader, the section table, then every section aligned to
+ * BlobAlignment bytes. Vertex and index sections hold exactly the bytes the
+ * GPU buffers expect, so loading parses nothing: Open() maps the file,
+ * validates the header, the section table and the content hash, and hands
+ * out pointers into the mapping. The hash is computed in parallel, in
+ * HashChunkSize pieces on the JobSystem.
+ *
+ * All data is little endian; one file holds meshes of a single vertex type.
+ */
+class MeshCacheFile
+{
+public:
+    static constexpr uint64 BlobAlignment = 64;
+    static constexpr size_t HashChunkSize = 1 << 20;
+
+    /**
+     * @brief One mesh, pointing into the mapped file.
+     */
+    struct Mesh
+    {
+        std::string_view Name;
+        const void* Vertices = nullptr;
+        uint32 VertexCount = 0;
+        const void* Indices = nullptr;
+        uint32 IndexCount = 0;
+        GLenum IndexType = GL_UNSIGNED_INT;
+        std::span<const MeshLod> Lods;
+    };
+
+    /**
+     * @brief Maps and validates a cache written for VertexType; prints the reason and returns false if it is unusable.
+     */
+    template <typename VertexType>
+    [[nodiscard]] bool Open(const std::filesystem::path& path)
+    {
+        return Open(path, GetVertexLayoutSignature<VertexType>(), sizeof(VertexType));
+    }
+
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const noexcept { return File.IsOpen(); }
+    [[nodiscard]] std::span<const Mesh> GetMeshes() const noexcept { return Meshes; }
+
+    template <typename VertexType>
+    [[nodiscard]] static std::span<const VertexType> GetVertices(const Mesh& mesh)
+    {
+        return { static_cast<const VertexType*>(mesh.Vertices), mesh.VertexCount };
+    }
+
+    /**
+     * @brief Writes imported meshes, each with a single level of detail; the file is replaced atomically.
+     */
+    template <typename VertexType>
+    static bool Write(const std::filesystem::path& path, std::span<const ImportedMesh<VertexType>> meshes)
+    {
+        // Indices are stored in the type the mesh will be drawn with
+        std::vector<std::vector<uint16>> narrowedIndices(meshes.size());
+        std::vector<MeshLod> lods(meshes.size());
+        std::vector<Mesh> views(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const ImportedMesh<VertexType>& mesh = meshes[i];
+            Mesh& view = views[i];
+            view.Name = mesh.Name;
+            view.Vertices = mesh.Vertices.data();
+            view.VertexCount = static_cast<uint32>(mesh.Vertices.size());
+            view.IndexCount = static_cast<uint32>(mesh.Indices.size());
+            view.IndexType = mesh.IndexType;
+            if (mesh.IndexType == GL_UNSIGNED_SHORT)
+            {
+                narrowedIndices[i].assign(mesh.Indices.begin(), mesh.Indices.end());
+                view.Indices = narrowedIndices[i].data();
+            }
+            else
+            {
+                view.Indices = mesh.Indices.data();
+            }
+            lods[i] = MeshLod{ 0, view.IndexCount, 0.0f };
+            view.Lods = std::span<const MeshLod>(&lods[i], 1);
+        }
+        return Write(path, GetVertexLayoutSignature<VertexType>(), sizeof(VertexType), views);
+    }
+
+    /**
+     * @brief Opens the cache next to an importable `source`, (re)building it first when it is missing, stale or invalid.
+     *
+     * A cache of VertexPackedPosNormalTangentUV3D is imported as float vertices
+     * and packed before it is written, so the mapping holds the 20 byte vertices.
+     * Returns false only if the source cannot be imported or the cache cannot be written.
+     */
+    template <CacheableVertex VertexType>
+    [[nodiscard]] bool OpenOrImport(const std::filesystem::path& source, const MeshImporter::Options& options)
+    {
+        const std::filesystem::path cachePath = GetCachePath(source);
+        if (IsUpToDate(source, cachePath) && Open<VertexType>(cachePath))
+            return true;
+
+        std::vector<ImportedMesh<VertexType>> meshes;
+        if constexpr (ImportableVertex<VertexType>)
+        {
+            meshes = MeshImporter::Import<VertexType>(source, options);
+        }
+        else
+        {
+            for (ImportedMesh<VertexPosNormalTangentUV3D>& imported : MeshImporter::Import<VertexPosNormalTangentUV3D>(source, options))
+            {
+                meshes.push_back({ std::move(imported.Name), PackVertices(imported.Vertices), std::move(imported.Indices), imported.IndexType });
+            }
+        }
+        if (meshes.empty() || !Write<VertexType>(cachePath, meshes))
+            return false;
+        return Open<VertexType>(cachePath);
+    }
+
+    template <CacheableVertex VertexType>
+    [[nodiscard]] bool OpenOrImport(const std::filesystem::path& source)
+    {
+        return OpenOrImport<VertexType>(source, MeshImporter::Options{});
+    }
+
+    /**
+     * @brief `source` with ".meshcache" appended.
+     */
+    [[nodiscard]] static std::filesystem::path GetCachePath(const std::filesystem::path& source);
+
+    /**
+     * @brief Hash stored in MeshCacheHeader::ContentHash.
+     */
+    [[nodiscard]] static uint64 HashContent(std::span<const uint8> data);
+
+private:
+    bool Open(const std::filesystem::path& path, uint64 layoutSignature, uint32 vertexStride);
+    static bool Write(const std::filesystem::path& path, uint64 layoutSignature, uint32 vertexStride, std::span<const Mesh> meshes);
+    static bool IsUpToDate(const std::filesystem::path& source, const std::filesystem::path& cachePath);
+
+    MappedFile File;
+    std::vector<Mesh> Meshes;
+};
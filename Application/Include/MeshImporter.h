@@ -0,0 +1,80 @@
+#pragma once
+
+#include <concepts>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+#include "Vertex.h"
+#include "MeshOptimizer.h"
+#include "Platform.h"
+
+/**
+ * @brief One imported triangle mesh, ready for MeshRegistry::Register().
+ */
+template <typename VertexType>
+struct ImportedMesh
+{
+    std::string Name;
+    std::vector<VertexType> Vertices;
+    std::vector<uint32> Indices;
+    GLenum IndexType = GL_UNSIGNED_INT;  // Smallest type that can hold every index, see MeshOptimizer::SelectIndexType()
+};
+
+/**
+ * @brief Vertex types the importer can fill directly.
+ */
+template <typename VertexType>
+concept ImportableVertex = std::same_as<VertexType, VertexPosNormalTangentUV3D> || std::same_as<VertexType, VertexPosNormalUV3D>;
+
+/**
+ * @brief Loads glTF 2.0 (.gltf with external or embedded buffers, .glb) and Wavefront OBJ files.
+ *
+ * All work runs on the JobSystem:
+ *  - OBJ files are cut into chunks at line breaks. The chunks are parsed in
+ *    parallel and stitched together with prefix sums, so relative indices
+ *    keep working. Vertices are welded in slices of a mesh, one job per slice,
+ *    and corners shared between slices are merged again when they are stitched.
+ *  - glTF buffers are read in parallel, then every primitive is decoded by its own job.
+ * Missing normals and tangents are generated afterwards, also in parallel,
+ * and every mesh runs through the MeshOptimizer.
+ *
+ * One mesh is returned per OBJ object/group and per glTF primitive, in
+ * object space: the glTF node hierarchy is not applied. glTF texture
+ * coordinates are flipped to the bottom-left origin the textures are loaded with.
+ */
+class MeshImporter
+{
+public:
+    struct Options
+    {
+        bool GenerateNormals = true;   // When the file has none; smooth normals weighted by triangle area
+        bool GenerateTangents = true;  // When the file has none and the vertex has a tangent
+        bool Optimize = true;          // Run MeshOptimizer::Optimize() on every mesh
+    };
+
+    /**
+     * @brief Imports every mesh of a file, the format is picked by the extension.
+     *
+     * Prints the reason and returns no meshes if the file cannot be read or parsed.
+     */
+    template <ImportableVertex VertexType>
+    [[nodiscard]] static std::vector<ImportedMesh<VertexType>> Import(const std::filesystem::path& path, const Options& options);
+
+    template <ImportableVertex VertexType>
+    [[nodiscard]] static std::vector<ImportedMesh<VertexType>> Import(const std::filesystem::path& path)
+    {
+        return Import<VertexType>(path, Options{});
+    }
+
+    /**
+     * @brief Area weighted smooth normals; vertices split on a seam get their own sums.
+     */
+    template <ImportableVertex VertexType>
+    static void GenerateNormals(std::span<VertexType> vertices, std::span<const uint32> indices);
+
+    /**
+     * @brief Per-vertex tangents along +u, orthogonalized against the normals.
+     */
+    static void GenerateTangents(std::span<VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices);
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <concepts>
+#include <iosfwd>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "Vertex.h"
+#include "MeshSimplifier.h"
+#include "Platform.h"
+
+/**
+ * @brief Post-transform vertex cache efficiency of an index buffer, from a FIFO cache simulation.
+ */
+struct VertexCacheStats
+{
+    uint32 VerticesTransformed = 0;  // Cache misses, i.e. vertex shader invocations
+    float ACMR = 0.0f;               // Transformed vertices per triangle: 3 at worst, about 0.5 for large grids
+    float ATVR = 0.0f;               // Transformed vertices per referenced vertex: 1 means each vertex is shaded once
+};
+
+/**
+ * @brief Reorders indexed triangle meshes for the GPU, run once before a mesh is uploaded.
+ *
+ * The passes are applied in this order, each keeping the result of the one before:
+ *  1. Vertex cache: triangles are reordered with Forsyth's linear-speed
+ *     algorithm, so recently transformed vertices are reused.
+ *  2. Overdraw: the cache-optimized order is cut into clusters where the
+ *     cache would be flushed anyway, and clusters facing away from the mesh
+ *     center are drawn first (view-independent sort by Sander et al.), so
+ *     the outer surface occludes the inner one for most views.
+ *  3. Vertex fetch: vertices are renumbered in order of first use, so the
+ *     vertex fetch reads the buffer front to back; unused vertices are dropped.
+ *
+ * Only the order changes, every triangle keeps its winding.
+ */
+class MeshOptimizer
+{
+public:
+    static constexpr uint32 UnusedVertex = ~0u;
+    static constexpr uint32 DefaultCacheSize = 16;
+
+    struct Options
+    {
+        uint32 CacheSize = DefaultCacheSize;  // FIFO size used by AnalyzeVertexCache() and the overdraw clusters
+        float OverdrawThreshold = 1.05f;      // Largest ACMR increase the overdraw pass may trade for fewer overdrawn pixels
+    };
+
+    template <typename VertexType>
+    struct Result
+    {
+        std::vector<VertexType> Vertices;
+        std::vector<uint32> Indices;
+        GLenum IndexType = GL_UNSIGNED_INT;  // Smallest type that can hold every index, see SelectIndexType()
+        VertexCacheStats Before;
+        VertexCacheStats After;
+    };
+
+    /**
+     * @brief Simulates a FIFO post-transform cache of `cacheSize` entries over the triangles.
+     */
+    [[nodiscard]] static VertexCacheStats AnalyzeVertexCache(std::span<const uint32> indices, uint32 vertexCount, uint32 cacheSize = DefaultCacheSize);
+
+    /**
+     * @brief Returns the triangles reordered for post-transform cache reuse.
+     */
+    [[nodiscard]] static std::vector<uint32> OptimizeVertexCache(std::span<const uint32> indices, uint32 vertexCount);
+
+    /**
+     * @brief Returns the triangles reordered to reduce overdraw; expects the output of OptimizeVertexCache().
+     *
+     * @param positions Object-space position of every vertex.
+     */
+    [[nodiscard]] static std::vector<uint32> OptimizeOverdraw(std::span<const uint32> indices, std::span<const glm::vec3> positions,
+        const Options& options);
+
+    /**
+     * @brief Renumbers the vertices in order of first use and rewrites `indices` in place.
+     *
+     * @return New index of every old vertex, UnusedVertex if no triangle references it.
+     */
+    [[nodiscard]] static std::vector<uint32> OptimizeVertexFetch(std::span<uint32> indices, uint32 vertexCount);
+
+    /**
+     * @brief Moves every vertex to its slot in `remap`, as returned by OptimizeVertexFetch().
+     */
+    template <typename VertexType>
+    [[nodiscard]] static std::vector<VertexType> RemapVertices(std::span<const VertexType> vertices, std::span<const uint32> remap)
+    {
+        uint32 usedCount = 0;
+        for (const uint32 target : remap)
+        {
+            if (target != UnusedVertex)
+                ++usedCount;
+        }
+
+        std::vector<VertexType> result(usedCount);
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            if (remap[i] != UnusedVertex)
+                result[remap[i]] = vertices[i];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Reorders the coarser levels of a chain for the vertex cache, the ranges stay where they are.
+     *
+     * Level 0 is left alone, it is expected to come out of Optimize() with its overdraw order intact.
+     */
+    static void OptimizeLodChain(MeshLodChain& lodChain, uint32 vertexCount);
+
+    /**
+     * @brief GL_UNSIGNED_SHORT when every vertex of the mesh can be addressed by 16 bits, GL_UNSIGNED_INT otherwise.
+     */
+    [[nodiscard]] static constexpr GLenum SelectIndexType(size_t vertexCount) noexcept
+    {
+        return vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    [[nodiscard]] static constexpr uint32 GetIndexSize(GLenum indexType) noexcept
+    {
+        return indexType == GL_UNSIGNED_SHORT ? 2u : 4u;
+    }
+
+    /**
+     * @brief Runs all three passes and measures the vertex cache before and after.
+     */
+    template <typename VertexType>
+        requires std::same_as<decltype(VertexType::pos), glm::vec3>
+    [[nodiscard]] static Result<VertexType> Optimize(std::span<const VertexType> vertices, std::span<const uint32> indices,
+        const Options& options)
+    {
+        const uint32 vertexCount = static_cast<uint32>(vertices.size());
+
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            positions[i] = vertices[i].pos;
+        }
+
+        Result<VertexType> result;
+        result.Before = AnalyzeVertexCache(indices, vertexCount, options.CacheSize);
+        result.Indices = OptimizeOverdraw(OptimizeVertexCache(indices, vertexCount), positions, options);
+
+        const std::vector<uint32> remap = OptimizeVertexFetch(result.Indices, vertexCount);
+        result.Vertices = RemapVertices(vertices, std::span<const uint32>(remap));
+        result.IndexType = SelectIndexType(result.Vertices.size());
+        result.After = AnalyzeVertexCache(result.Indices, static_cast<uint32>(result.Vertices.size()), options.CacheSize);
+        return result;
+    }
+
+    template <typename VertexType>
+        requires std::same_as<decltype(VertexType::pos), glm::vec3>
+    [[nodiscard]] static Result<VertexType> Optimize(std::span<const VertexType> vertices, std::span<const uint32> indices)
+    {
+        return Optimize(vertices, indices, Options{});
+    }
+
+    /**
+     * @brief Writes one line comparing ACMR and ATVR before and after optimization.
+     */
+    static void PrintStats(std::ostream& out, std::string_view name, const VertexCacheStats& before, const VertexCacheStats& after);
+};
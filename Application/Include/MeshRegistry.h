@@ -0,0 +1,334 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "GeometryPool.h"
+#include "IndirectBuffer.h"
+#include "SSBO.h"
+#include "VertexPulling.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Platform.h"
+
+/**
+ * @brief Lightweight reference to geometry owned by a MeshRegistry.
+ *
+ * Handles are plain indices, so scene objects can hold them by value without
+ * owning any GL resources.
+ */
+struct MeshHandle
+{
+    static constexpr uint32 InvalidIndex = ~0u;
+
+    uint32 Index = InvalidIndex;
+
+    [[nodiscard]] constexpr bool IsValid() const noexcept { return Index != InvalidIndex; }
+
+    constexpr bool operator==(const MeshHandle&) const noexcept = default;
+};
+
+/**
+ * @brief Owns the GPU copy of every unique mesh.
+ *
+ * Each geometry is uploaded once under a name; registering the same name again
+ * returns the existing handle, so any number of objects can share it. Meshes
+ * are sub-allocated from one GeometryPool per vertex type and index type, so
+ * every mesh of a pool shares a single VAO and can be drawn by the same
+ * multi-draw call. Meshes of up to 65536 vertices go to 16-bit index pools.
+ *
+ * With vertex pulling enabled every mesh is also copied into one word pool
+ * shared by all vertex types; the vertex shader decodes it from a storage
+ * buffer, so a single multi-draw covers meshes of any layout.
+ */
+class MeshRegistry
+{
+public:
+    /**
+     * @brief GPU resources and draw parameters of one registered mesh.
+     */
+    struct Mesh
+    {
+        uint32 Pool = 0;            // Index of the GeometryPool holding the data
+        GeometryPool::Range Range;  // baseVertex and firstIndex inside the pool
+        GLsizei IndexCount = 0;
+        std::vector<MeshLod> Lods;  // Finest first, FirstIndex is relative to the range
+        GeometryPool::Range PullRange;  // Copy in the vertex pulling pool, FirstVertex in words
+        uint32 PullFormat = 0;          // Index into the GPUVertexFormat table
+    };
+
+    enum class VertexPulling : uint8
+    {
+        Disabled,
+        Enabled  // Keep a second copy of every mesh for MultiDrawIndirectPulled()
+    };
+
+    explicit MeshRegistry(VertexPulling vertexPulling = VertexPulling::Disabled);
+
+    MeshRegistry(const MeshRegistry&) = delete;
+    MeshRegistry& operator=(const MeshRegistry&) = delete;
+
+    /**
+     * @brief Uploads a mesh once and returns its handle.
+     *
+     * If a mesh with the same name is already registered nothing is uploaded
+     * and the existing handle is returned. Returns an invalid handle if the
+     * geometry does not fit into its pool, or into the vertex pulling pool
+     * when that is enabled.
+     */
+    template <typename VertexType, typename IndexType>
+    MeshHandle Register(std::string_view name, std::span<const VertexType> vertices, std::span<const IndexType> indices)
+    {
+        static_assert(std::is_same_v<IndexType, uint8> || std::is_same_v<IndexType, uint16> || std::is_same_v<IndexType, uint32>,
+            "Index type must be an unsigned 8, 16 or 32 bit integer");
+
+        if (const MeshHandle existing = Find(name); existing.IsValid())
+        {
+            return existing;
+        }
+
+        // The pool picks the index type from the vertex count, so meshes of any index type can share one multi-draw
+        const std::vector<uint32> widened(indices.begin(), indices.end());
+        const MeshHandle handle = Upload(name, vertices, widened.data(), static_cast<uint32>(widened.size()), GL_UNSIGNED_INT);
+        if (handle.IsValid())
+        {
+            Meshes[handle.Index].Lods.push_back({ 0, static_cast<uint32>(indices.size()), 0.0f });
+        }
+        return handle;
+    }
+
+    /**
+     * @brief Uploads a mesh with its levels of detail, see MeshSimplifier::BuildLodChain().
+     *
+     * Behaves like Register(); the draw calls pick a level by index, 0 being the full mesh.
+     */
+    template <typename VertexType>
+    MeshHandle Register(std::string_view name, std::span<const VertexType> vertices, const MeshLodChain& lodChain)
+    {
+        if (const MeshHandle existing = Find(name); existing.IsValid())
+        {
+            return existing;
+        }
+
+        const MeshHandle handle = Upload(name, vertices, lodChain.Indices.data(), static_cast<uint32>(lodChain.Indices.size()), GL_UNSIGNED_INT);
+        if (!handle.IsValid())
+            return handle;
+
+        Mesh& mesh = Meshes[handle.Index];
+        mesh.IndexCount = static_cast<GLsizei>(lodChain.Lods.front().IndexCount);
+        mesh.Lods = lodChain.Lods;
+        return handle;
+    }
+
+    /**
+     * @brief Uploads a mesh from memory that only has to live for the call, e.g. a mapped MeshCacheFile.
+     *
+     * Behaves like Register(); indices in the type MeshOptimizer::SelectIndexType()
+     * picks for the vertex count are passed to the GPU without any CPU copy.
+     *
+     * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+     * @param lods Levels of detail; when empty the mesh gets a single level covering all `indexCount` indices.
+     */
+    template <typename VertexType>
+    MeshHandle Register(std::string_view name, std::span<const VertexType> vertices, const void* indices, uint32 indexCount, GLenum indexType,
+        std::span<const MeshLod> lods)
+    {
+        if (const MeshHandle existing = Find(name); existing.IsValid())
+        {
+            return existing;
+        }
+
+        const MeshHandle handle = Upload(name, vertices, indices, indexCount, indexType);
+        if (!handle.IsValid())
+            return handle;
+
+        // Without levels the whole index range is the only one
+        Mesh& mesh = Meshes[handle.Index];
+        if (lods.empty())
+        {
+            mesh.Lods.push_back({ 0, indexCount, 0.0f });
+            return handle;
+        }
+        mesh.IndexCount = static_cast<GLsizei>(lods.front().IndexCount);
+        mesh.Lods.assign(lods.begin(), lods.end());
+        return handle;
+    }
+
+    /**
+     * @brief Looks up a mesh by name, returns an invalid handle if it is not registered.
+     */
+    [[nodiscard]] MeshHandle Find(std::string_view name) const;
+
+    /**
+     * @brief Returns the mesh referenced by a valid handle.
+     */
+    [[nodiscard]] const Mesh& Get(MeshHandle handle) const { return Meshes[handle.Index]; }
+
+    /**
+     * @brief Returns the pool a mesh lives in; meshes of the same pool can share one multi-draw.
+     */
+    [[nodiscard]] const GeometryPool& GetPool(MeshHandle handle) const { return *Pools[Meshes[handle.Index].Pool]; }
+    [[nodiscard]] uint32 GetPoolIndex(MeshHandle handle) const { return Meshes[handle.Index].Pool; }
+
+    /**
+     * @brief Returns the number of geometry pools, one per registered vertex type and index type.
+     */
+    [[nodiscard]] size_t GetPoolCount() const noexcept { return Pools.size(); }
+
+    /**
+     * @brief Returns the number of unique meshes uploaded so far.
+     */
+    [[nodiscard]] size_t GetMeshCount() const noexcept { return Meshes.size(); }
+
+    /**
+     * @brief Returns the number of detail levels of a mesh, at least 1.
+     */
+    [[nodiscard]] uint32 GetLodCount(MeshHandle handle) const { return static_cast<uint32>(Meshes[handle.Index].Lods.size()); }
+
+    /**
+     * @brief Pixels covered by one object unit at distance 1, for a vertical field of view and viewport height.
+     */
+    [[nodiscard]] static float GetLodScale(float verticalFovRadians, float viewportHeight);
+
+    /**
+     * @brief Picks the coarsest level whose simplification error stays under `maxPixelError` on screen.
+     *
+     * @param distance View distance of the object.
+     * @param lodScale Result of GetLodScale() for the current camera.
+     * @param objectScale Scale of the model matrix, the error is stored in mesh units.
+     */
+    [[nodiscard]] uint32 SelectLod(MeshHandle handle, float distance, float lodScale, float objectScale = 1.0f, float maxPixelError = 1.0f) const;
+
+    /**
+     * @brief Draws one copy of the mesh at the given level of detail.
+     */
+    void Draw(MeshHandle handle, uint32 lod = 0) const;
+
+    /**
+     * @brief Draws `instanceCount` copies of the mesh with a single call.
+     *
+     * @param baseInstance Added to gl_InstanceID through gl_BaseInstance, so runs can share one instance buffer.
+     */
+    void DrawInstanced(MeshHandle handle, GLsizei instanceCount, uint32 lod = 0, uint32 baseInstance = 0) const;
+
+    /**
+     * @brief Builds the indirect command that draws the mesh at the given level of detail.
+     *
+     * @param baseInstance First instance, shaders read per-draw data at gl_BaseInstance + gl_InstanceID.
+     */
+    [[nodiscard]] DrawElementsIndirectCommand MakeIndirectCommand(MeshHandle handle, uint32 baseInstance, uint32 instanceCount = 1, uint32 lod = 0) const;
+
+    /**
+     * @brief Submits `drawCount` commands from the bound GL_DRAW_INDIRECT_BUFFER.
+     *
+     * The commands may draw any mesh of the same pool as `handle`, see GetPoolIndex().
+     *
+     * @param commandOffset Byte offset of the first command inside the indirect buffer.
+     */
+    void MultiDrawIndirect(MeshHandle handle, GLintptr commandOffset, GLsizei drawCount) const;
+
+    [[nodiscard]] bool HasVertexPulling() const noexcept { return PullPool != nullptr; }
+
+    /**
+     * @brief Vertex format index of a mesh, written to InstanceData::vertexFormat for the pulling shader.
+     */
+    [[nodiscard]] uint32 GetVertexFormat(MeshHandle handle) const { return Meshes[handle.Index].PullFormat; }
+
+    /**
+     * @brief Like MakeIndirectCommand(), for the vertex pulling copy of the mesh.
+     *
+     * baseVertex counts whole vertices of the mesh's format, so gl_VertexID times
+     * the stride is the word offset of the vertex in the pulled vertex buffer.
+     */
+    [[nodiscard]] DrawElementsIndirectCommand MakePulledIndirectCommand(MeshHandle handle, uint32 baseInstance, uint32 instanceCount = 1, uint32 lod = 0) const;
+
+    /**
+     * @brief Submits `drawCount` pulled commands of any mesh from the bound GL_DRAW_INDIRECT_BUFFER.
+     *
+     * Binds the pulling VAO, which has no attributes, and the vertex and format
+     * storage buffers; the shader must decode vertices itself.
+     */
+    void MultiDrawIndirectPulled(GLintptr commandOffset, GLsizei drawCount) const;
+
+private:
+    template <typename VertexType>
+    MeshHandle Upload(std::string_view name, std::span<const VertexType> vertices, const void* indices, uint32 indexCount, GLenum indexType)
+    {
+        const uint32 poolIndex = FindPool<VertexType>(MeshOptimizer::SelectIndexType(vertices.size()));
+        const GeometryPool::Range range = Pools[poolIndex]->Allocate(vertices.data(), static_cast<uint32>(vertices.size()),
+            indices, indexCount, indexType);
+        if (!range.IsValid())
+            return MeshHandle{};
+
+        // Aligning the data to whole vertices lets baseVertex address it in vertices of this format
+        static constexpr GPUVertexFormat format = MakeGPUVertexFormat<VertexType>();
+        GeometryPool::Range pullRange;
+        if (PullPool != nullptr)
+        {
+            pullRange = PullPool->Allocate(vertices.data(), static_cast<uint32>(vertices.size()) * format.StrideWords,
+                indices, indexCount, indexType, format.StrideWords);
+            if (!pullRange.IsValid())
+            {
+                // Without its pulled copy the mesh could be drawn by one path and not the other
+                std::cerr << "ERROR::MESH_REGISTRY::PULL_ALLOCATION_FAILED " << name << std::endl;
+                Pools[poolIndex]->Free(range);
+                return MeshHandle{};
+            }
+        }
+
+        const MeshHandle handle = CreateMesh(name);
+        Mesh& mesh = Meshes[handle.Index];
+        mesh.Pool = poolIndex;
+        mesh.Range = range;
+        mesh.IndexCount = static_cast<GLsizei>(indexCount);
+        if (PullPool != nullptr)
+        {
+            mesh.PullFormat = FindPullFormat(std::type_index(typeid(VertexType)), format);
+            mesh.PullRange = pullRange;
+        }
+        return handle;
+    }
+
+    // Pool of a vertex type and index type, created on first use
+    template <typename VertexType>
+    uint32 FindPool(GLenum indexType)
+    {
+        const auto [it, inserted] = PoolIndices.try_emplace(PoolKey(std::type_index(typeid(VertexType)), indexType),
+            static_cast<uint32>(Pools.size()));
+        if (inserted)
+        {
+            Pools.push_back(GeometryPool::Create<VertexType>(indexType));
+        }
+        return it->second;
+    }
+
+    MeshHandle CreateMesh(std::string_view name);
+
+    // Index of a vertex type in the pulling format table, uploaded again when a type is added
+    uint32 FindPullFormat(std::type_index type, const GPUVertexFormat& format);
+
+    // Byte offset of a level inside the pool's index buffer
+    [[nodiscard]] const void* IndexOffset(const Mesh& mesh, const MeshLod& lod) const;
+
+    using PoolKey = std::pair<std::type_index, GLenum>;
+
+    std::vector<Mesh> Meshes;
+    std::unordered_map<std::string, uint32> NameToIndex;
+
+    std::vector<std::unique_ptr<GeometryPool>> Pools;
+    std::map<PoolKey, uint32> PoolIndices;
+
+    std::unique_ptr<GeometryPool> PullPool;
+    std::unique_ptr<ShaderStorageBufferObject> PullFormatBuffer;
+    std::vector<GPUVertexFormat> PullFormats;
+    std::unordered_map<std::type_index, uint32> PullFormatIndices;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "Vertex.h"
+#include "Platform.h"
+
+/**
+ * @brief One level of detail: a range of a shared index buffer.
+ */
+struct MeshLod
+{
+    uint32 FirstIndex = 0;
+    uint32 IndexCount = 0;
+    float Error = 0.0f;  // Largest deviation from the full mesh, in object units
+};
+
+/**
+ * @brief Index buffer holding every level back to back, finest first.
+ */
+struct MeshLodChain
+{
+    std::vector<uint32> Indices;
+    std::vector<MeshLod> Lods;
+};
+
+/**
+ * @brief Quadric error metric simplification of indexed triangle meshes.
+ *
+ * Vertices are removed by collapsing them into a neighbour (half-edge
+ * collapse), so the vertex buffer is shared by every level and normals,
+ * tangents and uvs keep their authored values; only the index buffer changes.
+ * The cost of a collapse is the squared distance of the kept vertex to the
+ * planes around the removed one, plus a weighted normal and uv difference.
+ *
+ * Vertices on an open border or on an attribute seam (several vertices at one
+ * position) are never removed, which keeps silhouettes and uv charts intact.
+ * Collapses that flip a triangle or break the surface topology are rejected.
+ */
+class MeshSimplifier
+{
+public:
+    struct Options
+    {
+        uint32 MaxLods = 5;            // Levels including the full mesh
+        float ReductionRatio = 0.5f;   // Triangle count of a level relative to the one before it
+        float MinReduction = 0.1f;     // Stop when a level removes less than this share of triangles
+        float MaxError = 0.05f;        // Largest collapse error, relative to the mesh extent
+        float AttributeWeight = 0.25f; // Weight of normal and uv differences against squared relative distances
+    };
+
+    /**
+     * @brief Removes vertices until at most `targetIndexCount` indices remain or no collapse stays under Options::MaxError.
+     *
+     * @param resultError Receives the largest distance introduced, in object units.
+     */
+    [[nodiscard]] static std::vector<uint32> Simplify(std::span<const VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices,
+        size_t targetIndexCount, const Options& options, float* resultError = nullptr);
+
+    /**
+     * @brief Builds successively coarser levels, each simplified from the one before.
+     *
+     * Level 0 is the input itself. The chain ends early once a level can no
+     * longer be reduced meaningfully, so a mesh without removable vertices
+     * gets a single level.
+     */
+    [[nodiscard]] static MeshLodChain BuildLodChain(std::span<const VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices,
+        const Options& options);
+
+    [[nodiscard]] static MeshLodChain BuildLodChain(std::span<const VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices)
+    {
+        return BuildLodChain(vertices, indices, Options{});
+    }
+};
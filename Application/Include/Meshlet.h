@@ -0,0 +1,212 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "glm/glm.hpp"
+#include "AlignedAllocator.h"
+#include "Frustum.h"
+#include "Shaders.h"
+#include "SSBO.h"
+#include "IndirectBuffer.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "EBO.h"
+#include "Simd.h"
+#include "Platform.h"
+
+/**
+ * @brief Small cluster of a mesh's triangles with the bounds used to cull it (std430, must match MeshletCull.shader).
+ *
+ * The cone holds every triangle normal of the cluster: seen from any point
+ * where dot(center - eye, axis) >= cutoff * |center - eye| + radius, all of
+ * the triangles face away. A cutoff of 1 means the normals are spread too
+ * far for the cluster to ever be back-facing as a whole.
+ */
+struct Meshlet
+{
+    glm::vec4 Sphere;      // xyz: object-space center, w: radius
+    glm::vec4 Cone;        // xyz: unit axis, w: sine of the half angle
+    uint32 FirstIndex;     // Into MeshletBuilder::Result::Indices
+    uint32 TriangleCount;
+    uint32 VertexCount;    // Unique vertices referenced by the triangles
+    uint32 Padding;
+};
+static_assert(sizeof(Meshlet) == 48, "Meshlet must match the std430 layout in MeshletCull.shader");
+
+/**
+ * @brief Splits index buffers into meshlets of at most MaxVertices vertices and MaxTriangles triangles.
+ *
+ * Triangles are taken in index order, a meshlet is closed when the next
+ * triangle would exceed either limit, so an index buffer that went through
+ * MeshOptimizer::OptimizeVertexCache() already yields compact clusters.
+ * Bounds are computed afterwards, in parallel on the JobSystem.
+ */
+class MeshletBuilder
+{
+public:
+    static constexpr uint32 MaxVertices = 64;
+    static constexpr uint32 MaxTriangles = 124;
+
+    struct Result
+    {
+        std::vector<Meshlet> Meshlets;
+        std::vector<uint32> Indices;  // The triangles regrouped meshlet by meshlet, same vertex numbering as the input
+    };
+
+    /**
+     * @param positions Object-space position of every vertex.
+     */
+    [[nodiscard]] static Result Build(std::span<const uint32> indices, std::span<const glm::vec3> positions);
+
+    /**
+     * @brief Bounding sphere and normal cone of `triangles`; FirstIndex and the counts are left alone.
+     */
+    static void ComputeBounds(Meshlet& meshlet, std::span<const uint32> triangles, std::span<const glm::vec3> positions);
+};
+
+/**
+ * @brief CPU meshlet culling, stored as structure-of-arrays like CullingSystem.
+ *
+ * Cull() tests BatchWidth meshlets at a time against the six frustum planes
+ * and the normal cone and keeps the ones that may have a front-facing
+ * triangle on screen, in meshlet order. The frustum and eye position are in
+ * the object space of the mesh, see MeshletCullingPass::RunCPU().
+ */
+class MeshletCuller
+{
+public:
+    static constexpr size_t BatchWidth = Simd::Native::Width;
+
+    void Upload(std::span<const Meshlet> meshlets);
+
+    /**
+     * @brief Returns the number of meshlets that survive, their indices are in GetVisible().
+     */
+    size_t Cull(const Frustum& frustum, const glm::vec3& eye);
+
+    [[nodiscard]] size_t GetCount() const noexcept { return Count; }
+    [[nodiscard]] std::span<const uint32> GetVisible() const noexcept { return { Visible.data(), VisibleCount }; }
+
+private:
+    size_t Count = 0;
+
+    AlignedVector<float> CenterX, CenterY, CenterZ, Radius;
+    AlignedVector<float> AxisX, AxisY, AxisZ, Cutoff;
+
+    std::vector<uint32> Visible;
+    size_t VisibleCount = 0;
+};
+
+/**
+ * @brief Mesh split into meshlets, with its own vertex, index and meshlet buffers.
+ *
+ * The index buffer holds the triangles meshlet by meshlet, so every meshlet
+ * is one contiguous range that a DrawElementsIndirectCommand can address.
+ */
+class MeshletMesh
+{
+public:
+    template <typename VertexType>
+    MeshletMesh(std::span<const VertexType> vertices, std::span<const uint32> indices)
+    {
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            positions[i] = vertices[i].pos;
+        }
+
+        MeshletBuilder::Result result = MeshletBuilder::Build(indices, positions);
+        Meshlets = std::move(result.Meshlets);
+        Upload(vertices.data(), static_cast<uint32>(vertices.size()), sizeof(VertexType), result.Indices,
+            [](const VertexArrayObject& vao) { vao.EnableVertexAttributes<VertexType>(); });
+    }
+
+    MeshletMesh(const MeshletMesh&) = delete;
+    MeshletMesh& operator=(const MeshletMesh&) = delete;
+
+    /**
+     * @brief Binds the VAO, which also binds the meshlet index buffer.
+     */
+    void Bind() const { VAO.Bind(); }
+
+    void BindMeshlets(GLuint bindingIndex) const { MeshletBuffer.BindBase(bindingIndex); }
+
+    [[nodiscard]] std::span<const Meshlet> GetMeshlets() const noexcept { return Meshlets; }
+    [[nodiscard]] uint32 GetMeshletCount() const noexcept { return static_cast<uint32>(Meshlets.size()); }
+    [[nodiscard]] GLenum GetIndexType() const noexcept { return IndexType; }
+    [[nodiscard]] MeshletCuller& GetCuller() noexcept { return Culler; }
+
+private:
+    using AttributeSetup = void (*)(const VertexArrayObject&);
+
+    void Upload(const void* vertices, uint32 vertexCount, uint32 vertexStride, std::span<const uint32> indices, AttributeSetup setupAttributes);
+
+    std::vector<Meshlet> Meshlets;
+    MeshletCuller Culler;
+
+    VertexArrayObject VAO;
+    VertexBufferObject VBO;
+    ElementBufferObject EBO;
+    ShaderStorageBufferObject MeshletBuffer;
+    GLenum IndexType = GL_UNSIGNED_INT;
+};
+
+/**
+ * @brief Culls the meshlets of a MeshletMesh and draws the survivors with one indirect multi-draw.
+ *
+ * Both paths write one DrawElementsIndirectCommand per visible meshlet and
+ * the command count, which glMultiDrawElementsIndirectCount reads from the
+ * GPU, so Draw() is the same for either:
+ *  - RunCPU() culls with MeshletCuller and uploads the compacted commands.
+ *  - RunGPU() dispatches MeshletCull.shader, one invocation per meshlet,
+ *    which appends the commands itself; nothing is read back.
+ *
+ * Culling happens in object space. The model matrix may rotate, translate
+ * and scale uniformly; non-uniform scale would distort the bounding spheres.
+ */
+class MeshletCullingPass
+{
+public:
+    explicit MeshletCullingPass(std::string_view shaderPath);
+
+    MeshletCullingPass(const MeshletCullingPass&) = delete;
+    MeshletCullingPass& operator=(const MeshletCullingPass&) = delete;
+
+    /**
+     * @param baseInstance Written to every command, selects the InstanceData the meshlets are drawn with.
+     *
+     * Returns the number of visible meshlets.
+     */
+    uint32 RunCPU(MeshletMesh& mesh, const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& eye, uint32 baseInstance);
+
+    /**
+     * @brief Like RunCPU(), on the GPU. Leaves the compute program bound, rebind the graphics shader before drawing.
+     */
+    void RunGPU(const MeshletMesh& mesh, const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& eye, uint32 baseInstance);
+
+    /**
+     * @brief Draws the meshlets that survived the last run.
+     */
+    void Draw(const MeshletMesh& mesh) const;
+
+    /**
+     * @brief Reads back the number of visible meshlets.
+     *
+     * Waits for the GPU, only call it for statistics.
+     */
+    [[nodiscard]] uint32 ReadVisibleCount() const;
+
+private:
+    void Reserve(uint32 meshletCount);
+
+    ComputeShader Shader;
+    IndirectBufferObject CommandBuffer;
+    ShaderStorageBufferObject CountBuffer;  // Single uint, also bound as GL_PARAMETER_BUFFER for the draw
+
+    std::vector<DrawElementsIndirectCommand> Commands;
+    uint32 CommandCapacity = 0;
+    uint32 DrawCount = 0;  // Upper bound passed to the draw, the meshlet count of the last run
+    GLuint GroupSizeX = 1;
+};
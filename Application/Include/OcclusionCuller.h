@@ -0,0 +1,107 @@
+#pragma once
+
+#include <span>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+#include "AlignedAllocator.h"
+#include "Platform.h"
+
+/**
+ * @brief CPU occlusion culling against a low-resolution software depth buffer.
+ *
+ * Each frame the nearest candidates are taken as occluders. The screen
+ * outline of every occluder box (the convex hull of its projected corners)
+ * is rasterized into a small depth buffer with SSE, one job per band of tiles.
+ * Every 8x8 tile also keeps the farthest depth written to it, so most tests
+ * finish at tile level. The remaining candidates are then tested against
+ * the buffer and the visible ones are written to a compacted list.
+ *
+ * Both sides are conservative, so nothing visible is ever culled:
+ *  - an occluder only writes pixels it covers completely, at the depth of its farthest corner;
+ *  - an object is only occluded when the nearest point of its bounding sphere
+ *    lies behind the buffer at every pixel its screen rectangle touches.
+ * Needs no GPU, so it runs headless as well.
+ */
+class OcclusionCuller
+{
+public:
+    static constexpr uint32 TileSize = 8;
+
+    struct Stats
+    {
+        uint32 Occluders = 0;  // Boxes rasterized this frame
+        uint32 Tested = 0;
+        uint32 Occluded = 0;
+    };
+
+    /**
+     * @param width Buffer width in pixels, rounded up to a whole tile.
+     * @param height Buffer height in pixels, rounded up to a whole tile.
+     * @param maxOccluders Nearest candidates rasterized per frame.
+     */
+    OcclusionCuller(uint32 width = 256, uint32 height = 144, uint32 maxOccluders = 64);
+
+    /**
+     * @brief Rasterizes the nearest candidates and returns how many candidates are visible.
+     *
+     * @param candidates Ids that passed frustum culling.
+     * @param spheres Bounding sphere (center, radius) of every id.
+     * @param models Model matrix of every id; occluders are the unit cube [-0.5, 0.5]^3 under it.
+     */
+    size_t Cull(const glm::mat4& view, const glm::mat4& projection, std::span<const uint32> candidates,
+        std::span<const glm::vec4> spheres, std::span<const glm::mat4> models);
+
+    // Candidates that passed the last Cull(), in candidate order
+    [[nodiscard]] std::span<const uint32> GetVisible() const noexcept { return Visible; }
+
+    [[nodiscard]] const Stats& GetStats() const noexcept { return FrameStats; }
+
+    // NDC depth per pixel, rows bottom to top, 1 where nothing was drawn
+    [[nodiscard]] std::span<const float> GetDepth() const noexcept { return Depth; }
+
+    [[nodiscard]] uint32 GetWidth() const noexcept { return Width; }
+    [[nodiscard]] uint32 GetHeight() const noexcept { return Height; }
+
+private:
+    // Edge as A * x + B * y + C, at least 0 for pixels fully on its inner side
+    struct Edge
+    {
+        float A, B, C;
+    };
+
+    // Projected occluder: convex outline, constant depth and the pixels it can touch
+    struct OccluderShape
+    {
+        Edge Edges[8];
+        uint32 EdgeCount;
+        float Depth;
+        int32 XBegin, XEnd, YBegin, YEnd;
+    };
+
+    void SelectOccluders(const glm::mat4& view, std::span<const uint32> candidates, std::span<const glm::vec4> spheres);
+    void ProjectOccluders(const glm::mat4& viewProjection, std::span<const glm::mat4> models);
+
+    // Rasterizes every occluder into the rows of one band of tiles, then refreshes the tile depths
+    void RasterizeTileRow(uint32 tileRow);
+    void RasterizeShape(const OccluderShape& shape, int32 firstRow, int32 endRow);
+
+    [[nodiscard]] bool IsOccluded(const glm::vec4& sphere, const glm::mat4& view, const glm::mat4& projection) const;
+
+    uint32 Width;
+    uint32 Height;
+    uint32 TilesX;
+    uint32 TilesY;
+    uint32 MaxOccluders;
+
+    AlignedVector<float> Depth;
+    std::vector<float> TileMaxDepth;  // Farthest depth in every tile
+
+    std::vector<std::pair<float, uint32>> CandidateDepths;  // View depth and id, scratch for occluder selection
+    std::vector<uint32> Occluders;
+    std::vector<OccluderShape> Shapes;  // Occluders in front of the near plane
+
+    std::vector<uint8> OccludedFlags;
+    std::vector<uint32> Visible;
+    Stats FrameStats;
+};
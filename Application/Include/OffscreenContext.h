@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "Platform.h"
+
+/**
+ * @brief OpenGL context without a visible window, used by the headless benchmark.
+ *
+ * On Linux the context is created directly through EGL on the surfaceless
+ * platform (Mesa llvmpipe works without X or a GPU). Other platforms fall
+ * back to a hidden GLFW window. There is no default framebuffer to render
+ * to in either case, rendering goes through a FrameBufferObject.
+ */
+class OffscreenContext
+{
+public:
+    OffscreenContext() = default;
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    /**
+     * @brief Creates the context, makes it current and loads the GL entry points.
+     *
+     * @return false if no context of the requested version could be created.
+     */
+    bool Create(int major, int minor);
+
+    void Destroy();
+
+    [[nodiscard]] bool IsValid() const noexcept { return Valid; }
+
+private:
+    bool Valid = false;
+
+#ifdef LINUX
+    void* Display = nullptr;  // EGLDisplay
+    void* Context = nullptr;  // EGLContext
+#else
+    GLFWwindow* Window = nullptr;
+#endif
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "Platform.h"
+
+/**
+ * @brief Two-level segregated fit (TLSF) allocator over an abstract range of units.
+ *
+ * Manages offsets only, the memory itself lives elsewhere (e.g. in a GL
+ * buffer), so units can be vertices, indices or bytes. Free ranges are kept
+ * in 8 bins per power of two; a two-level bitmap finds the first bin whose
+ * ranges are all large enough, so Allocate() and Free() run in constant
+ * time. Freed ranges merge with free neighbours immediately.
+ */
+class RangeAllocator
+{
+public:
+    static constexpr uint32 InvalidOffset = ~0u;
+
+    struct Allocation
+    {
+        uint32 Offset = InvalidOffset;
+        uint32 Size = 0;
+        uint32 Node = InvalidOffset;  // Internal block, passed back to Free()
+
+        [[nodiscard]] bool IsValid() const noexcept { return Offset != InvalidOffset; }
+    };
+
+    explicit RangeAllocator(uint32 size = 0);
+
+    /**
+     * @brief Returns an invalid allocation if no free range of `size` units exists.
+     */
+    [[nodiscard]] Allocation Allocate(uint32 size);
+
+    void Free(const Allocation& allocation);
+
+    /**
+     * @brief Extends the managed range to `newSize` units, the added units are free.
+     */
+    void Grow(uint32 newSize);
+
+    [[nodiscard]] uint32 GetSize() const noexcept { return Size; }
+    [[nodiscard]] uint32 GetFreeSize() const noexcept { return FreeSize; }
+
+private:
+    static constexpr uint32 SecondLevelBits = 3;
+    static constexpr uint32 BinsPerLevel = 1u << SecondLevelBits;
+    static constexpr uint32 LevelCount = 32;
+    static constexpr uint32 BinCount = LevelCount * BinsPerLevel;
+    static constexpr uint32 InvalidNode = ~0u;
+
+    struct Node
+    {
+        uint32 Offset = 0;
+        uint32 Size = 0;
+        uint32 BinPrevious = InvalidNode;       // Free list of the bin
+        uint32 BinNext = InvalidNode;
+        uint32 NeighbourPrevious = InvalidNode; // Adjacent blocks in address order
+        uint32 NeighbourNext = InvalidNode;
+        bool Used = false;
+    };
+
+    // Bin holding ranges of `size`, rounding down
+    static uint32 BinOf(uint32 size) noexcept;
+
+    // Smallest size stored in a bin
+    static uint32 BinMinimum(uint32 bin) noexcept;
+
+    // First non-empty bin at or after `bin`, InvalidNode if there is none
+    [[nodiscard]] uint32 FindBin(uint32 bin) const noexcept;
+
+    uint32 CreateNode(uint32 offset, uint32 size);
+    void ReleaseNode(uint32 node);
+    void InsertFree(uint32 node);
+    void RemoveFree(uint32 node);
+
+    uint32 Size = 0;
+    uint32 FreeSize = 0;
+    uint32 Tail = InvalidNode;  // Block at the end of the range
+
+    std::vector<Node> Nodes;
+    std::vector<uint32> UnusedNodes;
+    std::array<uint32, BinCount> BinHeads;
+    std::array<uint8, LevelCount> BinMasks{};  // Non-empty bins of every level
+    uint32 LevelMask = 0;                       // Levels with a non-empty bin
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "Platform.h"
+
+/**
+ * @brief Render passes, executed in enum order.
+ */
+enum class RenderPass : uint8
+{
+    Opaque = 0,
+    Transparent = 1
+};
+
+/**
+ * @brief 64-bit draw sort key.
+ *
+ * Bit layout, most significant first:
+ *   [63..62] pass       - passes never interleave
+ *   [61..52] shader     - program switches are the most expensive state change
+ *   [51..40] mesh       - VAO / index buffer switches
+ *   [39..20] depth      - quantized view depth, front-to-back for opaque, back-to-front for transparent
+ *   [19..0]  material   - only a table index, so it is the cheapest to change
+ */
+namespace SortKey
+{
+    constexpr uint32 PassBits = 2;
+    constexpr uint32 ShaderBits = 10;
+    constexpr uint32 MeshBits = 12;
+    constexpr uint32 DepthBits = 20;
+    constexpr uint32 MaterialBits = 20;
+
+    constexpr uint32 MaterialShift = 0;
+    constexpr uint32 DepthShift = MaterialShift + MaterialBits;
+    constexpr uint32 MeshShift = DepthShift + DepthBits;
+    constexpr uint32 ShaderShift = MeshShift + MeshBits;
+    constexpr uint32 PassShift = ShaderShift + ShaderBits;
+    static_assert(PassShift + PassBits == 64, "Sort key fields must fill 64 bits");
+
+    constexpr uint64 Mask(uint32 bits) { return (uint64{ 1 } << bits) - 1; }
+
+    /**
+     * @brief Packs a sort key, fields wider than their bit budget are truncated.
+     *
+     * @param depth01 View depth normalized to [0, 1] between the near and far planes.
+     */
+    [[nodiscard]] constexpr uint64 Make(RenderPass pass, uint32 shader, uint32 mesh, uint32 material, float depth01)
+    {
+        const float clamped = depth01 < 0.0f ? 0.0f : (depth01 > 1.0f ? 1.0f : depth01);
+        uint64 depth = static_cast<uint64>(clamped * static_cast<float>(Mask(DepthBits)));
+        if (pass == RenderPass::Transparent)
+        {
+            depth = Mask(DepthBits) - depth;
+        }
+
+        return (static_cast<uint64>(pass) & Mask(PassBits)) << PassShift
+            | (static_cast<uint64>(shader) & Mask(ShaderBits)) << ShaderShift
+            | (static_cast<uint64>(mesh) & Mask(MeshBits)) << MeshShift
+            | (depth & Mask(DepthBits)) << DepthShift
+            | (static_cast<uint64>(material) & Mask(MaterialBits)) << MaterialShift;
+    }
+
+    [[nodiscard]] constexpr uint32 GetShader(uint64 key) { return static_cast<uint32>((key >> ShaderShift) & Mask(ShaderBits)); }
+    [[nodiscard]] constexpr uint32 GetMesh(uint64 key) { return static_cast<uint32>((key >> MeshShift) & Mask(MeshBits)); }
+    [[nodiscard]] constexpr uint32 GetMaterial(uint64 key) { return static_cast<uint32>((key >> MaterialShift) & Mask(MaterialBits)); }
+}
+
+/**
+ * @brief One queued draw: its sort key and the index of the draw command it refers to.
+ */
+struct RenderItem
+{
+    uint64 Key;
+    uint32 CommandIndex;
+};
+
+/**
+ * @brief Collects visible draws and orders them by sort key.
+ *
+ * Push() the visible draws in submission order, then Sort(). Sorting uses a
+ * parallel LSD radix sort (on the job system) over the bytes of the key that
+ * actually differ.
+ */
+class RenderQueue
+{
+public:
+    /**
+     * @brief Shader, mesh and material switches of the last sorted frame.
+     */
+    struct Stats
+    {
+        uint32 StateChangesUnsorted = 0;  // Switches if the draws were submitted in push order
+        uint32 StateChangesSorted = 0;    // Switches in sorted order
+
+        [[nodiscard]] int32 GetSaved() const noexcept
+        {
+            return static_cast<int32>(StateChangesUnsorted) - static_cast<int32>(StateChangesSorted);
+        }
+    };
+
+    RenderQueue() = default;
+
+    void Reserve(size_t count);
+
+    void Clear() noexcept { Items.clear(); }
+
+    void Push(uint64 key, uint32 commandIndex) { Items.push_back({ key, commandIndex }); }
+
+    /**
+     * @brief Sorts the queued items by key and updates the state change statistics.
+     *
+     * The sort is stable, items with equal keys stay in push order.
+     */
+    void Sort();
+
+    [[nodiscard]] std::span<const RenderItem> GetItems() const noexcept { return Items; }
+
+    [[nodiscard]] size_t GetSize() const noexcept { return Items.size(); }
+
+    [[nodiscard]] const Stats& GetStats() const noexcept { return LastStats; }
+
+    /**
+     * @brief Counts shader, mesh and material switches between consecutive items.
+     */
+    [[nodiscard]] static uint32 CountStateChanges(std::span<const RenderItem> items) noexcept;
+
+private:
+    void RadixSort();
+
+    std::vector<RenderItem> Items;
+    std::vector<RenderItem> Scratch;
+    std::vector<uint32> ChunkHistograms;  // 256 counters per chunk
+    Stats LastStats;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include <array>
+
+class ShaderStorageBufferObject
+{
+public:
+    // Constructor
+    // Generates a buffer ID for the Shader Storage Buffer Object (SSBO) using OpenGL.
+    ShaderStorageBufferObject();
+
+    // Destructor
+    // Deletes the SSBO using its buffer ID to free up resources when the object goes out of scope.
+    ~ShaderStorageBufferObject();
+
+    // SSBOs own GPU storage, copying would double-delete the buffer ID
+    ShaderStorageBufferObject(const ShaderStorageBufferObject&) = delete;
+    ShaderStorageBufferObject& operator=(const ShaderStorageBufferObject&) = delete;
+
+    // Bind the SSBO
+    // Binds the SSBO to the generic GL_SHADER_STORAGE_BUFFER target.
+    void Bind() const;
+
+    // Unbind the SSBO
+    // Unbinds the SSBO by binding the buffer to 0 for the GL_SHADER_STORAGE_BUFFER target.
+    void Unbind() const;
+
+    // Bind the SSBO to an indexed binding point
+    // Makes the whole buffer visible to shaders at `layout(std430, binding = bindingIndex)`.
+    //
+    // Parameters:
+    // - bindingIndex: The shader storage binding point.
+    void BindBase(GLuint bindingIndex) const;
+
+    // Upload data to the SSBO
+    // Replaces the data store of the SSBO with `size` bytes from `data`.
+    //
+    // Parameters:
+    // - size: The size in bytes of the data to be uploaded.
+    // - data: A pointer to the data to be uploaded.
+    // - usage: The expected usage pattern of the data store (e.g., GL_STATIC_DRAW, GL_DYNAMIC_DRAW, or GL_STREAM_DRAW).
+    void UploadData(GLsizeiptr size, const void* data, GLenum usage = GL_DYNAMIC_DRAW);
+
+    // Upload data from std::vector
+    // Uploads data to the SSBO using a std::vector.
+    //
+    // Parameters:
+    // - data: The std::vector containing the data to be uploaded.
+    // - usage: The expected usage pattern of the data store.
+    template <typename T>
+    inline void UploadData(const std::vector<T>& data, GLenum usage = GL_DYNAMIC_DRAW)
+    {
+        UploadData(static_cast<GLsizeiptr>(data.size() * sizeof(T)), data.data(), usage);
+    }
+
+    // Upload data from std::array
+    // Uploads data to the SSBO using a std::array.
+    //
+    // Parameters:
+    // - data: The std::array containing the data to be uploaded.
+    // - usage: The expected usage pattern of the data store.
+    template <typename T, std::size_t N>
+    inline void UploadData(const std::array<T, N>& data, GLenum usage = GL_DYNAMIC_DRAW)
+    {
+        UploadData(static_cast<GLsizeiptr>(N * sizeof(T)), data.data(), usage);
+    }
+
+    // Update part of the SSBO
+    // Overwrites `size` bytes at `offset` without reallocating the data store.
+    //
+    // Parameters:
+    // - offset: The byte offset into the data store.
+    // - size: The size in bytes of the data to be written.
+    // - data: A pointer to the new data.
+    void UpdateData(GLintptr offset, GLsizeiptr size, const void* data) const;
+
+    // Get the buffer ID
+    // Returns the unique OpenGL ID of the SSBO.
+    //
+    // Returns:
+    // - The OpenGL buffer ID as a GLuint.
+    inline const GLuint GetBufferID() const { return BufferID; }
+
+    // Get the size of the data store
+    // Returns the size in bytes of the last upload.
+    inline const GLsizeiptr GetSize() const { return Size; }
+
+private:
+    GLuint BufferID;       // OpenGL ID for the Shader Storage Buffer Object (SSBO)
+    GLsizeiptr Size = 0;   // Size in bytes of the current data store
+};
+
+using SSBO = ShaderStorageBufferObject;
@@ -7,6 +7,7 @@
 #include <concepts>
 #include <span>
 #include "glm/glm.hpp"
+#include "GLState.h"
 
 #if __has_include(<flat_map>)
 #include <flat_map>
@@ -40,6 +41,7 @@ public:
     {
         if (m_shaderID != 0) [[likely]]
         {
+            GLStateCache::GetInstance().OnProgramDeleted(m_shaderID);
             glDeleteProgram(m_shaderID);
         }
     }
@@ -61,6 +63,7 @@ public:
         {
             if (m_shaderID != 0)
             {
+                GLStateCache::GetInstance().OnProgramDeleted(m_shaderID);
                 glDeleteProgram(m_shaderID);
             }
 
@@ -77,7 +80,7 @@ public:
     {
         if (m_shaderID != 0) [[likely]]
         {
-            glUseProgram(m_shaderID);
+            GLStateCache::GetInstance().UseProgram(m_shaderID);
         }
     }
 
@@ -86,7 +89,7 @@ public:
      */
     static void Unbind() noexcept
     {
-        glUseProgram(0);
+        GLStateCache::GetInstance().UseProgram(0);
     }
 
     /**
@@ -165,6 +168,11 @@ public:
         glUniform4f(GetUniformLocation(name), x, y, z, w);
     }
 
+    void SetVec4Array(std::string_view name, std::span<const glm::vec4> values) const noexcept
+    {
+        glUniform4fv(GetUniformLocation(name), static_cast<GLsizei>(values.size()), &values[0][0]);
+    }
+
     void SetMat2(std::string_view name, const glm::mat2& mat) const noexcept
     {
         glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
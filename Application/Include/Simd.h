@@ -0,0 +1,80 @@
+#pragma once
+
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "Platform.h"
+
+/**
+ * @brief Thin wrappers over the vector instructions the SIMD loops use.
+ *
+ * Loops are written once as templates over a wrapper and instantiated for
+ * Simd::Native, the widest instruction set the build targets. Loads expect
+ * SIMD_ALIGNMENT aligned data, see AlignedVector. Int holds one 32-bit
+ * integer per float lane, for bit tricks on the float results.
+ */
+namespace Simd
+{
+    // 4-wide SSE2 operations
+    struct Sse2
+    {
+        using Float = __m128;
+        using Int = __m128i;
+        static constexpr size_t Width = 4;
+
+        static Float Set(float value) { return _mm_set1_ps(value); }
+        static Float Load(const float* source) { return _mm_load_ps(source); }
+        static Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+        static Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+        static Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+        static Float Sqrt(Float a) { return _mm_sqrt_ps(a); }
+        static Float And(Float a, Float b) { return _mm_and_ps(a, b); }
+        static Float Xor(Float a, Float b) { return _mm_xor_ps(a, b); }
+        static Float Select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+        static Float Less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+        static Float GreaterEqual(Float a, Float b) { return _mm_cmpge_ps(a, b); }
+        static uint32 MoveMask(Float a) { return static_cast<uint32>(_mm_movemask_ps(a)); }
+
+        static Int RoundToInt(Float a) { return _mm_cvtps_epi32(a); }
+        static Float ToFloat(Int a) { return _mm_cvtepi32_ps(a); }
+        static Int AndInt(Int a, int b) { return _mm_and_si128(a, _mm_set1_epi32(b)); }
+        static Int AddInt(Int a, int b) { return _mm_add_epi32(a, _mm_set1_epi32(b)); }
+        static Float EqualMask(Int a, int b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_set1_epi32(b))); }
+        static Float SignFromBit1(Int a) { return _mm_castsi128_ps(_mm_slli_epi32(a, 30)); }  // Bit 1 moved to the sign bit
+    };
+
+#ifdef __AVX2__
+    // 8-wide AVX2 operations
+    struct Avx2
+    {
+        using Float = __m256;
+        using Int = __m256i;
+        static constexpr size_t Width = 8;
+
+        static Float Set(float value) { return _mm256_set1_ps(value); }
+        static Float Load(const float* source) { return _mm256_load_ps(source); }
+        static Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+        static Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+        static Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+        static Float Sqrt(Float a) { return _mm256_sqrt_ps(a); }
+        static Float And(Float a, Float b) { return _mm256_and_ps(a, b); }
+        static Float Xor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+        static Float Select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+        static Float Less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static Float GreaterEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static uint32 MoveMask(Float a) { return static_cast<uint32>(_mm256_movemask_ps(a)); }
+
+        static Int RoundToInt(Float a) { return _mm256_cvtps_epi32(a); }
+        static Float ToFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+        static Int AndInt(Int a, int b) { return _mm256_and_si256(a, _mm256_set1_epi32(b)); }
+        static Int AddInt(Int a, int b) { return _mm256_add_epi32(a, _mm256_set1_epi32(b)); }
+        static Float EqualMask(Int a, int b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_set1_epi32(b))); }
+        static Float SignFromBit1(Int a) { return _mm256_castsi256_ps(_mm256_slli_epi32(a, 30)); }
+    };
+
+    using Native = Avx2;
+#else
+    using Native = Sse2;
+#endif
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <span>
+#include <vector>
+#include "Platform.h"
+
+/**
+ * @brief Persistently mapped ring buffer for data rewritten every frame.
+ *
+ * The storage is allocated once with glBufferStorage and stays mapped
+ * (persistent and coherent), so per-frame data is written straight into
+ * memory the GPU reads, without glBufferData reallocations or driver copies.
+ *
+ * The buffer is split into `frameCount` equal regions. Every frame allocates
+ * from its own region; EndFrame() fences it, and BeginFrame() waits for that
+ * fence before the region is reused `frameCount` frames later, so the CPU
+ * never overwrites data the GPU may still read.
+ */
+class StreamBuffer
+{
+public:
+    /**
+     * @brief Sub-allocation inside the current frame region.
+     */
+    struct Allocation
+    {
+        void* Data = nullptr;  // Mapped memory, write only: it is usually write-combined
+        GLintptr Offset = 0;   // Byte offset inside the buffer, to bind or to add to indirect offsets
+        GLsizeiptr Size = 0;
+
+        [[nodiscard]] bool IsValid() const noexcept { return Data != nullptr; }
+    };
+
+    /**
+     * @param frameSize Bytes available to each frame.
+     * @param frameCount Frames in flight, 3 covers the usual CPU/driver/GPU pipelining.
+     */
+    StreamBuffer(GLsizeiptr frameSize, uint32 frameCount = 3);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    /**
+     * @brief Moves to the next frame region, waiting for the GPU if it still reads it.
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Fences the commands that read the current region, call after the frame's last draw.
+     */
+    void EndFrame();
+
+    /**
+     * @brief Reserves `size` bytes of the current frame.
+     *
+     * @param alignment Power of two, 0 uses GetDefaultAlignment() which suits storage and uniform bindings.
+     * @return An invalid allocation when the frame region is full.
+     */
+    [[nodiscard]] Allocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 0);
+
+    /**
+     * @brief Reserves `count` objects of T, the span is empty when the frame region is full.
+     */
+    template <typename T>
+    [[nodiscard]] std::span<T> Allocate(size_t count, Allocation& allocation, GLsizeiptr alignment = 0)
+    {
+        allocation = Allocate(static_cast<GLsizeiptr>(count * sizeof(T)), alignment);
+        return allocation.IsValid() ? std::span<T>(static_cast<T*>(allocation.Data), count) : std::span<T>();
+    }
+
+    /**
+     * @brief Binds an allocation to an indexed GL_SHADER_STORAGE_BUFFER or GL_UNIFORM_BUFFER binding.
+     */
+    void BindRange(GLenum target, GLuint bindingIndex, const Allocation& allocation) const;
+
+    /**
+     * @brief Binds the whole buffer to a non-indexed target, e.g. GL_DRAW_INDIRECT_BUFFER.
+     */
+    void Bind(GLenum target) const;
+
+    [[nodiscard]] GLuint GetBufferID() const noexcept { return BufferID; }
+    [[nodiscard]] GLsizeiptr GetFrameSize() const noexcept { return FrameSize; }
+    [[nodiscard]] GLsizeiptr GetDefaultAlignment() const noexcept { return DefaultAlignment; }
+
+    // Bytes allocated in the current frame
+    [[nodiscard]] GLsizeiptr GetFrameUsage() const noexcept { return Head; }
+
+    // Frames that had to wait for the GPU to release their region
+    [[nodiscard]] uint32 GetStallCount() const noexcept { return StallCount; }
+
+private:
+    GLuint BufferID = 0;
+    uint8* Mapped = nullptr;
+    GLsizeiptr FrameSize;
+    GLsizeiptr DefaultAlignment = 256;
+
+    std::vector<GLsync> Fences;  // One per frame region, null once waited on
+    uint32 Frame = 0;            // Current region
+    GLsizeiptr Head = 0;         // Next free byte inside the current region
+    uint32 StallCount = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "AlignedAllocator.h"
+#include "Platform.h"
+
+/**
+ * @brief Parent/child transforms with incremental world matrix updates.
+ *
+ * Nodes live in flat arrays sorted by parent: a parent always has a lower
+ * index than its children, so one front-to-back sweep sees every parent
+ * before its children. Every node has a local translation, rotation and
+ * scale and a world matrix, world = parent world * local.
+ *
+ * Changing a local transform only flags the node. Update() finds the dirty
+ * nodes that have no dirty ancestor, each the root of an independent
+ * subtree, and rebuilds those subtrees in parallel on the JobSystem. Nodes
+ * that did not move, and everything below them, are never touched, so a
+ * frame in which nothing moved costs nothing.
+ */
+class TransformHierarchy
+{
+public:
+    static constexpr uint32 NoParent = ~0u;
+
+    // Dirty subtrees per job in Update()
+    static constexpr size_t SubtreesPerTask = 16;
+
+    struct LocalTransform
+    {
+        glm::vec3 Position = glm::vec3(0.0f);
+        glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 Scale = glm::vec3(1.0f);
+    };
+
+    TransformHierarchy() = default;
+
+    void Reserve(size_t count);
+
+    /**
+     * @brief Adds a node and returns its index; the node starts dirty.
+     *
+     * @param parent An existing node or NoParent, so parents always precede their children; anything else is reported and treated as NoParent.
+     */
+    uint32 Add(const LocalTransform& local, uint32 parent = NoParent);
+
+    void Clear();
+
+    void SetLocal(uint32 index, const LocalTransform& local);
+    void SetPosition(uint32 index, const glm::vec3& position);
+    void SetRotation(uint32 index, const glm::quat& rotation);
+
+    /**
+     * @brief Rebuilds the world matrices of every dirty subtree, in parallel, and returns how many were written.
+     */
+    size_t Update();
+
+    /**
+     * @brief Rebuilds every world matrix in one sweep on the calling thread, dirty or not.
+     */
+    void UpdateAll();
+
+    [[nodiscard]] size_t GetCount() const noexcept { return Locals.size(); }
+    [[nodiscard]] size_t GetDirtyCount() const noexcept { return DirtyNodes.size(); }
+
+    [[nodiscard]] uint32 GetParent(uint32 index) const noexcept { return Parents[index]; }
+    [[nodiscard]] const LocalTransform& GetLocal(uint32 index) const noexcept { return Locals[index]; }
+
+    // Valid for nodes that were clean at the last Update()
+    [[nodiscard]] const glm::mat4& GetWorld(uint32 index) const noexcept { return Worlds[index]; }
+    [[nodiscard]] std::span<const glm::mat4> GetWorlds() const noexcept { return { Worlds.data(), Worlds.size() }; }
+
+private:
+    void MarkDirty(uint32 index);
+    [[nodiscard]] bool HasDirtyAncestor(uint32 index) const;
+
+    /**
+     * @brief Rebuilds `root` and all of its descendants depth-first, returns the number of nodes.
+     */
+    size_t UpdateSubtree(uint32 root, std::vector<uint32>& stack);
+
+    void UpdateWorld(uint32 index);
+
+    std::vector<LocalTransform> Locals;
+    AlignedVector<glm::mat4> Worlds;
+
+    // Children of a node form a list in index order
+    std::vector<uint32> Parents;
+    std::vector<uint32> FirstChildren;
+    std::vector<uint32> LastChildren;
+    std::vector<uint32> NextSiblings;
+
+    std::vector<uint8> Dirty;
+    std::vector<uint32> DirtyNodes;  // Every node with Dirty set, in the order they were flagged
+    std::vector<uint32> DirtyRoots;
+};
@@ -4,6 +4,7 @@
 #include <vector>
 #include <array>
 #include "Vertex.h"
+#include "GLState.h"
 
 class VertexArrayObject
 {
@@ -26,6 +27,8 @@ public:
 
     // Attach a Vertex Buffer Object (VBO) to the VAO
     // Binds a Vertex Buffer Object (VBO) to the VAO, specifying it as the current buffer for vertex attributes.
+    // With DSA the VAO does not need to be bound: the buffer goes to vertex buffer binding 0, which all
+    // attributes read from, so attaching a new buffer keeps the attribute formats.
     //
     // Parameters:
     // - vboID: The unique ID of the VBO to attach.
@@ -33,6 +36,7 @@ public:
 
     // Attach an Element Buffer Object (EBO) to the VAO
     // Binds an Element Buffer Object (EBO) to the VAO, specifying it as the current buffer for index data.
+    // With DSA the VAO does not need to be bound.
     //
     // Parameters:
     // - eboID: The unique ID of the EBO to attach.
@@ -41,6 +45,8 @@ public:
     // Enable vertex attribute arrays and set vertex attribute pointers
     // Sets up and enables a vertex attribute pointer, which defines how vertex attribute data (e.g., position, color)
     // is stored in the vertex buffer and passed to the vertex shader.
+    // With DSA this sets the attribute format (glVertexArrayAttribFormat) on binding 0 and the stride of that binding,
+    // without binding the VAO; otherwise the VAO and the VBO must be bound.
     //
     // Parameters:
     // - index: The index of the vertex attribute to enable (corresponds to the layout location in the shader).
@@ -51,16 +57,23 @@ public:
     // - pointer: A pointer to the first component of the first vertex attribute in the buffer (often an offset).
     void EnableAttribute(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) const;
 
+    // Enable an integer vertex attribute
+    // Same as EnableAttribute, but the shader reads the values unconverted as int/uint vectors (glVertexAttribIPointer).
+    void EnableIntegerAttribute(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) const;
+
     // Template function to enable vertex attributes for a given VertexType.
     // Uses the VertexLayout specialization for the provided VertexType.
     template <typename VertexType>
     void EnableVertexAttributes() const
     {
-        auto attributes = VertexLayout<VertexType>::GetAttributes();
-        for (const auto& attrib : attributes)
+        // The layout is a constexpr array, so the loop unrolls into the GL calls without touching the heap
+        for (const VertexAttrib& attrib : VertexLayout<VertexType>::Attributes)
         {
             // The pointer is specified as an offset (cast to const void*) assuming the VBO is already bound.
-            EnableAttribute(attrib.index, attrib.size, attrib.type, attrib.normalized, attrib.stride, (const void*)(attrib.offset));
+            if (attrib.integer)
+                EnableIntegerAttribute(attrib.index, attrib.size, attrib.type, attrib.stride, reinterpret_cast<const void*>(static_cast<uintptr_t>(attrib.offset)));
+            else
+                EnableAttribute(attrib.index, attrib.size, attrib.type, attrib.normalized, attrib.stride, reinterpret_cast<const void*>(static_cast<uintptr_t>(attrib.offset)));
         }
     }
 
@@ -73,6 +86,10 @@ public:
 
 private:
     GLuint ArrayID;  // Unique OpenGL ID for the Vertex Array Object (VAO)
+
+    // DSA keeps the buffer and its stride in one binding point, set by whichever of attach/enable comes last
+    mutable GLuint VertexBufferID = 0;
+    mutable GLsizei VertexStride = 0;
 };
 
 using VAO = VertexArrayObject;
@@ -94,29 +111,29 @@ public:
 
     // Delete the Global VAO
     // Deletes the Global VAO using its unique ID to free resources.
-    void Delete() const { glDeleteVertexArrays(1, &ArrayID); }
+    void Delete() const { GLStateCache::GetInstance().OnVertexArrayDeleted(ArrayID); glDeleteVertexArrays(1, &ArrayID); }
 
     // Bind the Global VAO
     // Binds the Global VAO, making it the current VAO for subsequent OpenGL commands.
-    void Bind() const { glBindVertexArray(ArrayID); }
+    void Bind() const { GLStateCache::GetInstance().BindVertexArray(ArrayID); }
 
     // Unbind the Global VAO
     // Unbinds the current VAO by binding VAO 0, effectively stopping the use of any VAO.
-    void Unbind() const { glBindVertexArray(0); }
+    void Unbind() const { GLStateCache::GetInstance().BindVertexArray(0); }
 
     // Attach a Vertex Buffer Object (VBO) to the Global VAO
     // Binds a Vertex Buffer Object (VBO) to the Global VAO for vertex attributes.
     //
     // Parameters:
     // - vboID: The unique ID of the VBO to attach.
-    void AttachVertexBuffer(const GLuint vboID) const { glBindBuffer(GL_ARRAY_BUFFER, vboID); }
+    void AttachVertexBuffer(const GLuint vboID) const { GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, vboID); }
 
     // Attach an Element Buffer Object (EBO) to the Global VAO
     // Binds an Element Buffer Object (EBO) to the Global VAO for index data.
     //
     // Parameters:
     // - eboID: The unique ID of the EBO to attach.
-    void AttachElementBuffer(const GLuint eboID) const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboID); }
+    void AttachElementBuffer(const GLuint eboID) const { GLStateCache::GetInstance().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboID); }
 
     // Enable vertex attribute arrays and set vertex attribute pointers for the Global VAO
     // Sets up and enables a vertex attribute pointer, defining how vertex attribute data is stored and passed to the shader.
@@ -134,16 +151,26 @@ public:
         glEnableVertexAttribArray(index);
     }
 
+    // Enable an integer vertex attribute for the Global VAO, read unconverted as int/uint vectors in the shader.
+    void EnableIntegerAttribute(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) const
+    {
+        glVertexAttribIPointer(index, size, type, stride, pointer);
+        glEnableVertexAttribArray(index);
+    }
+
     // Template function to enable vertex attributes for a given VertexType.
     // Uses the VertexLayout specialization for the provided VertexType.
     template <typename VertexType>
     void EnableVertexAttributes() const
     {
-        auto attributes = VertexLayout<VertexType>::GetAttributes();
-        for (const auto& attrib : attributes)
+        // The layout is a constexpr array, so the loop unrolls into the GL calls without touching the heap
+        for (const VertexAttrib& attrib : VertexLayout<VertexType>::Attributes)
         {
             // The pointer is specified as an offset (cast to const void*) assuming the VBO is already bound.
-            EnableAttribute(attrib.index, attrib.size, attrib.type, attrib.normalized, attrib.stride, (const void*)(attrib.offset));
+            if (attrib.integer)
+                EnableIntegerAttribute(attrib.index, attrib.size, attrib.type, attrib.stride, reinterpret_cast<const void*>(static_cast<uintptr_t>(attrib.offset)));
+            else
+                EnableAttribute(attrib.index, attrib.size, attrib.type, attrib.normalized, attrib.stride, reinterpret_cast<const void*>(static_cast<uintptr_t>(attrib.offset)));
         }
     }
 
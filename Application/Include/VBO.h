@@ -4,6 +4,7 @@
 #include <vector>
 #include <array>
 #include "Vertex.h"
+#include "GLState.h"
 
 class VertexBufferObject
 {
@@ -22,27 +23,31 @@ public:
     // Parameters:
     // - target: The target to which the buffer object is bound (e.g., GL_ARRAY_BUFFER for vertex attributes
     //           or GL_ELEMENT_ARRAY_BUFFER for element indices).
-    inline void Bind(GLenum target = GL_ARRAY_BUFFER) const { glBindBuffer(target, BufferID); }
+    inline void Bind(GLenum target = GL_ARRAY_BUFFER) const { GLStateCache::GetInstance().BindBuffer(target, BufferID); }
 
     // Unbind the VBO
     // Unbinds the VBO by binding the buffer to 0 for the specified target (default is GL_ARRAY_BUFFER).
     //
     // Parameters:
     // - target: The target from which the buffer object will be unbound.
-    inline void Unbind(GLenum target = GL_ARRAY_BUFFER) const { glBindBuffer(target, 0); }
+    inline void Unbind(GLenum target = GL_ARRAY_BUFFER) const { GLStateCache::GetInstance().BindBuffer(target, 0); }
 
     // Upload data to the VBO
     // Uploads data to the VBO for the specified target using raw pointers.
+    // With DSA the buffer does not need to be bound, and GL_STATIC_DRAW data gets immutable storage
+    // (glNamedBufferStorage). Uploading static data again updates that storage in place while it fits.
+    // Immutable storage cannot be resized, so larger data or another usage replaces the buffer object:
+    // GetBufferID() changes and every VAO the buffer was attached to must attach it again.
     //
     // Parameters:
-    // - target: The target to which the buffer object is bound.
+    // - target: The target to which the buffer object is bound (ignored with DSA).
     // - size: The size in bytes of the data to be uploaded.
     // - data: A pointer to the data to be uploaded.
     // - usage: The expected usage pattern of the data store (e.g., GL_STATIC_DRAW, GL_DYNAMIC_DRAW, or GL_STREAM_DRAW).
-    inline void UploadData(GLenum target, GLsizeiptr size, const void* data, GLenum usage = GL_STATIC_DRAW) const
-    {
-        glBufferData(target, size, data, usage);
-    }
+    //
+    // Returns:
+    // - true if the buffer object was replaced and GetBufferID() changed.
+    bool UploadData(GLenum target, GLsizeiptr size, const void* data, GLenum usage = GL_STATIC_DRAW);
 
     // Upload data from std::vector
     // Uploads data to the VBO using a std::vector.
@@ -52,9 +57,9 @@ public:
     // - data: The std::vector containing the data to be uploaded.
     // - usage: The expected usage pattern of the data store.
     template <typename T>
-    inline void UploadData(GLenum target, const std::vector<T>& data, GLenum usage = GL_STATIC_DRAW) const
+    inline bool UploadData(GLenum target, const std::vector<T>& data, GLenum usage = GL_STATIC_DRAW)
     {
-        glBufferData(target, data.size() * sizeof(T), data.data(), usage);
+        return UploadData(target, static_cast<GLsizeiptr>(data.size() * sizeof(T)), data.data(), usage);
     }
 
     // Upload data from std::array
@@ -65,9 +70,9 @@ public:
     // - data: The std::array containing the data to be uploaded.
     // - usage: The expected usage pattern of the data store.
     template <typename T, std::size_t N>
-    inline void UploadData(GLenum target, const std::array<T, N>& data, GLenum usage = GL_STATIC_DRAW) const
+    inline bool UploadData(GLenum target, const std::array<T, N>& data, GLenum usage = GL_STATIC_DRAW)
     {
-        glBufferData(target, data.size() * sizeof(T), data.data(), usage);
+        return UploadData(target, static_cast<GLsizeiptr>(data.size() * sizeof(T)), data.data(), usage);
     }
 
     // Get the buffer ID
@@ -78,7 +83,9 @@ public:
     inline const GLuint GetBufferID() const { return BufferID; }
 
 private:
-    GLuint BufferID;  // OpenGL ID for the Vertex Buffer Object (VBO)
+    GLuint BufferID;         // OpenGL ID for the Vertex Buffer Object (VBO)
+    bool Immutable = false;  // Storage was allocated with glNamedBufferStorage
+    GLsizeiptr StorageSize = 0;  // Bytes of the immutable storage
 };
 
 using VBO = VertexBufferObject;
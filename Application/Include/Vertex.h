@@ -1,22 +1,14 @@
 #pragma once
 
+#include <array>
 #include <vector>
+#include <span>
+#include <cstdint>
 #include <cstddef>  // For offsetof
+#include <type_traits>
 #include "GL/glew.h"
 #include "glm/glm.hpp"
 
-#ifdef _MSC_VER
-#include <cstddef>
-#define OFFSET_OF(s, m) offsetof(s, m)
-#elif defined(__clang__) || defined(CLANG)
-#define OFFSET_OF(s, m) (size_t) & reinterpret_cast<const volatile char&>((((s*)0)->m))
-#elif defined(_WIN64)
-#define OFFSET_OF(s, m) (size_t)((ptrdiff_t) & reinterpret_cast<const volatile char&>((((s*)0)->m)))
-#else
-#include <cstddef>
-#define OFFSET_OF(s, m) offsetof(s, m)
-#endif
-
 
 //==============================================================================
 // 1. Template class Vertex
@@ -47,8 +39,63 @@ struct VertexAttrib
     GLsizei stride;        // Total size of the vertex (size of the entire vertex)
     GLsizei offset;         // Offset of this attribute within the structure
     GLboolean normalized;  // Whether the attribute should be normalized
+    GLboolean integer;     // Read as ivec/uvec (glVertexAttribIPointer) instead of being converted to float
+};
+
+// Packed attribute storage, the vertex fetch converts these to float vectors
+struct Half2
+{
+    uint16_t x, y;  // IEEE half floats
 };
 
+struct Half4
+{
+    uint16_t x, y, z, w;  // IEEE half floats
+};
+
+struct Snorm2_10_10_10
+{
+    uint32_t bits;  // GL_INT_2_10_10_10_REV, x in the low bits, see PackSnorm2_10_10_10()
+};
+
+// GL format of a vertex struct member type; add a specialization to use a new member type in layouts
+template <typename MemberType>
+struct VertexAttribFormat;  // Base template not implemented
+
+template <GLint Components, GLenum ComponentType, GLboolean IsNormalized = GL_FALSE, GLboolean IsInteger = GL_FALSE>
+struct VertexAttribFormatOf
+{
+    static constexpr GLint Size = Components;
+    static constexpr GLenum Type = ComponentType;
+    static constexpr GLboolean Normalized = IsNormalized;
+    static constexpr GLboolean Integer = IsInteger;
+};
+
+template <> struct VertexAttribFormat<float> : VertexAttribFormatOf<1, GL_FLOAT> {};
+template <> struct VertexAttribFormat<glm::vec2> : VertexAttribFormatOf<2, GL_FLOAT> {};
+template <> struct VertexAttribFormat<glm::vec3> : VertexAttribFormatOf<3, GL_FLOAT> {};
+template <> struct VertexAttribFormat<glm::vec4> : VertexAttribFormatOf<4, GL_FLOAT> {};
+template <> struct VertexAttribFormat<uint32_t> : VertexAttribFormatOf<1, GL_UNSIGNED_INT, GL_FALSE, GL_TRUE> {};
+template <> struct VertexAttribFormat<Half2> : VertexAttribFormatOf<2, GL_HALF_FLOAT> {};
+template <> struct VertexAttribFormat<Half4> : VertexAttribFormatOf<4, GL_HALF_FLOAT> {};
+// Packed formats always have 4 components, a vec3 shader input simply ignores w
+template <> struct VertexAttribFormat<Snorm2_10_10_10> : VertexAttribFormatOf<4, GL_INT_2_10_10_10_REV, GL_TRUE> {};
+
+template <typename VertexType, typename MemberType>
+constexpr VertexAttrib MakeVertexAttrib(GLuint location, size_t offset)
+{
+    // offsetof is only defined for standard-layout types, the glm members must not break that (e.g. with GLM_FORCE_SWIZZLE)
+    static_assert(std::is_standard_layout_v<VertexType>, "Vertex structures must be standard-layout for offsetof");
+
+    using Format = VertexAttribFormat<MemberType>;
+    return VertexAttrib{ location, Format::Size, Format::Type, static_cast<GLsizei>(sizeof(VertexType)), static_cast<GLsizei>(offset),
+        Format::Normalized, Format::Integer };
+}
+
+// Attribute at shader `location` reading `member` of VertexType; format, offset and stride all come from the struct
+#define VERTEX_ATTRIBUTE(VertexType, location, member) \
+    MakeVertexAttrib<VertexType, decltype(VertexType::member)>(location, offsetof(VertexType, member))
+
 //==============================================================================
 // 3. Declaration of vertex structures
 //==============================================================================
@@ -116,6 +163,19 @@ struct VertexPosNormalTangentUV3D
     glm::vec2 uv;
 };
 
+// Compact VertexPosNormalTangentUV3D: 20 instead of 44 bytes, see PackVertex().
+// The vertex fetch expands every attribute to float, so shaders keep the vec3/vec3/vec3/vec2 inputs.
+// Half-float positions hold about 3 significant digits, enough for model-space meshes up to a few
+// hundred units across.
+struct VertexPackedPosNormalTangentUV3D
+{
+    Half4 pos;                // w = 1, keeps the following attributes 4-byte aligned
+    Snorm2_10_10_10 normal;
+    Snorm2_10_10_10 tangent;  // w is unused and always 1, the float vertex carries no handedness
+    Half2 uv;
+};
+static_assert(sizeof(VertexPackedPosNormalTangentUV3D) == 20, "VertexPackedPosNormalTangentUV3D must be tightly packed");
+
 //==============================================================================
 // 4. Using declarations for easier usage of the Vertex template class
 //==============================================================================
@@ -129,9 +189,14 @@ using Vertex3DNormalUV = Vertex<VertexPosNormalUV3D>;
 using Vertex3DColor = Vertex<VertexPosColor3D>;
 using Vertex3DColorUV = Vertex<VertexPosColorUV3D>;
 using Vertex3DNormalTangentUV = Vertex<VertexPosNormalTangentUV3D>;
+using Vertex3DPackedNormalTangentUV = Vertex<VertexPackedPosNormalTangentUV3D>;
 
 //==============================================================================
-// 5. Template for describing the vertex layout (specializations define GetAttributes)
+// 5. Vertex layouts, evaluated at compile time
+//
+// Each specialization lists the members in shader location order; formats,
+// offsets and the stride are derived from the struct by VERTEX_ATTRIBUTE, so
+// nothing is allocated and nothing can go out of sync with the struct.
 //==============================================================================
 
 template <typename VertexType>
@@ -141,70 +206,126 @@ struct VertexLayout;  // Base template not implemented
 template <>
 struct VertexLayout<VertexPos2D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPos2D, 0, pos)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosUV2D
 template <>
 struct VertexLayout<VertexPosUV2D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosUV2D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosUV2D, 1, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosUV3D
 template <>
 struct VertexLayout<VertexPosUV3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosUV3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosUV3D, 1, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosColorUV
 template <>
 struct VertexLayout<VertexPosColorUV>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosColorUV, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosColorUV, 1, color),
+        VERTEX_ATTRIBUTE(VertexPosColorUV, 2, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPos3D
 template <>
 struct VertexLayout<VertexPos3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPos3D, 0, pos)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosNormal3D
 template <>
 struct VertexLayout<VertexPosNormal3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosNormal3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosNormal3D, 1, normal)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosNormalUV3D
 template <>
 struct VertexLayout<VertexPosNormalUV3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosNormalUV3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosNormalUV3D, 1, normal),
+        VERTEX_ATTRIBUTE(VertexPosNormalUV3D, 2, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosColor3D
 template <>
 struct VertexLayout<VertexPosColor3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosColor3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosColor3D, 1, color)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosColorUV3D
 template <>
 struct VertexLayout<VertexPosColorUV3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosColorUV3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosColorUV3D, 1, color),
+        VERTEX_ATTRIBUTE(VertexPosColorUV3D, 2, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 // Specialization for VertexPosNormalTangentUV3D
 template <>
 struct VertexLayout<VertexPosNormalTangentUV3D>
 {
-    static std::vector<VertexAttrib> GetAttributes();
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPosNormalTangentUV3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPosNormalTangentUV3D, 1, normal),
+        VERTEX_ATTRIBUTE(VertexPosNormalTangentUV3D, 2, tangent),
+        VERTEX_ATTRIBUTE(VertexPosNormalTangentUV3D, 3, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
+};
+
+// Specialization for VertexPackedPosNormalTangentUV3D
+template <>
+struct VertexLayout<VertexPackedPosNormalTangentUV3D>
+{
+    static constexpr std::array Attributes{
+        VERTEX_ATTRIBUTE(VertexPackedPosNormalTangentUV3D, 0, pos),
+        VERTEX_ATTRIBUTE(VertexPackedPosNormalTangentUV3D, 1, normal),
+        VERTEX_ATTRIBUTE(VertexPackedPosNormalTangentUV3D, 2, tangent),
+        VERTEX_ATTRIBUTE(VertexPackedPosNormalTangentUV3D, 3, uv)};
+
+    static constexpr const auto& GetAttributes() { return Attributes; }
 };
 
 //==============================================================================
@@ -220,4 +341,19 @@ extern template class Vertex<VertexPosNormal3D>;
 extern template class Vertex<VertexPosNormalUV3D>;
 extern template class Vertex<VertexPosColor3D>;
 extern template class Vertex<VertexPosColorUV3D>;
-extern template class Vertex<VertexPosNormalTangentUV3D>;
\ No newline at end of file
+extern template class Vertex<VertexPosNormalTangentUV3D>;
+extern template class Vertex<VertexPackedPosNormalTangentUV3D>;
+
+//==============================================================================
+// 7. Conversion between the float and the packed vertex formats
+//==============================================================================
+
+// Packs a vector with components in [-1, 1] into GL_INT_2_10_10_10_REV (x in the low bits)
+uint32_t PackSnorm2_10_10_10(const glm::vec4& value);
+glm::vec4 UnpackSnorm2_10_10_10(uint32_t packed);
+
+VertexPackedPosNormalTangentUV3D PackVertex(const VertexPosNormalTangentUV3D& vertex);
+VertexPosNormalTangentUV3D UnpackVertex(const VertexPackedPosNormalTangentUV3D& vertex);
+
+// Packs a whole mesh, index buffers and LOD chains built from the float vertices stay valid
+std::vector<VertexPackedPosNormalTangentUV3D> PackVertices(std::span<const VertexPosNormalTangentUV3D> vertices);
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <array>
+#include "Vertex.h"
+#include "Platform.h"
+
+/**
+ * @brief Vertex layout as the pulling vertex shader decodes it (std430, must match TestLight.shader).
+ *
+ * Vertex data is addressed in 32-bit words. Attributes[location] describes the
+ * attribute at that shader location, 0 meaning the vertex type has none:
+ *
+ *   bits  0-15  word offset inside the vertex
+ *   bits 16-19  component count
+ *   bits 20-23  component type, one of the PulledAttributeType values
+ */
+struct GPUVertexFormat
+{
+    static constexpr uint32 MaxAttributes = 8;
+
+    uint32 StrideWords = 0;
+    uint32 Padding[3] = {};
+    std::array<uint32, MaxAttributes> Attributes{};
+};
+static_assert(sizeof(GPUVertexFormat) == 48, "GPUVertexFormat must match the std430 layout in TestLight.shader");
+
+enum class PulledAttributeType : uint32
+{
+    Float = 1,           // GL_FLOAT
+    Half = 2,            // GL_HALF_FLOAT, two per word
+    Snorm2_10_10_10 = 3, // GL_INT_2_10_10_10_REV normalized, always 4 components
+    Uint = 4             // GL_UNSIGNED_INT, converted to float like a non-normalized attribute
+};
+
+/**
+ * @brief Builds the pulling format of a vertex type from its VertexLayout at compile time.
+ *
+ * Layouts the shader cannot decode (unaligned members, other component types)
+ * fail to compile instead of rendering garbage.
+ */
+template <typename VertexType>
+consteval GPUVertexFormat MakeGPUVertexFormat()
+{
+    static_assert(sizeof(VertexType) % sizeof(uint32) == 0, "Pulled vertices must be a whole number of 32-bit words");
+
+    GPUVertexFormat format;
+    format.StrideWords = sizeof(VertexType) / sizeof(uint32);
+
+    for (const VertexAttrib& attrib : VertexLayout<VertexType>::Attributes)
+    {
+        if (attrib.index >= GPUVertexFormat::MaxAttributes || attrib.offset % sizeof(uint32) != 0)
+            throw "Vertex pulling needs word aligned attributes at locations below GPUVertexFormat::MaxAttributes";
+
+        PulledAttributeType type;
+        if (attrib.type == GL_FLOAT)
+            type = PulledAttributeType::Float;
+        else if (attrib.type == GL_HALF_FLOAT)
+            type = PulledAttributeType::Half;
+        else if (attrib.type == GL_INT_2_10_10_10_REV && attrib.normalized)
+            type = PulledAttributeType::Snorm2_10_10_10;
+        else if (attrib.type == GL_UNSIGNED_INT && !attrib.normalized)
+            type = PulledAttributeType::Uint;
+        else
+            throw "Vertex attribute type not supported by vertex pulling";
+
+        format.Attributes[attrib.index] = static_cast<uint32>(attrib.offset) / sizeof(uint32)
+            | static_cast<uint32>(attrib.size) << 16
+            | static_cast<uint32>(type) << 20;
+    }
+    return format;
+}
@@ -0,0 +1,101 @@
+#shader compute
+#version 460 core
+
+layout (local_size_x = 64) in;
+
+// Must match CullObject in GPUCulling.h (std430, 48 bytes)
+struct CullObject {
+    vec4 PositionRadius;
+    vec4 AxisSpeed;
+    uint MaterialIndex;
+};
+
+// Must match InstanceData in InstanceData.h (std430, 80 bytes)
+struct InstanceData {
+    mat4 Model;
+    uint MaterialIndex;
+    uint VertexFormat;
+};
+
+layout (std430, binding = 0) writeonly buffer InstanceBuffer {
+    InstanceData Instances[];
+};
+
+layout (std430, binding = 2) readonly buffer CullObjectBuffer {
+    CullObject Objects[];
+};
+
+// Single DrawElementsIndirectCommand, InstanceCount is reset to 0 by the CPU every frame
+layout (std430, binding = 3) buffer CommandBuffer {
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+uniform vec4 FrustumPlanes[6];
+uniform float Time;
+uniform int ObjectCount;
+
+bool SphereInFrustum(vec3 center, float radius)
+{
+    for (int i = 0; i < 6; ++i) {
+        if (dot(FrustumPlanes[i].xyz, center) + FrustumPlanes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// Same matrix as glm::rotate(glm::translate(mat4(1), position), angle, axis)
+mat4 BuildModel(vec3 position, vec3 axis, float angle)
+{
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 t = (1.0 - c) * axis;
+
+    mat4 model;
+    model[0] = vec4(t.x * axis.x + c,          t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y, 0.0);
+    model[1] = vec4(t.y * axis.x - s * axis.z, t.y * axis.y + c,          t.y * axis.z + s * axis.x, 0.0);
+    model[2] = vec4(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, t.z * axis.z + c,          0.0);
+    model[3] = vec4(position, 1.0);
+    return model;
+}
+
+// Survivors are counted per work group first so only one global atomic is issued per group
+shared uint GroupCount;
+shared uint GroupBase;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+
+    if (gl_LocalInvocationIndex == 0u)
+        GroupCount = 0u;
+    barrier();
+
+    bool visible = false;
+    CullObject object;
+    uint localSlot = 0u;
+
+    if (index < uint(ObjectCount)) {
+        object = Objects[index];
+        visible = SphereInFrustum(object.PositionRadius.xyz, object.PositionRadius.w);
+    }
+
+    if (visible)
+        localSlot = atomicAdd(GroupCount, 1u);
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0u)
+        GroupBase = atomicAdd(InstanceCount, GroupCount);
+    barrier();
+
+    if (!visible)
+        return;
+
+    uint slot = GroupBase + localSlot;
+    float angle = radians(Time * object.AxisSpeed.w);
+    Instances[slot].Model = BuildModel(object.PositionRadius.xyz, object.AxisSpeed.xyz, angle);
+    Instances[slot].MaterialIndex = object.MaterialIndex;
+}
@@ -0,0 +1,99 @@
+#shader compute
+#version 460 core
+
+layout (local_size_x = 64) in;
+
+// Must match Meshlet in Meshlet.h (std430, 48 bytes)
+struct Meshlet {
+    vec4 Sphere;
+    vec4 Cone;
+    uint FirstIndex;
+    uint TriangleCount;
+    uint VertexCount;
+    uint Padding;
+};
+
+// Must match DrawElementsIndirectCommand in IndirectBuffer.h
+struct DrawCommand {
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+layout (std430, binding = 6) readonly buffer MeshletBuffer {
+    Meshlet Meshlets[];
+};
+
+layout (std430, binding = 7) writeonly buffer CommandBuffer {
+    DrawCommand Commands[];
+};
+
+// Read by glMultiDrawElementsIndirectCount, reset to 0 by the CPU before every dispatch
+layout (std430, binding = 8) buffer CountBuffer {
+    uint VisibleCount;
+};
+
+// Object space of the mesh, see MeshletCullingPass
+uniform vec4 FrustumPlanes[6];
+uniform vec3 Eye;
+uniform int MeshletCount;
+uniform int BaseInstance;
+
+bool SphereInFrustum(vec3 center, float radius)
+{
+    for (int i = 0; i < 6; ++i) {
+        if (dot(FrustumPlanes[i].xyz, center) + FrustumPlanes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// Every triangle faces away when the eye sees the sphere from inside the back side of the normal cone
+bool ConeBackFacing(vec3 center, float radius, vec4 cone)
+{
+    vec3 toCenter = center - Eye;
+    return dot(toCenter, cone.xyz) >= cone.w * length(toCenter) + radius;
+}
+
+// Survivors are counted per work group first so only one global atomic is issued per group
+shared uint GroupCount;
+shared uint GroupBase;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+
+    if (gl_LocalInvocationIndex == 0u)
+        GroupCount = 0u;
+    barrier();
+
+    bool visible = false;
+    Meshlet meshlet;
+    uint localSlot = 0u;
+
+    if (index < uint(MeshletCount)) {
+        meshlet = Meshlets[index];
+        visible = SphereInFrustum(meshlet.Sphere.xyz, meshlet.Sphere.w) && !ConeBackFacing(meshlet.Sphere.xyz, meshlet.Sphere.w, meshlet.Cone);
+    }
+
+    if (visible)
+        localSlot = atomicAdd(GroupCount, 1u);
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0u)
+        GroupBase = atomicAdd(VisibleCount, GroupCount);
+    barrier();
+
+    if (!visible)
+        return;
+
+    // Commands are appended in no particular order, the depth test does not care
+    uint slot = GroupBase + localSlot;
+    Commands[slot].Count = meshlet.TriangleCount * 3u;
+    Commands[slot].InstanceCount = 1u;
+    Commands[slot].FirstIndex = meshlet.FirstIndex;
+    Commands[slot].BaseVertex = 0;
+    Commands[slot].BaseInstance = uint(BaseInstance);
+}
@@ -6,25 +6,120 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec3 aTangent;   
 layout (location = 3) in vec2 aTexCoord;  
 
+// Per-instance data, must match InstanceData in InstanceData.h (std430, 80 bytes).
+// Indexed by gl_InstanceID for instanced draws and by gl_BaseInstance for indirect draws.
+struct InstanceData {
+    mat4 Model;
+    uint MaterialIndex;
+    uint VertexFormat;
+};
+
+layout (std430, binding = 0) readonly buffer InstanceBuffer {
+    InstanceData Instances[];
+};
+
+// Vertex pulling: raw vertex words of every mesh and their layouts, must match GPUVertexFormat in VertexPulling.h
+struct VertexFormat {
+    uint StrideWords;
+    uint Padding0, Padding1, Padding2;
+    uint Attributes[8]; // Word offset (bits 0-15), component count (16-19), type (20-23), 0 = absent
+};
+
+layout (std430, binding = 4) readonly buffer PulledVertexBuffer {
+    uint VertexWords[];
+};
+
+layout (std430, binding = 5) readonly buffer VertexFormatBuffer {
+    VertexFormat Formats[];
+};
+
+const uint PULLED_FLOAT = 1u;
+const uint PULLED_HALF = 2u;
+const uint PULLED_SNORM_2_10_10_10 = 3u;
+const uint PULLED_UINT = 4u;
+
 out vec2 TexCoord;
 out vec3 Normal;
 out vec3 Tangent;
 out vec3 FragPos;
+flat out uint MaterialIndex;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool UseInstancing;
+uniform bool UseVertexPulling; // Vertices come from VertexWords instead of the attributes, needs UseInstancing
+uniform int DrawMaterialIndex; // Material of the per-draw path
+
+// Decodes the attribute at `location` the way the fixed-function fetch would, (0, 0, 0, 1) if absent
+vec4 PullAttribute(uint format, uint location, uint vertexWord)
+{
+    vec4 value = vec4(0.0, 0.0, 0.0, 1.0);
+    uint attribute = Formats[format].Attributes[location];
+    if (attribute == 0u)
+        return value;
+
+    uint word = vertexWord + (attribute & 0xFFFFu);
+    uint components = (attribute >> 16) & 0xFu;
+    uint type = (attribute >> 20) & 0xFu;
+
+    if (type == PULLED_SNORM_2_10_10_10) {
+        int packed = int(VertexWords[word]);
+        ivec4 fields = ivec4(bitfieldExtract(packed, 0, 10), bitfieldExtract(packed, 10, 10),
+                             bitfieldExtract(packed, 20, 10), bitfieldExtract(packed, 30, 2));
+        return max(vec4(fields) / vec4(511.0, 511.0, 511.0, 1.0), vec4(-1.0));
+    }
+
+    for (uint i = 0u; i < components; ++i) {
+        if (type == PULLED_HALF) {
+            vec2 halves = unpackHalf2x16(VertexWords[word + i / 2u]);
+            value[i] = (i % 2u == 0u) ? halves.x : halves.y;
+        }
+        else if (type == PULLED_UINT) {
+            value[i] = float(VertexWords[word + i]);
+        }
+        else {
+            value[i] = uintBitsToFloat(VertexWords[word + i]);
+        }
+    }
+    return value;
+}
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    mat4 world = model;
+    MaterialIndex = uint(DrawMaterialIndex);
+
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+    vec3 tangent = aTangent;
+    vec2 texCoord = aTexCoord;
+
+    if (UseInstancing) {
+        // gl_BaseInstance is 0 for plain instanced draws and the instance slot for indirect commands
+        uint instance = uint(gl_BaseInstance + gl_InstanceID);
+        world = Instances[instance].Model;
+        MaterialIndex = Instances[instance].MaterialIndex;
+
+        if (UseVertexPulling) {
+            // gl_VertexID already includes the command's baseVertex, counted in vertices of this format
+            uint format = Instances[instance].VertexFormat;
+            uint vertexWord = uint(gl_VertexID) * Formats[format].StrideWords;
+            position = PullAttribute(format, 0u, vertexWord).xyz;
+            normal = PullAttribute(format, 1u, vertexWord).xyz;
+            tangent = PullAttribute(format, 2u, vertexWord).xyz;
+            texCoord = PullAttribute(format, 3u, vertexWord).xy;
+        }
+    }
 
-    TexCoord = aTexCoord;
-    FragPos  = vec3(model * vec4(aPos, 1.0));
+    gl_Position = projection * view * world * vec4(position, 1.0);
 
-    mat3 normalMatrix = mat3(transpose(inverse(model)));
-    Normal  = normalize(normalMatrix * aNormal);
-    Tangent = normalize(normalMatrix * aTangent);
+    TexCoord = texCoord;
+    FragPos  = vec3(world * vec4(position, 1.0));
+
+    mat3 normalMatrix = mat3(transpose(inverse(world)));
+    Normal  = normalize(normalMatrix * normal);
+    Tangent = normalize(normalMatrix * tangent);
 }
 
 #shader pixel
@@ -39,6 +134,18 @@ struct MaterialS {
     float Shininess;
 };
 
+// std430 packed material table, must match GPUMaterial in Material.h
+struct GPUMaterial {
+    vec4 ColorIntensity;
+    vec4 Ambient;
+    vec4 Diffuse;
+    vec4 SpecularShininess;
+};
+
+layout (std430, binding = 1) readonly buffer MaterialBuffer {
+    GPUMaterial Materials[];
+};
+
 struct DirectionalLight {
     vec3 Color;
     float Intensity;
@@ -79,22 +186,38 @@ uniform PointLight PointLights[MAX_POINT_LIGHTS];
 uniform SpotLight SpotLights[MAX_SPOT_LIGHTS];
 
 uniform vec3 ViewPos;
-uniform MaterialS Material;
 
 in vec3 Normal;
 in vec3 FragPos;
+flat in uint MaterialIndex;
 out vec4 FragColor;
 
+// Material of the current fragment, fetched from the material table
+MaterialS ActiveMaterial;
+
+MaterialS FetchMaterial(uint index) {
+    GPUMaterial packed = Materials[index];
+
+    MaterialS material;
+    material.Color     = packed.ColorIntensity.rgb;
+    material.Intensity = packed.ColorIntensity.a;
+    material.Ambient   = packed.Ambient.rgb;
+    material.Diffuse   = packed.Diffuse.rgb;
+    material.Specular  = packed.SpecularShininess.rgb;
+    material.Shininess = packed.SpecularShininess.a;
+    return material;
+}
+
 vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir) {
     vec3 lightDir = normalize(-light.Direction);
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Material.Shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), ActiveMaterial.Shininess);
 
-    vec3 ambient  = light.Color * light.Intensity * Material.Ambient;
-    vec3 diffuse  = light.Color * light.Intensity * diff * Material.Diffuse;
-    vec3 specular = light.Color * light.Intensity * spec * Material.Specular;
+    vec3 ambient  = light.Color * light.Intensity * ActiveMaterial.Ambient;
+    vec3 diffuse  = light.Color * light.Intensity * diff * ActiveMaterial.Diffuse;
+    vec3 specular = light.Color * light.Intensity * spec * ActiveMaterial.Specular;
 
     return ambient + diffuse + specular;
 }
@@ -104,15 +227,15 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Material.Shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), ActiveMaterial.Shininess);
 
     float distance    = length(light.Position - fragPos);
     float attenuation = 1.0 / (light.Constant + light.Linear * distance +
                                light.Quadratic * (distance * distance));
 
-    vec3 ambient  = light.Color * light.Intensity * Material.Ambient;
-    vec3 diffuse  = light.Color * light.Intensity * diff * Material.Diffuse;
-    vec3 specular = light.Color * light.Intensity * spec * Material.Specular;
+    vec3 ambient  = light.Color * light.Intensity * ActiveMaterial.Ambient;
+    vec3 diffuse  = light.Color * light.Intensity * diff * ActiveMaterial.Diffuse;
+    vec3 specular = light.Color * light.Intensity * spec * ActiveMaterial.Specular;
 
     ambient  *= attenuation;
     diffuse  *= attenuation;
@@ -126,7 +249,7 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Material.Shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), ActiveMaterial.Shininess);
 
     float distance    = length(light.Position - fragPos);
     float attenuation = 1.0 / (light.Constant + light.Linear * distance +
@@ -136,9 +259,9 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float epsilon   = light.CutOff - light.OuterCutOff;
     float intensity = clamp((theta - light.OuterCutOff) / epsilon, 0.0, 1.0);
 
-    vec3 ambient  = light.Color * light.Intensity * Material.Ambient;
-    vec3 diffuse  = light.Color * light.Intensity * diff * Material.Diffuse;
-    vec3 specular = light.Color * light.Intensity * spec * Material.Specular;
+    vec3 ambient  = light.Color * light.Intensity * ActiveMaterial.Ambient;
+    vec3 diffuse  = light.Color * light.Intensity * diff * ActiveMaterial.Diffuse;
+    vec3 specular = light.Color * light.Intensity * spec * ActiveMaterial.Specular;
 
     ambient  *= attenuation * intensity;
     diffuse  *= attenuation * intensity;
@@ -149,6 +272,8 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
 
 void main()
 {
+    ActiveMaterial = FetchMaterial(MaterialIndex);
+
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(ViewPos - FragPos);
 
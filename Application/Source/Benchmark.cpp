@@ -0,0 +1,686 @@
+#include "Benchmark.h"
+#include "Cube.h"
+#include "CullingSystem.h"
+#include "LooseOctree.h"
+#include "MeshImporter.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "OcclusionCuller.h"
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+    template <typename T>
+    bool ParseNumber(std::string_view text, T& value)
+    {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    // Nearest-rank percentile of an ascending sorted range
+    double Percentile(const std::vector<double>& sorted, double percent)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    void PrintStatistics(std::ostream& stream, const char* label, std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        const double average = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+
+        stream << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(3)
+            << " avg " << std::setw(8) << average
+            << "  min " << std::setw(8) << values.front()
+            << "  p50 " << std::setw(8) << Percentile(values, 50.0)
+            << "  p95 " << std::setw(8) << Percentile(values, 95.0)
+            << "  p99 " << std::setw(8) << Percentile(values, 99.0)
+            << "  max " << std::setw(8) << values.back() << " ms" << std::endl;
+    }
+}
+
+std::optional<BenchmarkOptions> BenchmarkOptions::Parse(int argc, char** argv)
+{
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string_view value = hasValue ? std::string_view(argv[i + 1]) : std::string_view();
+
+        bool valid = true;
+        if (argument == "--headless")
+        {
+            options.Headless = true;
+            continue;
+        }
+        else if (argument == "--no-sort")
+        {
+            options.SortDraws = false;
+            continue;
+        }
+        else if (argument == "--octree")
+        {
+            options.OctreeCulling = true;
+            continue;
+        }
+        else if (argument == "--no-occlusion")
+        {
+            options.OcclusionCulling = false;
+            continue;
+        }
+        else if (argument == "--cull-bench")
+        {
+            options.CullingBenchmark = true;
+            continue;
+        }
+        else if (argument == "--transform-bench")
+        {
+            options.TransformBenchmark = true;
+            continue;
+        }
+        else if (argument == "--import-bench")
+        {
+            options.ImportBenchmark = true;
+            continue;
+        }
+        else if (argument == "--frames")
+            valid = hasValue && ParseNumber(value, options.Frames) && options.Frames > 0;
+        else if (argument == "--cubes")
+            valid = hasValue && ParseNumber(value, options.Cubes) && options.Cubes > 0;
+        else if (argument == "--point-lights")
+            valid = hasValue && ParseNumber(value, options.PointLights) && options.PointLights >= 0 && options.PointLights <= MaxPointLights;
+        else if (argument == "--spot-lights")
+            valid = hasValue && ParseNumber(value, options.SpotLights) && options.SpotLights >= 0 && options.SpotLights <= MaxSpotLights;
+        else if (argument == "--width")
+            valid = hasValue && ParseNumber(value, options.Width) && options.Width > 0;
+        else if (argument == "--height")
+            valid = hasValue && ParseNumber(value, options.Height) && options.Height > 0;
+        else if (argument == "--mode")
+        {
+            valid = hasValue;
+            options.Mode = value;
+        }
+        else if (argument == "--import")
+        {
+            valid = hasValue;
+            options.ImportPath = value;
+        }
+        else
+        {
+            std::cerr << "ERROR::BENCHMARK::UNKNOWN_ARGUMENT " << argument << std::endl;
+            PrintUsage(std::cerr, argv[0]);
+            return std::nullopt;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "ERROR::BENCHMARK::INVALID_VALUE " << argument << " " << value << std::endl;
+            PrintUsage(std::cerr, argv[0]);
+            return std::nullopt;
+        }
+        ++i;
+    }
+
+    return options;
+}
+
+void BenchmarkOptions::PrintUsage(std::ostream& stream, const char* program)
+{
+    stream << "Usage: " << program << " [options]\n"
+        << "  --headless            Render offscreen and print per-frame timings\n"
+        << "  --frames <n>          Frames rendered in headless mode (default 1000)\n"
+        << "  --cubes <n>           Number of cubes (default 10000)\n"
+        << "  --point-lights <n>    Point lights, 0-" << MaxPointLights << " (default 10)\n"
+        << "  --spot-lights <n>     Spot lights, 0-" << MaxSpotLights << " (default 10)\n"
+        << "  --width <px>          Offscreen width (default 1920)\n"
+        << "  --height <px>         Offscreen height (default 1080)\n"
+        << "  --mode <name>         per-draw, instanced, mdi, pull, gpu or meshlet (default instanced)\n"
+        << "                        (I only cycles through pull and meshlet when the run started in that mode)\n"
+        << "  --no-sort             Do not sort draws by sort key\n"
+        << "  --octree              Cull with the loose octree instead of the flat scan\n"
+        << "  --no-occlusion        Skip occlusion culling against the CPU depth buffer\n"
+        << "  --cull-bench          Check occlusion culling, compare octree and flat culling at 10k, 100k and 1M objects\n"
+        << "                        and time CPU meshlet culling, then exit\n"
+        << "  --transform-bench     Compare incremental and full transform hierarchy updates, then exit\n"
+        << "  --import-bench        Check normals of a generated OBJ imported over several weld slices,\n"
+        << "                        report vertex cache optimizer results, then exit\n"
+        << "  --import <file>       Import a .gltf, .glb or .obj file and register its meshes" << std::endl;
+}
+
+CameraPath::CameraPath(float worldSize, uint32 frameCount)
+    : WorldSize(worldSize)
+    , FrameCount(std::max<uint32>(frameCount, 1))
+{
+}
+
+CameraPath::Sample CameraPath::Evaluate(uint32 frame) const
+{
+    constexpr float TwoPi = 6.28318530718f;
+    const float t = static_cast<float>(frame) / static_cast<float>(FrameCount);
+    const float angle = t * TwoPi;
+
+    // Dive from the edge of the cube field towards its center and back out, twice per orbit
+    const float radius = WorldSize * (0.55f + 0.35f * std::cos(2.0f * angle));
+    const float height = WorldSize * 0.25f * std::sin(3.0f * angle);
+
+    Sample sample;
+    sample.Position = glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+
+    // Look slightly ahead along the orbit instead of at the center, so the view sweeps across the field
+    const float lookAngle = angle + 0.6f;
+    sample.Target = glm::vec3(0.3f * radius * std::cos(lookAngle), 0.0f, 0.3f * radius * std::sin(lookAngle));
+    return sample;
+}
+
+void FrameTimings::PrintFrames(std::ostream& stream) const
+{
+    stream << "frame,cpu_ms,total_ms,visible,occluded,jobs,steals,worker_utilization\n";
+    stream << std::fixed << std::setprecision(4);
+    for (size_t i = 0; i < Frames.size(); ++i)
+    {
+        stream << i << ',' << Frames[i].CpuMs << ',' << Frames[i].TotalMs << ',' << Frames[i].Visible
+            << ',' << Frames[i].Occluded << ',' << Frames[i].Jobs << ',' << Frames[i].Steals << ',' << Frames[i].WorkerUtilization << '\n';
+    }
+    stream << std::defaultfloat << std::flush;
+}
+
+void FrameTimings::PrintSummary(std::ostream& stream) const
+{
+    if (Frames.empty())
+    {
+        stream << "No frames recorded" << std::endl;
+        return;
+    }
+
+    std::vector<double> cpu(Frames.size());
+    std::vector<double> total(Frames.size());
+    size_t visible = 0;
+    size_t occluded = 0;
+    size_t jobs = 0;
+    size_t steals = 0;
+    double utilization = 0.0;
+    for (size_t i = 0; i < Frames.size(); ++i)
+    {
+        cpu[i] = Frames[i].CpuMs;
+        total[i] = Frames[i].TotalMs;
+        visible += Frames[i].Visible;
+        occluded += Frames[i].Occluded;
+        jobs += Frames[i].Jobs;
+        steals += Frames[i].Steals;
+        utilization += Frames[i].WorkerUtilization;
+    }
+
+    const double totalMs = std::accumulate(total.begin(), total.end(), 0.0);
+
+    stream << "Frames: " << Frames.size()
+        << ", average visible: " << visible / Frames.size()
+        << ", average occluded: " << occluded / Frames.size()
+        << ", average FPS: " << std::fixed << std::setprecision(1) << 1000.0 * static_cast<double>(Frames.size()) / totalMs
+        << std::defaultfloat << std::endl;
+    PrintStatistics(stream, "CPU", std::move(cpu));
+    PrintStatistics(stream, "Frame", std::move(total));
+    stream << "Jobs per frame: " << jobs / Frames.size()
+        << ", steals per frame: " << steals / Frames.size()
+        << ", worker utilization: " << std::fixed << std::setprecision(1)
+        << 100.0 * utilization / static_cast<double>(Frames.size()) << "%" << std::endl;
+    stream << std::defaultfloat;
+}
+
+bool RunOcclusionCheck(std::ostream& stream, const glm::mat4& projection)
+{
+    struct Case
+    {
+        const char* Name;
+        glm::vec3 Center;
+        float Radius;
+        bool ExpectOccluded;
+    };
+
+    // The camera sits at the origin looking down -z, a 2x2x1 box at z = -10 is the occluder
+    const Case cases[] = {
+        { "behind", glm::vec3(0.0f, 0.0f, -30.0f), 1.0f, true },
+        { "beside", glm::vec3(3.0f, 0.0f, -30.0f), 1.0f, false },
+        { "in front", glm::vec3(0.0f, 0.0f, -7.0f), 0.5f, false },
+    };
+
+    const glm::mat4 view(1.0f);
+    const glm::vec3 boxCenter(0.0f, 0.0f, -10.0f);
+    const glm::vec3 boxSize(2.0f, 2.0f, 1.0f);
+
+    // Id 0 is the box, id 1 the sphere under test; both are candidates and so both may become occluders
+    std::vector<glm::vec4> spheres(2);
+    std::vector<glm::mat4> models(2);
+    spheres[0] = glm::vec4(boxCenter, glm::length(boxSize) * 0.5f);
+    models[0] = glm::scale(glm::translate(glm::mat4(1.0f), boxCenter), boxSize);
+    const uint32 candidates[] = { 0, 1 };
+
+    OcclusionCuller culler;
+    for (const Case& test : cases)
+    {
+        // Cube inscribed in the sphere
+        spheres[1] = glm::vec4(test.Center, test.Radius);
+        models[1] = glm::scale(glm::translate(glm::mat4(1.0f), test.Center), glm::vec3(test.Radius * 2.0f / std::sqrt(3.0f)));
+
+        culler.Cull(view, projection, candidates, spheres, models);
+        const std::span<const uint32> visible = culler.GetVisible();
+        const bool boxOccluded = std::find(visible.begin(), visible.end(), 0u) == visible.end();
+        const bool occluded = std::find(visible.begin(), visible.end(), 1u) == visible.end();
+        if (boxOccluded || occluded != test.ExpectOccluded) [[unlikely]]
+        {
+            std::cerr << "ERROR::OCCLUSION_CHECK::WRONG_RESULT sphere " << test.Name << ": the sphere was "
+                << (occluded ? "occluded" : "kept") << ", expected " << (test.ExpectOccluded ? "occluded" : "kept")
+                << (boxOccluded ? ", the occluder itself was occluded" : "") << std::endl;
+            return false;
+        }
+    }
+
+    stream << "Occlusion check: " << std::size(cases) << " cases passed" << std::endl;
+    return true;
+}
+
+bool RunCullingBenchmark(std::ostream& stream, float worldSize, float objectRadius, const glm::mat4& projection, uint32 frameCount)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    constexpr size_t ObjectCounts[] = { 10'000, 100'000, 1'000'000 };
+    const CameraPath cameraPath(worldSize, frameCount);
+
+    stream << "Culling benchmark: " << frameCount << " frames, times are per frame in ms\n"
+        << std::setw(9) << "objects" << std::setw(10) << "visible"
+        << std::setw(12) << "flat 1T" << std::setw(12) << "flat jobs" << std::setw(12) << "octree"
+        << std::setw(10) << "nodes" << std::setw(10) << "tested" << std::setw(12) << "move 1%"
+        << std::setw(12) << "build" << std::endl;
+
+    for (const size_t objectCount : ObjectCounts)
+    {
+        std::mt19937 rng(0x5EED);
+        std::uniform_real_distribution<float> position(-worldSize, worldSize);
+        std::uniform_real_distribution<float> jitter(-1.0f, 1.0f);
+
+        std::vector<glm::vec3> centers(objectCount);
+        for (glm::vec3& center : centers)
+        {
+            center = glm::vec3(position(rng), position(rng), position(rng));
+        }
+
+        CullingSystem flat;
+        flat.Reserve(objectCount);
+        for (const glm::vec3& center : centers)
+        {
+            flat.Add(center, objectRadius);
+        }
+
+        const Clock::time_point buildStart = Clock::now();
+        LooseOctree octree(glm::vec3(0.0f), worldSize);
+        octree.Reserve(objectCount);
+        for (size_t i = 0; i < objectCount; ++i)
+        {
+            octree.Insert(static_cast<uint32>(i), centers[i], objectRadius);
+        }
+        const Milliseconds buildTime = Clock::now() - buildStart;
+
+        std::vector<uint32> singleThreadVisible(objectCount);
+        std::vector<uint32> octreeVisible;
+        octreeVisible.reserve(objectCount);
+        std::vector<uint32> sortedOctreeVisible;
+        sortedOctreeVisible.reserve(objectCount);
+
+        const size_t movesPerFrame = std::max<size_t>(objectCount / 100, 1);
+        size_t nextMoved = 0;
+
+        Milliseconds flatTime{}, flatJobsTime{}, octreeTime{}, moveTime{};
+        uint64 visible = 0, nodesVisited = 0, objectsTested = 0;
+        for (uint32 frame = 0; frame < frameCount; ++frame)
+        {
+            const CameraPath::Sample sample = cameraPath.Evaluate(frame);
+            const Frustum frustum = Frustum::FromMatrix(projection * glm::lookAt(sample.Position, sample.Target, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+            Clock::time_point start = Clock::now();
+            const size_t flatVisible = flat.CullRange(frustum, 0, objectCount, singleThreadVisible.data());
+            flatTime += Clock::now() - start;
+            visible += flatVisible;
+
+            start = Clock::now();
+            flat.Cull(frustum);
+            flatJobsTime += Clock::now() - start;
+
+            start = Clock::now();
+            const LooseOctree::QueryStats stats = octree.Query(frustum, octreeVisible);
+            octreeTime += Clock::now() - start;
+            nodesVisited += stats.NodesVisited;
+            objectsTested += stats.ObjectsTested;
+
+            // All three paths see the same spheres, the octree returns them grouped by node
+            const std::span<const uint32> expected(singleThreadVisible.data(), flatVisible);
+            sortedOctreeVisible.assign(octreeVisible.begin(), octreeVisible.end());
+            std::sort(sortedOctreeVisible.begin(), sortedOctreeVisible.end());
+            if (!std::ranges::equal(flat.GetVisible(), expected) || !std::ranges::equal(sortedOctreeVisible, expected)) [[unlikely]]
+            {
+                std::cerr << "ERROR::CULLING_BENCHMARK::RESULT_MISMATCH " << objectCount << " objects, frame " << frame
+                    << ": flat " << flatVisible << ", flat jobs " << flat.GetVisible().size() << ", octree " << octreeVisible.size() << std::endl;
+                return false;
+            }
+
+            // Small random steps, most of them stay in their node
+            start = Clock::now();
+            for (size_t i = 0; i < movesPerFrame; ++i)
+            {
+                const uint32 id = static_cast<uint32>(nextMoved);
+                nextMoved = (nextMoved + 1) % objectCount;
+                centers[id] = centers[id] + glm::vec3(jitter(rng), jitter(rng), jitter(rng));
+                flat.Set(id, centers[id], objectRadius);
+                octree.Move(id, centers[id], objectRadius);
+            }
+            moveTime += Clock::now() - start;
+        }
+
+        const double frames = static_cast<double>(frameCount);
+        stream << std::setw(9) << objectCount << std::setw(10) << visible / frameCount
+            << std::fixed << std::setprecision(3)
+            << std::setw(12) << flatTime.count() / frames
+            << std::setw(12) << flatJobsTime.count() / frames
+            << std::setw(12) << octreeTime.count() / frames
+            << std::setw(10) << nodesVisited / frameCount
+            << std::setw(10) << objectsTested / frameCount
+            << std::setw(12) << moveTime.count() / frames
+            << std::setw(12) << buildTime.count()
+            << std::defaultfloat << std::endl;
+    }
+    return true;
+}
+
+TerrainGrid TerrainGrid::Generate(float worldSize, uint32 tilesPerSide)
+{
+    const uint32 gridSize = tilesPerSide * TileQuads;
+    const uint32 rowLength = gridSize + 1;
+
+    // y = 2 sin(x / 10) cos(z / 10), the normal and tangent follow from its partial derivatives
+    TerrainGrid terrain;
+    terrain.Vertices.resize(static_cast<size_t>(rowLength) * rowLength);
+    for (uint32 z = 0; z < rowLength; ++z)
+    {
+        for (uint32 x = 0; x < rowLength; ++x)
+        {
+            const glm::vec2 uv(static_cast<float>(x) / static_cast<float>(gridSize), static_cast<float>(z) / static_cast<float>(gridSize));
+            const float px = worldSize * (2.0f * uv.x - 1.0f);
+            const float pz = worldSize * (2.0f * uv.y - 1.0f);
+            const float slopeX = 0.2f * std::cos(px * 0.1f) * std::cos(pz * 0.1f);
+            const float slopeZ = -0.2f * std::sin(px * 0.1f) * std::sin(pz * 0.1f);
+
+            VertexPosNormalTangentUV3D& vertex = terrain.Vertices[static_cast<size_t>(z) * rowLength + x];
+            vertex.pos = glm::vec3(px, 2.0f * std::sin(px * 0.1f) * std::cos(pz * 0.1f), pz);
+            vertex.normal = glm::normalize(glm::vec3(-slopeX, 1.0f, -slopeZ));
+            vertex.tangent = glm::normalize(glm::vec3(1.0f, slopeX, 0.0f));
+            vertex.uv = uv;
+        }
+    }
+
+    terrain.Indices.reserve(static_cast<size_t>(gridSize) * gridSize * 6);
+    for (uint32 tileZ = 0; tileZ < gridSize; tileZ += TileQuads)
+    {
+        for (uint32 tileX = 0; tileX < gridSize; tileX += TileQuads)
+        {
+            for (uint32 z = tileZ; z < tileZ + TileQuads; ++z)
+            {
+                for (uint32 x = tileX; x < tileX + TileQuads; ++x)
+                {
+                    // Counter-clockwise seen from above
+                    const uint32 corner = z * rowLength + x;
+                    terrain.Indices.insert(terrain.Indices.end(),
+                        { corner, corner + rowLength, corner + 1, corner + 1, corner + rowLength, corner + rowLength + 1 });
+                }
+            }
+        }
+    }
+    return terrain;
+}
+
+void RunMeshletBenchmark(std::ostream& stream, float worldSize, const glm::mat4& projection, uint32 frameCount)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    // Every tile becomes one meshlet, about 130k and 2M triangles
+    constexpr uint32 TilesPerSide[] = { 37, 147 };
+    const CameraPath cameraPath(worldSize, frameCount);
+
+    stream << "Meshlet benchmark: " << frameCount << " frames, times are per frame in ms\n"
+        << std::setw(10) << "triangles" << std::setw(10) << "meshlets" << std::setw(10) << "visible"
+        << std::setw(12) << "cull" << std::setw(12) << "build" << std::endl;
+
+    for (const uint32 tilesPerSide : TilesPerSide)
+    {
+        const TerrainGrid terrain = TerrainGrid::Generate(worldSize, tilesPerSide);
+        const std::vector<uint32>& indices = terrain.Indices;
+        std::vector<glm::vec3> positions(terrain.Vertices.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            positions[i] = terrain.Vertices[i].pos;
+        }
+
+        const Clock::time_point buildStart = Clock::now();
+        const MeshletBuilder::Result meshlets = MeshletBuilder::Build(indices, positions);
+        MeshletCuller culler;
+        culler.Upload(meshlets.Meshlets);
+        const Milliseconds buildTime = Clock::now() - buildStart;
+
+        Milliseconds cullTime{};
+        uint64 visible = 0;
+        for (uint32 frame = 0; frame < frameCount; ++frame)
+        {
+            const CameraPath::Sample sample = cameraPath.Evaluate(frame);
+            const Frustum frustum = Frustum::FromMatrix(projection * glm::lookAt(sample.Position, sample.Target, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+            const Clock::time_point start = Clock::now();
+            visible += culler.Cull(frustum, sample.Position);
+            cullTime += Clock::now() - start;
+        }
+
+        const double frames = static_cast<double>(frameCount);
+        stream << std::setw(10) << indices.size() / 3 << std::setw(10) << culler.GetCount() << std::setw(10) << visible / frameCount
+            << std::fixed << std::setprecision(3)
+            << std::setw(12) << cullTime.count() / frames
+            << std::setw(12) << buildTime.count()
+            << std::defaultfloat << std::endl;
+    }
+}
+
+void RunTransformBenchmark(std::ostream& stream, uint32 frameCount)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    // A model is a root with 3 parts of 3 sub-parts each, like a body with limbs
+    constexpr size_t PartsPerNode = 3;
+    constexpr size_t NodesPerModel = 1 + PartsPerNode + PartsPerNode * PartsPerNode;
+    constexpr size_t NodeCounts[] = { 10'000, 100'000, 1'000'000 };
+
+    stream << "Transform benchmark: " << frameCount << " frames, " << NodesPerModel << " nodes per model, times are per frame in ms\n"
+        << std::setw(9) << "nodes" << std::setw(12) << "full" << std::setw(12) << "move 1%"
+        << std::setw(10) << "updated" << std::setw(12) << "static" << std::endl;
+
+    for (const size_t nodeCount : NodeCounts)
+    {
+        std::mt19937 rng(0x5EED);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+        const size_t modelCount = nodeCount / NodesPerModel;
+        TransformHierarchy hierarchy;
+        hierarchy.Reserve(modelCount * NodesPerModel);
+
+        std::vector<uint32> roots(modelCount);
+        for (uint32& root : roots)
+        {
+            root = hierarchy.Add({ glm::vec3(position(rng), position(rng), position(rng)) });
+            for (size_t part = 0; part < PartsPerNode; ++part)
+            {
+                const uint32 partIndex = hierarchy.Add({ glm::vec3(offset(rng), offset(rng), offset(rng)) }, root);
+                for (size_t subPart = 0; subPart < PartsPerNode; ++subPart)
+                {
+                    hierarchy.Add({ glm::vec3(offset(rng), offset(rng), offset(rng)) }, partIndex);
+                }
+            }
+        }
+        hierarchy.Update();
+
+        const size_t movesPerFrame = std::max<size_t>(modelCount / 100, 1);
+        size_t nextMoved = 0;
+
+        Milliseconds fullTime{}, incrementalTime{}, staticTime{};
+        uint64 updated = 0;
+        for (uint32 frame = 0; frame < frameCount; ++frame)
+        {
+            Clock::time_point start = Clock::now();
+            hierarchy.UpdateAll();
+            fullTime += Clock::now() - start;
+
+            // Moved models are spread over the whole array, like objects picked by gameplay
+            for (size_t i = 0; i < movesPerFrame; ++i)
+            {
+                const uint32 root = roots[nextMoved];
+                nextMoved = (nextMoved + 97) % modelCount;
+                hierarchy.SetPosition(root, hierarchy.GetLocal(root).Position + glm::vec3(offset(rng), offset(rng), offset(rng)));
+            }
+
+            start = Clock::now();
+            updated += hierarchy.Update();
+            incrementalTime += Clock::now() - start;
+
+            start = Clock::now();
+            updated += hierarchy.Update();
+            staticTime += Clock::now() - start;
+        }
+
+        const double frames = static_cast<double>(frameCount);
+        stream << std::setw(9) << hierarchy.GetCount()
+            << std::fixed << std::setprecision(3)
+            << std::setw(12) << fullTime.count() / frames
+            << std::setw(12) << incrementalTime.count() / frames
+            << std::setw(10) << updated / frameCount
+            << std::setw(12) << staticTime.count() / frames
+            << std::defaultfloat << std::endl;
+    }
+}
+
+bool RunImportCheck(std::ostream& stream)
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    // 80k triangles in row order, more than one weld slice, so rows in the middle are shared by two slices
+    constexpr uint32 GridQuads = 200;
+    constexpr uint32 RowLength = GridQuads + 1;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "LearningOpenGL_ImportCheck.obj";
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cerr << "ERROR::IMPORT_CHECK::FILE_NOT_WRITTEN " << path.string() << std::endl;
+            return false;
+        }
+
+        // Positions and texture coordinates share their indices; y = 2 sin(0.3 x) cos(0.2 z) keeps the normals varying
+        file << std::setprecision(9);
+        for (uint32 z = 0; z < RowLength; ++z)
+        {
+            for (uint32 x = 0; x < RowLength; ++x)
+            {
+                const float px = static_cast<float>(x);
+                const float pz = static_cast<float>(z);
+                file << "v " << px << ' ' << 2.0f * std::sin(px * 0.3f) * std::cos(pz * 0.2f) << ' ' << pz << '\n';
+            }
+        }
+        for (uint32 z = 0; z < RowLength; ++z)
+        {
+            for (uint32 x = 0; x < RowLength; ++x)
+            {
+                file << "vt " << static_cast<float>(x) / GridQuads << ' ' << static_cast<float>(z) / GridQuads << '\n';
+            }
+        }
+        for (uint32 z = 0; z < GridQuads; ++z)
+        {
+            for (uint32 x = 0; x < GridQuads; ++x)
+            {
+                // OBJ indices are 1-based, counter-clockwise seen from above
+                const uint32 corner = z * RowLength + x + 1;
+                const uint32 quad[] = { corner, corner + RowLength, corner + RowLength + 1, corner + 1 };
+                file << 'f';
+                for (const uint32 index : quad)
+                {
+                    file << ' ' << index << '/' << index;
+                }
+                file << '\n';
+            }
+        }
+    }
+
+    const Clock::time_point start = Clock::now();
+    const std::vector<ImportedMesh<VertexPosNormalTangentUV3D>> meshes = MeshImporter::Import<VertexPosNormalTangentUV3D>(path);
+    const Milliseconds importTime = Clock::now() - start;
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    if (meshes.size() != 1)
+    {
+        std::cerr << "ERROR::IMPORT_CHECK::WRONG_MESH_COUNT " << meshes.size() << std::endl;
+        return false;
+    }
+
+    // Every grid point has one position and one texture coordinate, so the coordinate identifies the point
+    const std::vector<VertexPosNormalTangentUV3D>& vertices = meshes.front().Vertices;
+    std::vector<int64> firstVertex(static_cast<size_t>(RowLength) * RowLength, -1);
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        const VertexPosNormalTangentUV3D& vertex = vertices[v];
+        const glm::uvec2 grid(glm::round(vertex.uv * static_cast<float>(GridQuads)));
+        int64& first = firstVertex[static_cast<size_t>(grid.y) * RowLength + grid.x];
+        if (first < 0)
+        {
+            first = static_cast<int64>(v);
+            continue;
+        }
+
+        const VertexPosNormalTangentUV3D& other = vertices[static_cast<size_t>(first)];
+        if (vertex.pos != other.pos || glm::length(vertex.normal - other.normal) > 1e-5f || glm::length(vertex.tangent - other.tangent) > 1e-5f)
+        {
+            std::cerr << "ERROR::IMPORT_CHECK::SPLIT_VERTEX grid point " << grid.x << ", " << grid.y
+                << " normal (" << vertex.normal.x << ", " << vertex.normal.y << ", " << vertex.normal.z << ") vs ("
+                << other.normal.x << ", " << other.normal.y << ", " << other.normal.z << ")" << std::endl;
+            return false;
+        }
+        std::cerr << "ERROR::IMPORT_CHECK::DUPLICATED_VERTEX grid point " << grid.x << ", " << grid.y << std::endl;
+        return false;
+    }
+
+    stream << "Import check: " << meshes.front().Indices.size() / 3 << " triangles, " << vertices.size() << " vertices welded in "
+        << std::fixed << std::setprecision(3) << importTime.count() << " ms" << std::defaultfloat << std::endl;
+    return true;
+}
+
+void RunMeshOptimizerReport(std::ostream& stream, float worldSize)
+{
+    const MeshOptimizer::Result<VertexPosNormalTangentUV3D> cube = MeshOptimizer::Optimize<VertexPosNormalTangentUV3D>(
+        Cube::GetMeshVertices(), Cube::GetMeshIndices());
+    MeshOptimizer::PrintStats(stream, "Cube", cube.Before, cube.After);
+
+    const TerrainGrid terrain = TerrainGrid::Generate(worldSize, 37);
+    const MeshOptimizer::Result<VertexPosNormalTangentUV3D> grid = MeshOptimizer::Optimize<VertexPosNormalTangentUV3D>(
+        terrain.Vertices, terrain.Indices);
+    MeshOptimizer::PrintStats(stream, "Terrain", grid.Before, grid.After);
+}
@@ -128,6 +128,21 @@ void Camera::processMouseMovement(float xpos, float ypos)
 	updateCameraVectors();
 }
 
+void Camera::lookAt(const glm::vec3& target)
+{
+	const glm::vec3 direction = target - position;
+	if (glm::length(direction) < 0.0001f)
+		return;
+
+	const glm::vec3 dir = glm::normalize(direction);
+	yaw = glm::degrees(atan2(dir.z, dir.x));
+	pitch = glm::degrees(asin(glm::clamp(dir.y, -1.0f, 1.0f)));
+	if (constrainPitch)
+		pitch = glm::clamp(pitch, -89.0f, 89.0f);
+
+	updateCameraVectors();
+}
+
 void Camera::processMouseScroll(float yoffset)
 {
 	// Use scroll for changing focal length (zoom)
@@ -0,0 +1,163 @@
+#include "CullingSystem.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    static_assert(CullingSystem::TaskGrainSize % CullingSystem::BatchWidth == 0, "Tasks must cover whole batches");
+
+    struct SphereArrays
+    {
+        const float* CenterX;
+        const float* CenterY;
+        const float* CenterZ;
+        const float* Radius;
+    };
+
+    // A sphere is outside when it lies entirely behind any plane: dot(n, c) + d < -r
+    template <typename V>
+    size_t CullSpheres(const SphereArrays& arrays, const Frustum& frustum, size_t begin, size_t end, uint32* visible)
+    {
+        using Float = typename V::Float;
+
+        // Planes are broadcast once per range, one register per component
+        Float planeX[Frustum::Count], planeY[Frustum::Count], planeZ[Frustum::Count], planeW[Frustum::Count];
+        for (int p = 0; p < Frustum::Count; ++p)
+        {
+            planeX[p] = V::Set(frustum.Planes[p].x);
+            planeY[p] = V::Set(frustum.Planes[p].y);
+            planeZ[p] = V::Set(frustum.Planes[p].z);
+            planeW[p] = V::Set(frustum.Planes[p].w);
+        }
+
+        const Float zero = V::Set(0.0f);
+        size_t visibleCount = 0;
+        for (size_t i = begin; i < end; i += V::Width)
+        {
+            const Float x = V::Load(arrays.CenterX + i);
+            const Float y = V::Load(arrays.CenterY + i);
+            const Float z = V::Load(arrays.CenterZ + i);
+            const Float radius = V::Load(arrays.Radius + i);
+
+            const auto inFront = [&](int p) {
+                const Float distance = V::Add(V::Add(V::Mul(planeX[p], x), V::Mul(planeY[p], y)), V::Add(V::Mul(planeZ[p], z), planeW[p]));
+                return V::GreaterEqual(V::Add(distance, radius), zero);
+            };
+
+            Float inside = inFront(0);
+            for (int p = 1; p < Frustum::Count; ++p)
+            {
+                inside = V::And(inside, inFront(p));
+            }
+
+            // Lanes past the end of the range belong to the next range or to the padding
+            uint32 mask = V::MoveMask(inside);
+            if (end - i < V::Width)
+            {
+                mask &= (1u << (end - i)) - 1u;
+            }
+
+            // Append the set lanes in order
+            while (mask != 0)
+            {
+                visible[visibleCount++] = static_cast<uint32>(i + std::countr_zero(mask));
+                mask &= mask - 1u;
+            }
+        }
+        return visibleCount;
+    }
+
+    constexpr size_t RoundUpToBatch(size_t count)
+    {
+        return (count + CullingSystem::BatchWidth - 1) / CullingSystem::BatchWidth * CullingSystem::BatchWidth;
+    }
+}
+
+void CullingSystem::Reserve(size_t count)
+{
+    const size_t padded = RoundUpToBatch(count);
+    for (AlignedVector<float>* array : { &CenterX, &CenterY, &CenterZ, &Radius })
+    {
+        array->reserve(padded);
+    }
+    Visible.reserve(count);
+}
+
+uint32 CullingSystem::Add(const glm::vec3& center, float radius)
+{
+    const size_t index = Count++;
+    const size_t padded = RoundUpToBatch(Count);
+
+    // Padding lanes are masked off in CullSpheres, their values only have to be finite
+    CenterX.resize(padded, 0.0f);
+    CenterY.resize(padded, 0.0f);
+    CenterZ.resize(padded, 0.0f);
+    Radius.resize(padded, 0.0f);
+
+    CenterX[index] = center.x;
+    CenterY[index] = center.y;
+    CenterZ[index] = center.z;
+    Radius[index] = radius;
+
+    return static_cast<uint32>(index);
+}
+
+void CullingSystem::Set(uint32 index, const glm::vec3& center, float radius)
+{
+    CenterX[index] = center.x;
+    CenterY[index] = center.y;
+    CenterZ[index] = center.z;
+    Radius[index] = radius;
+}
+
+void CullingSystem::Clear()
+{
+    Count = 0;
+    VisibleCount = 0;
+    for (AlignedVector<float>* array : { &CenterX, &CenterY, &CenterZ, &Radius })
+    {
+        array->clear();
+    }
+    Visible.clear();
+    ChunkVisible.clear();
+}
+
+size_t CullingSystem::Cull(const Frustum& frustum)
+{
+    const size_t chunkCount = (Count + TaskGrainSize - 1) / TaskGrainSize;
+    Visible.resize(Count);
+    ChunkVisible.assign(chunkCount, 0);
+
+    // Every chunk writes its survivors at its own offset, so jobs never share output
+    JobSystem::GetInstance().ParallelFor(chunkCount, 1, [this, &frustum](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; ++chunk)
+        {
+            const size_t begin = chunk * TaskGrainSize;
+            const size_t end = std::min(begin + TaskGrainSize, Count);
+            ChunkVisible[chunk] = CullRange(frustum, begin, end, Visible.data() + begin);
+        }
+    });
+
+    // Compaction: slide each chunk's survivors down behind the previous ones
+    VisibleCount = 0;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        // The destination never lies inside the source range, so a forward copy is safe
+        const auto source = Visible.begin() + static_cast<ptrdiff_t>(chunk * TaskGrainSize);
+        const auto destination = Visible.begin() + static_cast<ptrdiff_t>(VisibleCount);
+        if (source != destination)
+        {
+            std::copy(source, source + static_cast<ptrdiff_t>(ChunkVisible[chunk]), destination);
+        }
+        VisibleCount += ChunkVisible[chunk];
+    }
+
+    return VisibleCount;
+}
+
+size_t CullingSystem::CullRange(const Frustum& frustum, size_t begin, size_t end, uint32* visible) const
+{
+    const SphereArrays arrays{ CenterX.data(), CenterY.data(), CenterZ.data(), Radius.data() };
+    return CullSpheres<Simd::Native>(arrays, frustum, begin, std::min(end, Count), visible);
+}
@@ -1,21 +1,66 @@
 #include "EBO.h"
+#include "GLState.h"
 
 ElementBufferObject::ElementBufferObject()
 {
+#if USE_DSA
+    glCreateBuffers(1, &BufferID);
+#else
     glGenBuffers(1, &BufferID);
+#endif
 }
 
 ElementBufferObject::~ElementBufferObject()
 {
+    GLStateCache::GetInstance().OnBufferDeleted(BufferID);
     glDeleteBuffers(1, &BufferID);
 }
 
 void ElementBufferObject::Bind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, BufferID);
+    GLStateCache::GetInstance().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, BufferID);
 }
 
 void ElementBufferObject::Unbind() const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::GetInstance().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+bool ElementBufferObject::UploadData(GLsizeiptr size, const void* data, GLenum usage)
+{
+#if USE_DSA
+    // Immutable storage is updated in place while the data fits, so VAOs attached to BufferID stay valid
+    if (Immutable && usage == GL_STATIC_DRAW && size <= StorageSize)
+    {
+        if (data != nullptr)
+        {
+            glNamedBufferSubData(BufferID, 0, size, data);
+        }
+        return false;
+    }
+
+    const bool replaced = Immutable;
+    if (Immutable)
+    {
+        GLStateCache::GetInstance().OnBufferDeleted(BufferID);
+        glDeleteBuffers(1, &BufferID);
+        glCreateBuffers(1, &BufferID);
+        Immutable = false;
+    }
+
+    if (usage == GL_STATIC_DRAW)
+    {
+        glNamedBufferStorage(BufferID, size, data, GL_DYNAMIC_STORAGE_BIT);
+        Immutable = true;
+        StorageSize = size;
+    }
+    else
+    {
+        glNamedBufferData(BufferID, size, data, usage);
+    }
+    return replaced;
+#else
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
+    return false;
+#endif
 }
@@ -0,0 +1,47 @@
+#include "FBO.h"
+
+FrameBufferObject::FrameBufferObject(uint32 width, uint32 height)
+    : Width(width)
+    , Height(height)
+{
+    glGenFramebuffers(1, &FramebufferID);
+    glGenRenderbuffers(1, &ColorBufferID);
+    glGenRenderbuffers(1, &DepthBufferID);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, ColorBufferID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glBindRenderbuffer(GL_RENDERBUFFER, DepthBufferID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorBufferID);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, DepthBufferID);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+FrameBufferObject::~FrameBufferObject()
+{
+    glDeleteFramebuffers(1, &FramebufferID);
+    glDeleteRenderbuffers(1, &ColorBufferID);
+    glDeleteRenderbuffers(1, &DepthBufferID);
+}
+
+void FrameBufferObject::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+    glViewport(0, 0, static_cast<GLsizei>(Width), static_cast<GLsizei>(Height));
+}
+
+void FrameBufferObject::Unbind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool FrameBufferObject::IsComplete() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
@@ -0,0 +1,62 @@
+#include "Frustum.h"
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection) noexcept
+{
+    // glm matrices are column-major, m[column][row]
+    const auto row = [&viewProjection](int r) {
+        return glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+    };
+
+    const glm::vec4 r0 = row(0);
+    const glm::vec4 r1 = row(1);
+    const glm::vec4 r2 = row(2);
+    const glm::vec4 r3 = row(3);
+
+    Frustum frustum;
+    frustum.Planes[Left] = r3 + r0;
+    frustum.Planes[Right] = r3 - r0;
+    frustum.Planes[Bottom] = r3 + r1;
+    frustum.Planes[Top] = r3 - r1;
+    frustum.Planes[Near] = r3 + r2;
+    frustum.Planes[Far] = r3 - r2;
+
+    for (glm::vec4& plane : frustum.Planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    return frustum;
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const noexcept
+{
+    for (const glm::vec4& plane : Planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+Frustum::Containment Frustum::TestBox(const glm::vec3& center, const glm::vec3& halfExtents) const noexcept
+{
+    Containment result = Containment::Inside;
+    for (const glm::vec4& plane : Planes)
+    {
+        // Projected radius of the box onto the plane normal
+        const float radius = glm::dot(glm::abs(glm::vec3(plane)), halfExtents);
+        const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+
+        if (distance < -radius)
+        {
+            return Containment::Outside;
+        }
+        if (distance < radius)
+        {
+            result = Containment::Intersects;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,224 @@
+#include "GLState.h"
+#include <numeric>
+
+uint32 GLStateCache::Counters::GetTotalIssued() const noexcept
+{
+    return std::accumulate(Issued.begin(), Issued.end(), 0u);
+}
+
+uint32 GLStateCache::Counters::GetTotalSkipped() const noexcept
+{
+    return std::accumulate(Skipped.begin(), Skipped.end(), 0u);
+}
+
+GLStateCache::BufferSlot GLStateCache::ToBufferSlot(GLenum target) noexcept
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:          return ArrayBuffer;
+    case GL_ELEMENT_ARRAY_BUFFER:  return ElementArrayBuffer;
+    case GL_SHADER_STORAGE_BUFFER: return ShaderStorageBuffer;
+    case GL_DRAW_INDIRECT_BUFFER:  return DrawIndirectBuffer;
+    case GL_UNIFORM_BUFFER:        return UniformBuffer;
+    default:                       return NoBufferSlot;
+    }
+}
+
+GLStateCache::TextureSlot GLStateCache::ToTextureSlot(GLenum target) noexcept
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:       return Texture2D;
+    case GL_TEXTURE_CUBE_MAP: return TextureCubeMap;
+    case GL_TEXTURE_3D:       return Texture3D;
+    case GL_TEXTURE_2D_ARRAY: return Texture2DArray;
+    default:                  return NoTextureSlot;
+    }
+}
+
+bool GLStateCache::Track(GLStateCall call, GLuint& cached, GLuint requested) noexcept
+{
+    const size_t index = static_cast<size_t>(call);
+    if (cached == requested)
+    {
+        ++FrameCounters.Skipped[index];
+        return false;
+    }
+
+    cached = requested;
+    ++FrameCounters.Issued[index];
+    return true;
+}
+
+void GLStateCache::BindVertexArray(GLuint arrayID)
+{
+    if (Track(GLStateCall::VertexArray, VertexArray, arrayID))
+    {
+        glBindVertexArray(arrayID);
+
+        // The element array binding is part of the VAO state, it is unknown after a switch
+        Buffers[ElementArrayBuffer] = Unknown;
+    }
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint bufferID)
+{
+    const BufferSlot slot = ToBufferSlot(target);
+    if (slot == NoBufferSlot)
+    {
+        ++FrameCounters.Issued[static_cast<size_t>(GLStateCall::Buffer)];
+        glBindBuffer(target, bufferID);
+        return;
+    }
+
+    if (Track(GLStateCall::Buffer, Buffers[slot], bufferID))
+    {
+        glBindBuffer(target, bufferID);
+    }
+}
+
+void GLStateCache::BindBufferBase(GLenum target, GLuint bindingIndex, GLuint bufferID)
+{
+    GLuint* cached = nullptr;
+    if (bindingIndex < MaxBufferBindings)
+    {
+        if (target == GL_SHADER_STORAGE_BUFFER)
+            cached = &StorageBindings[bindingIndex];
+        else if (target == GL_UNIFORM_BUFFER)
+            cached = &UniformBindings[bindingIndex];
+    }
+
+    if (cached == nullptr)
+    {
+        ++FrameCounters.Issued[static_cast<size_t>(GLStateCall::BufferBase)];
+        glBindBufferBase(target, bindingIndex, bufferID);
+    }
+    else if (Track(GLStateCall::BufferBase, *cached, bufferID))
+    {
+        glBindBufferBase(target, bindingIndex, bufferID);
+    }
+    else
+    {
+        return;
+    }
+
+    // glBindBufferBase also replaces the generic binding of the target
+    const BufferSlot slot = ToBufferSlot(target);
+    if (slot != NoBufferSlot)
+    {
+        Buffers[slot] = bufferID;
+    }
+}
+
+void GLStateCache::BindBufferRange(GLenum target, GLuint bindingIndex, GLuint bufferID, GLintptr offset, GLsizeiptr size)
+{
+    ++FrameCounters.Issued[static_cast<size_t>(GLStateCall::BufferBase)];
+    glBindBufferRange(target, bindingIndex, bufferID, offset, size);
+
+    // The indexed binding no longer covers the whole buffer, so the next BindBufferBase must be issued
+    if (bindingIndex < MaxBufferBindings)
+    {
+        if (target == GL_SHADER_STORAGE_BUFFER)
+            StorageBindings[bindingIndex] = Unknown;
+        else if (target == GL_UNIFORM_BUFFER)
+            UniformBindings[bindingIndex] = Unknown;
+    }
+
+    const BufferSlot slot = ToBufferSlot(target);
+    if (slot != NoBufferSlot)
+    {
+        Buffers[slot] = bufferID;
+    }
+}
+
+void GLStateCache::UseProgram(GLuint programID)
+{
+    if (Track(GLStateCall::Program, Program, programID))
+    {
+        glUseProgram(programID);
+    }
+}
+
+void GLStateCache::ActiveTexture(GLuint unit)
+{
+    if (Track(GLStateCall::ActiveTexture, ActiveUnit, unit))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLStateCache::BindTexture(GLenum target, GLuint textureID)
+{
+    const TextureSlot slot = ToTextureSlot(target);
+    if (slot == NoTextureSlot || ActiveUnit >= MaxTextureUnits)
+    {
+        ++FrameCounters.Issued[static_cast<size_t>(GLStateCall::Texture)];
+        glBindTexture(target, textureID);
+
+        if (slot != NoTextureSlot)
+        {
+            // The active unit is unknown, so any unit may now hold this texture
+            for (auto& unit : Textures)
+                unit[slot] = Unknown;
+        }
+        return;
+    }
+
+    if (Track(GLStateCall::Texture, Textures[ActiveUnit][slot], textureID))
+    {
+        glBindTexture(target, textureID);
+    }
+}
+
+void GLStateCache::BindTextureUnit(GLuint unit, GLenum target, GLuint textureID)
+{
+    ActiveTexture(unit);
+    BindTexture(target, textureID);
+}
+
+void GLStateCache::OnVertexArrayDeleted(GLuint arrayID)
+{
+    if (VertexArray == arrayID)
+    {
+        VertexArray = 0;
+        Buffers[ElementArrayBuffer] = Unknown;
+    }
+}
+
+void GLStateCache::OnBufferDeleted(GLuint bufferID)
+{
+    for (GLuint& buffer : Buffers)
+        if (buffer == bufferID) buffer = 0;
+    for (GLuint& buffer : StorageBindings)
+        if (buffer == bufferID) buffer = 0;
+    for (GLuint& buffer : UniformBindings)
+        if (buffer == bufferID) buffer = 0;
+}
+
+void GLStateCache::OnProgramDeleted(GLuint programID)
+{
+    // A deleted program stays in use until another one is bound, so only forget it
+    if (Program == programID)
+    {
+        Program = Unknown;
+    }
+}
+
+void GLStateCache::OnTextureDeleted(GLuint textureID)
+{
+    for (auto& unit : Textures)
+        for (GLuint& texture : unit)
+            if (texture == textureID) texture = 0;
+}
+
+void GLStateCache::Invalidate()
+{
+    VertexArray = Unknown;
+    Program = Unknown;
+    ActiveUnit = Unknown;
+    Buffers.fill(Unknown);
+    StorageBindings.fill(Unknown);
+    UniformBindings.fill(Unknown);
+    for (auto& unit : Textures)
+        unit.fill(Unknown);
+}
@@ -0,0 +1,63 @@
+#include "GPUCulling.h"
+#include "InstanceData.h"
+#include <algorithm>
+
+GPUCullingPass::GPUCullingPass(std::string_view shaderPath)
+    : Shader(shaderPath)
+{
+    GroupSizeX = std::max(Shader.GetWorkGroupSize().x, 1u);
+
+    const DrawElementsIndirectCommand empty{};
+    CommandBuffer.UploadData(sizeof(DrawElementsIndirectCommand), &empty, GL_DYNAMIC_DRAW);
+    CommandBuffer.Unbind();
+}
+
+void GPUCullingPass::UploadObjects(const std::vector<CullObject>& objects)
+{
+    ObjectCount = static_cast<uint32>(objects.size());
+
+    ObjectBuffer.UploadData(objects, GL_STATIC_DRAW);
+
+    // Worst case every object is visible, the compute pass only ever writes into this buffer
+    InstanceBuffer.UploadData(static_cast<GLsizeiptr>(objects.size() * sizeof(InstanceData)), nullptr, GL_DYNAMIC_COPY);
+    InstanceBuffer.Unbind();
+}
+
+void GPUCullingPass::Run(const Frustum& frustum, float time, const DrawElementsIndirectCommand& drawTemplate)
+{
+    if (ObjectCount == 0) [[unlikely]]
+        return;
+
+    DrawElementsIndirectCommand command = drawTemplate;
+    command.instanceCount = 0;
+    command.baseInstance = 0;
+    CommandBuffer.UpdateData(0, sizeof(command), &command);
+    CommandBuffer.Unbind();
+
+    ObjectBuffer.BindBase(CULL_OBJECT_BUFFER_BINDING);
+    InstanceBuffer.BindBase(INSTANCE_BUFFER_BINDING);
+    CommandBuffer.BindStorage(CULL_COMMAND_BUFFER_BINDING);
+
+    Shader.Bind();
+    Shader.SetVec4Array("FrustumPlanes", frustum.Planes);
+    Shader.SetFloat("Time", time);
+    Shader.SetInt("ObjectCount", static_cast<int>(ObjectCount));
+
+    const GLuint groups = (ObjectCount + GroupSizeX - 1) / GroupSizeX;
+    Shader.DispatchWithBarrier(groups, 1, 1, GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void GPUCullingPass::Draw(const MeshRegistry& registry, MeshHandle mesh) const
+{
+    InstanceBuffer.BindBase(INSTANCE_BUFFER_BINDING);
+    CommandBuffer.Bind();
+    registry.MultiDrawIndirect(mesh, 0, 1);
+}
+
+uint32 GPUCullingPass::ReadVisibleCount() const
+{
+    DrawElementsIndirectCommand command{};
+    CommandBuffer.Bind();
+    glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+    return command.instanceCount;
+}
@@ -0,0 +1,194 @@
+#include "GeometryPool.h"
+#include "MeshOptimizer.h"
+#include "GLState.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // Immutable storage that only accepts glNamedBufferSubData updates. Without DSA the buffers are filled
+    // through the copy targets, so uploads never touch the element binding of a bound VAO
+    GLuint CreateBuffer(GLsizeiptr size)
+    {
+        GLuint bufferID = 0;
+#if USE_DSA
+        glCreateBuffers(1, &bufferID);
+        glNamedBufferStorage(bufferID, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+#else
+        glGenBuffers(1, &bufferID);
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+#endif
+        return bufferID;
+    }
+
+    void UploadBuffer(GLuint bufferID, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+#if USE_DSA
+        glNamedBufferSubData(bufferID, offset, size, data);
+#else
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+#endif
+    }
+
+    // Moves the contents into a larger buffer on the GPU and deletes the old one
+    GLuint ResizeBuffer(GLuint bufferID, GLsizeiptr oldSize, GLsizeiptr newSize)
+    {
+        GLStateCache& cache = GLStateCache::GetInstance();
+        const GLuint resized = CreateBuffer(newSize);
+#if USE_DSA
+        glCopyNamedBufferSubData(bufferID, resized, 0, 0, oldSize);
+#else
+        cache.BindBuffer(GL_COPY_READ_BUFFER, bufferID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+#endif
+
+        cache.OnBufferDeleted(bufferID);
+        glDeleteBuffers(1, &bufferID);
+        return resized;
+    }
+
+    uint32 GrownCapacity(uint32 capacity, uint32 count)
+    {
+        const uint64 grown = std::max<uint64>(static_cast<uint64>(capacity) * 2, static_cast<uint64>(capacity) + count);
+        return static_cast<uint32>(std::min<uint64>(grown, RangeAllocator::InvalidOffset - 1));
+    }
+}
+
+GeometryPool::GeometryPool(uint32 vertexStride, AttributeSetup attributeSetup, GLenum indexType, uint32 vertexCapacity, uint32 indexCapacity)
+    : VertexStride(vertexStride)
+    , SetupAttributes(attributeSetup)
+    , IndexType(indexType)
+    , IndexSize(MeshOptimizer::GetIndexSize(indexType))
+    , Vertices(std::max(vertexCapacity, 1u))
+    , Indices(std::max(indexCapacity, 1u))
+{
+    VertexBufferID = CreateBuffer(static_cast<GLsizeiptr>(Vertices.GetSize()) * VertexStride);
+    IndexBufferID = CreateBuffer(static_cast<GLsizeiptr>(Indices.GetSize()) * IndexSize);
+    AttachBuffers();
+}
+
+GeometryPool::~GeometryPool()
+{
+    GLStateCache& cache = GLStateCache::GetInstance();
+    cache.OnBufferDeleted(VertexBufferID);
+    cache.OnBufferDeleted(IndexBufferID);
+    glDeleteBuffers(1, &VertexBufferID);
+    glDeleteBuffers(1, &IndexBufferID);
+}
+
+GeometryPool::Range GeometryPool::Allocate(const void* vertexData, uint32 vertexCount, const void* indexData, uint32 indexCount,
+    GLenum indexType, uint32 vertexAlignment)
+{
+    // The allocator has no alignment of its own, so reserve enough slack to round the start up
+    vertexAlignment = std::max(vertexAlignment, 1u);
+    const uint32 reservedVertices = vertexCount + vertexAlignment - 1;
+
+    Range range;
+    range.Vertices = Vertices.Allocate(reservedVertices);
+    if (!range.Vertices.IsValid())
+    {
+        GrowVertices(reservedVertices);
+        range.Vertices = Vertices.Allocate(reservedVertices);
+    }
+
+    range.Indices = Indices.Allocate(indexCount);
+    if (!range.Indices.IsValid())
+    {
+        GrowIndices(indexCount);
+        range.Indices = Indices.Allocate(indexCount);
+    }
+
+    if (!range.IsValid())
+    {
+        std::cerr << "ERROR::GEOMETRY_POOL::ALLOCATION_FAILED " << vertexCount << " vertices, "
+            << indexCount << " indices" << std::endl;
+        Free(range);
+        return {};
+    }
+
+    range.FirstVertex = (range.Vertices.Offset + vertexAlignment - 1) / vertexAlignment * vertexAlignment;
+    UploadBuffer(VertexBufferID, static_cast<GLintptr>(range.FirstVertex) * VertexStride,
+        static_cast<GLsizeiptr>(vertexCount) * VertexStride, vertexData);
+    const GLintptr indexOffset = static_cast<GLintptr>(range.Indices.Offset) * IndexSize;
+    const GLsizeiptr indexBytes = static_cast<GLsizeiptr>(indexCount) * IndexSize;
+    if (indexType == IndexType)
+    {
+        UploadBuffer(IndexBufferID, indexOffset, indexBytes, indexData);
+    }
+    else if (IndexType == GL_UNSIGNED_SHORT)
+    {
+        const uint32* indices = static_cast<const uint32*>(indexData);
+        const std::vector<uint16> narrowed(indices, indices + indexCount);
+        UploadBuffer(IndexBufferID, indexOffset, indexBytes, narrowed.data());
+    }
+    else
+    {
+        const uint16* indices = static_cast<const uint16*>(indexData);
+        const std::vector<uint32> widened(indices, indices + indexCount);
+        UploadBuffer(IndexBufferID, indexOffset, indexBytes, widened.data());
+    }
+
+    return range;
+}
+
+void GeometryPool::BindVertexStorage(GLuint bindingIndex) const
+{
+    GLStateCache::GetInstance().BindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingIndex, VertexBufferID);
+}
+
+void GeometryPool::Free(const Range& range)
+{
+    Vertices.Free(range.Vertices);
+    Indices.Free(range.Indices);
+}
+
+void GeometryPool::GrowVertices(uint32 count)
+{
+    const uint32 capacity = GrownCapacity(Vertices.GetSize(), count);
+    VertexBufferID = ResizeBuffer(VertexBufferID, static_cast<GLsizeiptr>(Vertices.GetSize()) * VertexStride,
+        static_cast<GLsizeiptr>(capacity) * VertexStride);
+    Vertices.Grow(capacity);
+    AttachBuffers();
+}
+
+void GeometryPool::GrowIndices(uint32 count)
+{
+    const uint32 capacity = GrownCapacity(Indices.GetSize(), count);
+    IndexBufferID = ResizeBuffer(IndexBufferID, static_cast<GLsizeiptr>(Indices.GetSize()) * IndexSize,
+        static_cast<GLsizeiptr>(capacity) * IndexSize);
+    Indices.Grow(capacity);
+    AttachBuffers();
+}
+
+void GeometryPool::AttachBuffers() const
+{
+    // Word pools for vertex pulling have no attributes, their VAO only holds the index buffer
+    if (SetupAttributes == nullptr)
+    {
+#if !USE_DSA
+        VAO.Bind();
+#endif
+        VAO.AttachElementBuffer(IndexBufferID);
+#if !USE_DSA
+        VAO.Unbind();
+#endif
+        return;
+    }
+
+#if USE_DSA
+    // Formats and buffers are set by name, the VAO is never bound and the cached bindings stay valid
+    VAO.AttachVertexBuffer(VertexBufferID);
+    SetupAttributes(VAO);
+    VAO.AttachElementBuffer(IndexBufferID);
+#else
+    // Attribute pointers capture the buffer bound to GL_ARRAY_BUFFER, so they are set again after every reallocation
+    VAO.Bind();
+    VAO.AttachVertexBuffer(VertexBufferID);
+    SetupAttributes(VAO);
+    VAO.AttachElementBuffer(IndexBufferID);
+    VAO.Unbind();
+#endif
+}
@@ -0,0 +1,40 @@
+#include "IndirectBuffer.h"
+#include "GLState.h"
+
+IndirectBufferObject::IndirectBufferObject()
+{
+    glGenBuffers(1, &BufferID);
+}
+
+IndirectBufferObject::~IndirectBufferObject()
+{
+    GLStateCache::GetInstance().OnBufferDeleted(BufferID);
+    glDeleteBuffers(1, &BufferID);
+}
+
+void IndirectBufferObject::Bind() const
+{
+    GLStateCache::GetInstance().BindBuffer(GL_DRAW_INDIRECT_BUFFER, BufferID);
+}
+
+void IndirectBufferObject::Unbind() const
+{
+    GLStateCache::GetInstance().BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void IndirectBufferObject::UploadData(GLsizeiptr size, const void* data, GLenum usage)
+{
+    Bind();
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, size, data, usage);
+}
+
+void IndirectBufferObject::UpdateData(GLintptr offset, GLsizeiptr size, const void* data) const
+{
+    Bind();
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, size, data);
+}
+
+void IndirectBufferObject::BindStorage(GLuint bindingIndex) const
+{
+    GLStateCache::GetInstance().BindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingIndex, BufferID);
+}
@@ -0,0 +1,259 @@
+#include "JobSystem.h"
+
+namespace
+{
+    // 0 is the main thread (and any other thread that is not a worker)
+    thread_local uint32 CurrentThreadIndex = 0;
+
+    // Jobs that wait run other jobs inside Execute(), only the outermost one is timed
+    thread_local uint32 ExecuteDepth = 0;
+}
+
+JobSystem::JobSystem()
+{
+    const uint32 hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    Threads.reserve(hardwareThreads);
+    for (uint32 i = 0; i < hardwareThreads; ++i)
+    {
+        Threads.push_back(std::make_unique<ThreadState>());
+    }
+
+    Workers.reserve(hardwareThreads - 1);
+    for (uint32 i = 1; i < hardwareThreads; ++i)
+    {
+        Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        Running.store(false);
+    }
+    SleepCondition.notify_all();
+
+    for (std::thread& worker : Workers)
+    {
+        worker.join();
+    }
+}
+
+uint32 JobSystem::GetCurrentThreadIndex() noexcept
+{
+    return CurrentThreadIndex;
+}
+
+std::vector<Job>& JobSystem::ScratchBatch()
+{
+    thread_local std::vector<Job> batch;
+    return batch;
+}
+
+void JobSystem::WorkerLoop(uint32 threadIndex)
+{
+    CurrentThreadIndex = threadIndex;
+
+    Job job;
+    while (true)
+    {
+        if (TryGetJob(threadIndex, job))
+        {
+            Execute(threadIndex, job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(SleepMutex);
+        SleepCondition.wait(lock, [this] { return !Running.load() || QueuedJobs.load() > 0; });
+        if (!Running.load() && QueuedJobs.load() <= 0)
+            return;
+    }
+}
+
+void JobSystem::Push(const Job* jobs, size_t count)
+{
+    if (count == 0)
+        return;
+
+    // Counted before the jobs become visible, so the count never goes below the number of queued jobs
+    QueuedJobs.fetch_add(static_cast<int64>(count));
+
+    const uint32 threadCount = GetThreadCount();
+    const uint32 first = NextQueue.fetch_add(1, std::memory_order_relaxed);
+
+    // Round-robin over the deques, each lock taken once per batch
+    for (uint32 offset = 0; offset < threadCount && offset < count; ++offset)
+    {
+        ThreadState& thread = *Threads[(first + offset) % threadCount];
+        std::lock_guard<std::mutex> lock(thread.QueueMutex);
+        for (size_t i = offset; i < count; i += threadCount)
+        {
+            thread.Queue.push_back(jobs[i]);
+        }
+    }
+
+    // Waiters check QueuedJobs under SleepMutex, passing through it here prevents a lost wakeup
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+    }
+    if (count == 1)
+        SleepCondition.notify_one();
+    else
+        SleepCondition.notify_all();
+}
+
+void JobSystem::Submit(std::vector<Job>& batch, JobCounter& counter, JobCounter* dependency)
+{
+    const uint32 jobCount = static_cast<uint32>(batch.size());
+    counter.Pending.fetch_add(jobCount);
+    counter.Outstanding.fetch_add(jobCount);
+
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> lock(dependency->ContinuationMutex);
+        if (dependency->Pending.load() > 0)
+        {
+            dependency->Continuations.insert(dependency->Continuations.end(), batch.begin(), batch.end());
+            return;
+        }
+    }
+
+    Push(batch.data(), batch.size());
+}
+
+void JobSystem::Schedule(void (*function)(const Job&), void* data, JobCounter& counter, JobCounter* dependency)
+{
+    std::vector<Job>& batch = ScratchBatch();
+    batch.clear();
+
+    Job& job = batch.emplace_back();
+    job.Function = function;
+    job.Data = data;
+    job.Counter = &counter;
+
+    Submit(batch, counter, dependency);
+}
+
+bool JobSystem::TryGetJob(uint32 threadIndex, Job& job)
+{
+    if (QueuedJobs.load(std::memory_order_relaxed) <= 0)
+        return false;
+
+    // Own deque first, newest job
+    {
+        ThreadState& own = *Threads[threadIndex];
+        std::lock_guard<std::mutex> lock(own.QueueMutex);
+        if (!own.Queue.empty())
+        {
+            job = own.Queue.back();
+            own.Queue.pop_back();
+            QueuedJobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Steal the oldest job of another thread
+    const uint32 threadCount = GetThreadCount();
+    for (uint32 offset = 1; offset < threadCount; ++offset)
+    {
+        ThreadState& victim = *Threads[(threadIndex + offset) % threadCount];
+        std::lock_guard<std::mutex> lock(victim.QueueMutex);
+        if (!victim.Queue.empty())
+        {
+            job = victim.Queue.front();
+            victim.Queue.pop_front();
+            QueuedJobs.fetch_sub(1);
+            Threads[threadIndex]->Steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(uint32 threadIndex, const Job& job)
+{
+    ThreadState& thread = *Threads[threadIndex];
+    const bool outermost = ExecuteDepth++ == 0;
+    const Clock::time_point start = outermost ? Clock::now() : Clock::time_point();
+
+    job.Function(job);
+
+    if (outermost)
+    {
+        const Clock::duration busy = Clock::now() - start;
+        thread.BusyNanoseconds.fetch_add(static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count()), std::memory_order_relaxed);
+    }
+    --ExecuteDepth;
+    thread.JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+
+    Finish(*job.Counter);
+}
+
+void JobSystem::Finish(JobCounter& counter)
+{
+    std::vector<Job> released;
+    if (counter.Pending.fetch_sub(1) == 1)
+    {
+        std::lock_guard<std::mutex> lock(counter.ContinuationMutex);
+        released.swap(counter.Continuations);
+    }
+
+    // Last access to the counter, a waiter may destroy it right after this
+    counter.Outstanding.fetch_sub(1, std::memory_order_release);
+
+    Push(released.data(), released.size());
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    const uint32 threadIndex = GetCurrentThreadIndex();
+
+    Job job;
+    while (!counter.IsDone())
+    {
+        if (TryGetJob(threadIndex, job))
+        {
+            Execute(threadIndex, job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::BeginFrame()
+{
+    for (const std::unique_ptr<ThreadState>& thread : Threads)
+    {
+        thread->BusyNanoseconds.store(0, std::memory_order_relaxed);
+        thread->JobsExecuted.store(0, std::memory_order_relaxed);
+        thread->Steals.store(0, std::memory_order_relaxed);
+    }
+    FrameStart = Clock::now();
+}
+
+JobSystem::FrameStats JobSystem::GetFrameStats() const
+{
+    FrameStats stats;
+    uint64 workerBusy = 0;
+    for (size_t i = 0; i < Threads.size(); ++i)
+    {
+        const ThreadState& thread = *Threads[i];
+        stats.JobsExecuted += thread.JobsExecuted.load(std::memory_order_relaxed);
+        stats.Steals += thread.Steals.load(std::memory_order_relaxed);
+        if (i > 0)
+        {
+            workerBusy += thread.BusyNanoseconds.load(std::memory_order_relaxed);
+        }
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - FrameStart).count();
+    if (!Workers.empty() && elapsed > 0)
+    {
+        stats.WorkerUtilization = static_cast<float>(static_cast<double>(workerBusy) / (static_cast<double>(elapsed) * static_cast<double>(Workers.size())));
+    }
+    return stats;
+}
@@ -0,0 +1,282 @@
+#include "Json.h"
+#include <charconv>
+
+namespace
+{
+    // Deeper documents are rejected instead of overflowing the stack
+    constexpr uint32 MaxDepth = 256;
+
+    const JsonValue NullValue;
+
+    void AppendUtf8(std::string& out, uint32 codePoint)
+    {
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
+/**
+ * @brief Recursive descent parser filling a JsonValue tree.
+ */
+class JsonParser
+{
+public:
+    explicit JsonParser(std::string_view text) : Text(text) {}
+
+    bool ParseDocument(JsonValue& result, std::string& error)
+    {
+        SkipWhitespace();
+        if (!ParseValue(result, 0))
+        {
+            error = Error + " at offset " + std::to_string(Position);
+            return false;
+        }
+
+        SkipWhitespace();
+        if (Position != Text.size())
+        {
+            error = "Unexpected data after the document at offset " + std::to_string(Position);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool Fail(const char* message)
+    {
+        Error = message;
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (Position < Text.size() && (Text[Position] == ' ' || Text[Position] == '\t' || Text[Position] == '\n' || Text[Position] == '\r'))
+        {
+            ++Position;
+        }
+    }
+
+    bool Consume(std::string_view literal)
+    {
+        if (Text.substr(Position, literal.size()) != literal)
+            return false;
+        Position += literal.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value, uint32 depth)
+    {
+        if (depth > MaxDepth)
+            return Fail("Document nested too deeply");
+        if (Position >= Text.size())
+            return Fail("Unexpected end of document");
+
+        switch (Text[Position])
+        {
+        case '{':
+            return ParseObject(value, depth);
+        case '[':
+            return ParseArray(value, depth);
+        case '"':
+            value.ValueType = JsonValue::Type::String;
+            return ParseString(value.Text);
+        case 't':
+            value.ValueType = JsonValue::Type::Bool;
+            value.Boolean = true;
+            return Consume("true") || Fail("Invalid literal");
+        case 'f':
+            value.ValueType = JsonValue::Type::Bool;
+            value.Boolean = false;
+            return Consume("false") || Fail("Invalid literal");
+        case 'n':
+            value.ValueType = JsonValue::Type::Null;
+            return Consume("null") || Fail("Invalid literal");
+        default:
+            return ParseNumber(value);
+        }
+    }
+
+    bool ParseNumber(JsonValue& value)
+    {
+        const char* begin = Text.data() + Position;
+        const char* end = Text.data() + Text.size();
+        const auto [next, result] = std::from_chars(begin, end, value.Number);
+        if (result != std::errc() || next == begin)
+            return Fail("Invalid number");
+
+        value.ValueType = JsonValue::Type::Number;
+        Position += static_cast<size_t>(next - begin);
+        return true;
+    }
+
+    bool ParseHex4(uint32& codeUnit)
+    {
+        if (Position + 4 > Text.size())
+            return Fail("Truncated unicode escape");
+
+        const char* begin = Text.data() + Position;
+        const auto [next, result] = std::from_chars(begin, begin + 4, codeUnit, 16);
+        if (result != std::errc() || next != begin + 4)
+            return Fail("Invalid unicode escape");
+
+        Position += 4;
+        return true;
+    }
+
+    bool ParseString(std::string& out)
+    {
+        ++Position;  // Opening quote
+        while (Position < Text.size())
+        {
+            const char c = Text[Position++];
+            if (c == '"')
+                return true;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+
+            if (Position >= Text.size())
+                break;
+
+            switch (Text[Position++])
+            {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                uint32 codePoint = 0;
+                if (!ParseHex4(codePoint))
+                    return false;
+
+                // Characters outside the basic plane are written as a surrogate pair
+                if (codePoint >= 0xD800 && codePoint < 0xDC00)
+                {
+                    uint32 low = 0;
+                    if (!Consume("\\u") || !ParseHex4(low) || low < 0xDC00 || low >= 0xE000)
+                        return Fail("Invalid surrogate pair");
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                AppendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return Fail("Invalid escape sequence");
+            }
+        }
+        return Fail("Unterminated string");
+    }
+
+    bool ParseArray(JsonValue& value, uint32 depth)
+    {
+        value.ValueType = JsonValue::Type::Array;
+        ++Position;
+        SkipWhitespace();
+        if (Consume("]"))
+            return true;
+
+        while (true)
+        {
+            SkipWhitespace();
+            if (!ParseValue(value.Elements.emplace_back(), depth + 1))
+                return false;
+
+            SkipWhitespace();
+            if (Consume("]"))
+                return true;
+            if (!Consume(","))
+                return Fail("Expected ',' or ']'");
+        }
+    }
+
+    bool ParseObject(JsonValue& value, uint32 depth)
+    {
+        value.ValueType = JsonValue::Type::Object;
+        ++Position;
+        SkipWhitespace();
+        if (Consume("}"))
+            return true;
+
+        while (true)
+        {
+            SkipWhitespace();
+            if (Position >= Text.size() || Text[Position] != '"')
+                return Fail("Expected a member name");
+            if (!ParseString(value.Keys.emplace_back()))
+                return false;
+
+            SkipWhitespace();
+            if (!Consume(":"))
+                return Fail("Expected ':'");
+
+            SkipWhitespace();
+            if (!ParseValue(value.Elements.emplace_back(), depth + 1))
+                return false;
+
+            SkipWhitespace();
+            if (Consume("}"))
+                return true;
+            if (!Consume(","))
+                return Fail("Expected ',' or '}'");
+        }
+    }
+
+    std::string_view Text;
+    size_t Position = 0;
+    std::string Error;
+};
+
+bool JsonValue::Parse(std::string_view text, JsonValue& result, std::string& error)
+{
+    result = JsonValue{};
+    JsonParser parser(text);
+    return parser.ParseDocument(result, error);
+}
+
+const JsonValue* JsonValue::Find(std::string_view key) const noexcept
+{
+    for (size_t i = 0; i < Keys.size(); ++i)
+    {
+        if (Keys[i] == key)
+            return &Elements[i];
+    }
+    return nullptr;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const noexcept
+{
+    const JsonValue* member = Find(key);
+    return member != nullptr ? *member : NullValue;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const noexcept
+{
+    return ValueType == Type::Array && index < Elements.size() ? Elements[index] : NullValue;
+}
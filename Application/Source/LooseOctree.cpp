@@ -0,0 +1,356 @@
+#include "LooseOctree.h"
+#include <bit>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+    // Sphere test of a node's objects, 4 at a time: the (center, radius) rows are transposed into x, y, z, r registers
+    void AppendVisibleSpheres(const Frustum& frustum, const glm::vec4* spheres, const uint32* ids, size_t count, std::vector<uint32>& visible)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(&spheres[i].x);
+            __m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+            __m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+            __m128 radius = _mm_loadu_ps(&spheres[i + 3].x);
+            _MM_TRANSPOSE4_PS(x, y, z, radius);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : frustum.Planes)
+            {
+                const __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+
+            for (uint32 mask = static_cast<uint32>(_mm_movemask_ps(inside)); mask != 0; mask &= mask - 1u)
+            {
+                visible.push_back(ids[i + std::countr_zero(mask)]);
+            }
+        }
+
+        // Same operation order as the SIMD lanes above and CullingSystem, so both always agree on an object
+        for (; i < count; ++i)
+        {
+            const glm::vec4& sphere = spheres[i];
+            bool inside = true;
+            for (const glm::vec4& plane : frustum.Planes)
+            {
+                const float distance = (plane.x * sphere.x + plane.y * sphere.y) + (plane.z * sphere.z + plane.w);
+                inside = inside && distance + sphere.w >= 0.0f;
+            }
+            if (inside)
+            {
+                visible.push_back(ids[i]);
+            }
+        }
+    }
+}
+
+LooseOctree::LooseOctree(const glm::vec3& center, float halfSize, uint32 maxDepth, uint32 leafCapacity)
+    : MaxDepth(maxDepth)
+    , LeafCapacity(leafCapacity)
+{
+    Node& root = Nodes.emplace_back();
+    root.Center = center;
+    root.HalfSize = halfSize;
+    root.Children.fill(InvalidNode);
+}
+
+void LooseOctree::Reserve(size_t objectCount)
+{
+    Objects.reserve(objectCount);
+}
+
+uint32 LooseOctree::ChildIndex(const Node& node, const glm::vec3& center) noexcept
+{
+    return (center.x >= node.Center.x ? 1u : 0u)
+        | (center.y >= node.Center.y ? 2u : 0u)
+        | (center.z >= node.Center.z ? 4u : 0u);
+}
+
+bool LooseOctree::InsideRootCell(const glm::vec3& center) const noexcept
+{
+    const Node& root = Nodes[0];
+    return std::abs(center.x - root.Center.x) <= root.HalfSize
+        && std::abs(center.y - root.Center.y) <= root.HalfSize
+        && std::abs(center.z - root.Center.z) <= root.HalfSize;
+}
+
+int32 LooseOctree::Locate(const glm::vec3& center, float radius, bool create)
+{
+    if (!InsideRootCell(center))
+        return 0;
+
+    // Descend through split nodes while the object still fits the loose bounds of the next level
+    int32 node = 0;
+    while (Nodes[node].Split && radius <= Nodes[node].HalfSize * 0.5f)
+    {
+        const uint32 child = ChildIndex(Nodes[node], center);
+        int32 next = Nodes[node].Children[child];
+        if (next == InvalidNode)
+        {
+            if (!create)
+                return InvalidNode;
+            next = AllocateNode(node, child);
+        }
+        node = next;
+    }
+    return node;
+}
+
+int32 LooseOctree::AllocateNode(int32 parent, uint32 childIndex)
+{
+    // Read before a push_back can move the nodes
+    const float halfSize = Nodes[parent].HalfSize * 0.5f;
+    const glm::vec3 center(
+        Nodes[parent].Center.x + ((childIndex & 1u) ? halfSize : -halfSize),
+        Nodes[parent].Center.y + ((childIndex & 2u) ? halfSize : -halfSize),
+        Nodes[parent].Center.z + ((childIndex & 4u) ? halfSize : -halfSize));
+    const uint32 depth = Nodes[parent].Depth + 1;
+
+    int32 index;
+    if (!FreeNodes.empty())
+    {
+        index = FreeNodes.back();
+        FreeNodes.pop_back();
+    }
+    else
+    {
+        index = static_cast<int32>(Nodes.size());
+        Nodes.emplace_back();
+    }
+
+    Node& node = Nodes[index];
+    node.Center = center;
+    node.HalfSize = halfSize;
+    node.Parent = parent;
+    node.Depth = depth;
+    node.Split = false;
+    node.Children.fill(InvalidNode);
+    node.SubtreeObjects = 0;
+    node.Spheres.clear();
+    node.Ids.clear();
+
+    Nodes[parent].Children[childIndex] = index;
+    return index;
+}
+
+void LooseOctree::ReleaseEmptyNodes(int32 node)
+{
+    // Every node below the root holds at least one object in its subtree, so only the path to the root can empty
+    while (node != 0 && Nodes[node].SubtreeObjects == 0)
+    {
+        const int32 parent = Nodes[node].Parent;
+        for (int32& child : Nodes[parent].Children)
+        {
+            if (child == node)
+            {
+                child = InvalidNode;
+                break;
+            }
+        }
+
+        FreeNodes.push_back(node);
+        node = parent;
+    }
+}
+
+void LooseOctree::SplitIfFull(int32 node)
+{
+    if (Nodes[node].Split || Nodes[node].Depth >= MaxDepth || Nodes[node].Ids.size() <= LeafCapacity)
+        return;
+
+    Nodes[node].Split = true;
+
+    // Walk backwards: Detach() moves the last object into the freed slot, which has been visited already
+    const float childHalfSize = Nodes[node].HalfSize * 0.5f;
+    for (size_t slot = Nodes[node].Ids.size(); slot-- > 0;)
+    {
+        const glm::vec4 sphere = Nodes[node].Spheres[slot];
+        const glm::vec3 center(sphere);
+        if (sphere.w > childHalfSize || (node == 0 && !InsideRootCell(center)))
+            continue;
+
+        const uint32 id = Nodes[node].Ids[slot];
+        const uint32 childIndex = ChildIndex(Nodes[node], center);
+        int32 child = Nodes[node].Children[childIndex];
+        if (child == InvalidNode)
+        {
+            child = AllocateNode(node, childIndex);
+        }
+
+        Detach(id);
+        Attach(id, child, sphere);
+    }
+
+    // Objects can all end up in one child when they are clustered
+    for (size_t i = 0; i < Nodes[node].Children.size(); ++i)
+    {
+        const int32 child = Nodes[node].Children[i];
+        if (child != InvalidNode)
+        {
+            SplitIfFull(child);
+        }
+    }
+}
+
+void LooseOctree::Attach(uint32 id, int32 node, const glm::vec4& sphere)
+{
+    Object& object = Objects[id];
+    object.Node = node;
+    object.Slot = static_cast<uint32>(Nodes[node].Ids.size());
+    Nodes[node].Spheres.push_back(sphere);
+    Nodes[node].Ids.push_back(id);
+
+    for (int32 n = node; n != InvalidNode; n = Nodes[n].Parent)
+    {
+        ++Nodes[n].SubtreeObjects;
+    }
+}
+
+void LooseOctree::Detach(uint32 id)
+{
+    Object& object = Objects[id];
+    Node& node = Nodes[object.Node];
+
+    // Swap-remove, the last object of the node takes over the slot
+    const uint32 last = node.Ids.back();
+    node.Ids[object.Slot] = last;
+    node.Spheres[object.Slot] = node.Spheres.back();
+    Objects[last].Slot = object.Slot;
+    node.Ids.pop_back();
+    node.Spheres.pop_back();
+
+    for (int32 n = object.Node; n != InvalidNode; n = Nodes[n].Parent)
+    {
+        --Nodes[n].SubtreeObjects;
+    }
+    object.Node = InvalidNode;
+}
+
+void LooseOctree::Insert(uint32 id, const glm::vec3& center, float radius)
+{
+    if (Contains(id))
+    {
+        Move(id, center, radius);
+        return;
+    }
+
+    if (id >= Objects.size())
+    {
+        Objects.resize(static_cast<size_t>(id) + 1);
+    }
+
+    const int32 node = Locate(center, radius, true);
+    Attach(id, node, glm::vec4(center, radius));
+    SplitIfFull(node);
+    ++ObjectCount;
+}
+
+void LooseOctree::Move(uint32 id, const glm::vec3& center, float radius)
+{
+    if (!Contains(id))
+    {
+        Insert(id, center, radius);
+        return;
+    }
+
+    // Most moves stay inside the cell of the current node
+    const Object& object = Objects[id];
+    const int32 target = Locate(center, radius, false);
+    if (target == object.Node)
+    {
+        Nodes[object.Node].Spheres[object.Slot] = glm::vec4(center, radius);
+        return;
+    }
+
+    const int32 previous = object.Node;
+    const int32 node = target != InvalidNode ? target : Locate(center, radius, true);
+    Detach(id);
+    Attach(id, node, glm::vec4(center, radius));
+    ReleaseEmptyNodes(previous);
+    SplitIfFull(node);
+}
+
+void LooseOctree::Remove(uint32 id)
+{
+    if (!Contains(id))
+        return;
+
+    const int32 previous = Objects[id].Node;
+    Detach(id);
+    ReleaseEmptyNodes(previous);
+    --ObjectCount;
+}
+
+void LooseOctree::Clear()
+{
+    Nodes.resize(1);
+    Nodes[0].Split = false;
+    Nodes[0].Children.fill(InvalidNode);
+    Nodes[0].SubtreeObjects = 0;
+    Nodes[0].Spheres.clear();
+    Nodes[0].Ids.clear();
+
+    FreeNodes.clear();
+    Objects.clear();
+    ObjectCount = 0;
+}
+
+LooseOctree::QueryStats LooseOctree::Query(const Frustum& frustum, std::vector<uint32>& visible) const
+{
+    visible.clear();
+
+    QueryStats stats;
+    QueryNode(0, frustum, visible, stats);
+    return stats;
+}
+
+void LooseOctree::QueryNode(int32 index, const Frustum& frustum, std::vector<uint32>& visible, QueryStats& stats) const
+{
+    const Node& node = Nodes[index];
+    ++stats.NodesVisited;
+
+    AppendVisibleSpheres(frustum, node.Spheres.data(), node.Ids.data(), node.Ids.size(), visible);
+    stats.ObjectsTested += static_cast<uint32>(node.Ids.size());
+
+    for (const int32 childIndex : node.Children)
+    {
+        if (childIndex == InvalidNode)
+            continue;
+
+        // Loose bounds: the cell grown by half its size on every side
+        const Node& child = Nodes[childIndex];
+        const float looseHalfSize = child.HalfSize * 2.0f;
+        switch (frustum.TestBox(child.Center, glm::vec3(looseHalfSize, looseHalfSize, looseHalfSize)))
+        {
+        case Frustum::Containment::Outside:
+            break;
+        case Frustum::Containment::Inside:
+            CollectAll(childIndex, visible, stats);
+            break;
+        case Frustum::Containment::Intersects:
+            QueryNode(childIndex, frustum, visible, stats);
+            break;
+        }
+    }
+}
+
+void LooseOctree::CollectAll(int32 index, std::vector<uint32>& visible, QueryStats& stats) const
+{
+    const Node& node = Nodes[index];
+    ++stats.NodesVisited;
+
+    visible.insert(visible.end(), node.Ids.begin(), node.Ids.end());
+    for (const int32 childIndex : node.Children)
+    {
+        if (childIndex != InvalidNode)
+        {
+            CollectAll(childIndex, visible, stats);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        Data = std::exchange(other.Data, nullptr);
+        Size = std::exchange(other.Size, 0);
+#ifdef WINDOWS
+        FileHandle = std::exchange(other.FileHandle, nullptr);
+        MappingHandle = std::exchange(other.MappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+#ifdef WINDOWS
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        if (mapping != nullptr)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    FileHandle = file;
+    MappingHandle = mapping;
+    Data = static_cast<const uint8*>(view);
+    Size = static_cast<size_t>(size.QuadPart);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat status{};
+    if (fstat(file, &status) != 0 || status.st_size <= 0)
+    {
+        close(file);
+        return false;
+    }
+
+    // The mapping keeps its own reference to the file, the descriptor is not needed afterwards
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    Data = static_cast<const uint8*>(view);
+    Size = static_cast<size_t>(status.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (Data == nullptr)
+        return;
+
+#ifdef WINDOWS
+    UnmapViewOfFile(Data);
+    CloseHandle(MappingHandle);
+    CloseHandle(FileHandle);
+    MappingHandle = nullptr;
+    FileHandle = nullptr;
+#else
+    munmap(const_cast<uint8*>(Data), Size);
+#endif
+    Data = nullptr;
+    Size = 0;
+}
@@ -0,0 +1,58 @@
+#include "Material.h"
+#include <algorithm>
+
+uint32 MaterialTable::Add(const MaterialData& material)
+{
+    const uint32 index = static_cast<uint32>(Materials.size());
+    Materials.push_back(material);
+    Packed.emplace_back(material);
+    MarkDirty(index);
+    return index;
+}
+
+void MaterialTable::Set(uint32 index, const MaterialData& material)
+{
+    Materials[index] = material;
+    Packed[index] = GPUMaterial(material);
+    MarkDirty(index);
+}
+
+void MaterialTable::Upload()
+{
+    if (DirtyBegin == DirtyEnd)
+        return;
+
+    if (Packed.size() > Capacity)
+    {
+        // Grow geometrically so that adding materials one by one does not reallocate every frame
+        Capacity = std::max(Packed.size(), Capacity * 2);
+        Buffer.UploadData(static_cast<GLsizeiptr>(Capacity * sizeof(GPUMaterial)), nullptr, GL_DYNAMIC_DRAW);
+        DirtyBegin = 0;
+        DirtyEnd = static_cast<uint32>(Packed.size());
+    }
+
+    Buffer.UpdateData(static_cast<GLintptr>(DirtyBegin * sizeof(GPUMaterial)),
+        static_cast<GLsizeiptr>((DirtyEnd - DirtyBegin) * sizeof(GPUMaterial)),
+        Packed.data() + DirtyBegin);
+    Buffer.Unbind();
+
+    DirtyBegin = DirtyEnd = 0;
+}
+
+void MaterialTable::Bind(GLuint bindingIndex) const
+{
+    Buffer.BindBase(bindingIndex);
+}
+
+void MaterialTable::MarkDirty(uint32 index)
+{
+    if (DirtyBegin == DirtyEnd)
+    {
+        DirtyBegin = index;
+        DirtyEnd = index + 1;
+        return;
+    }
+
+    DirtyBegin = std::min(DirtyBegin, index);
+    DirtyEnd = std::max(DirtyEnd, index + 1);
+}
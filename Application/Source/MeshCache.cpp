@@ -0,0 +1,291 @@
+#include "MeshCache.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iostream>
+
+static_assert(std::endian::native == std::endian::little, "Mesh caches are stored little endian");
+
+namespace
+{
+    uint64 AlignUp(uint64 value, uint64 alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    uint64 Mix(uint64 value)
+    {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Four independent lanes keep the multiplies of consecutive words from waiting on each other
+    uint64 HashChunk(const uint8* data, size_t size)
+    {
+        uint64 lanes[4] = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull };
+        const size_t wordCount = size / sizeof(uint64);
+        size_t word = 0;
+        for (; word + 4 <= wordCount; word += 4)
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                uint64 value;
+                CopyMemory(data + (word + lane) * sizeof(uint64), &value, sizeof(value));
+                lanes[lane] = std::rotl(lanes[lane] ^ Mix(value), 31) * 0x9E3779B97F4A7C15ull;
+            }
+        }
+
+        uint64 tail[4] = {};
+        CopyMemory(data + word * sizeof(uint64), tail, static_cast<uint32>(size - word * sizeof(uint64)));
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            lanes[lane] = std::rotl(lanes[lane] ^ Mix(tail[lane]), 31) * 0x9E3779B97F4A7C15ull;
+        }
+        return Mix(lanes[0] ^ std::rotl(lanes[1], 17) ^ std::rotl(lanes[2], 29) ^ std::rotl(lanes[3], 43) ^ size);
+    }
+
+    template <typename T>
+    const T* DataAt(std::span<const uint8> file, uint64 offset)
+    {
+        return reinterpret_cast<const T*>(file.data() + offset);
+    }
+
+    bool Fail(const std::filesystem::path& path, const char* reason)
+    {
+        std::cerr << "ERROR::MESH_CACHE::" << reason << " " << path.string() << std::endl;
+        return false;
+    }
+}
+
+uint64 MeshCacheFile::HashContent(std::span<const uint8> data)
+{
+    const size_t chunkCount = (data.size() + HashChunkSize - 1) / HashChunkSize;
+    std::vector<uint64> chunkHashes(chunkCount);
+    JobSystem::GetInstance().ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            const size_t offset = chunk * HashChunkSize;
+            chunkHashes[chunk] = HashChunk(data.data() + offset, std::min(HashChunkSize, data.size() - offset));
+        }
+    });
+
+    uint64 hash = Mix(data.size());
+    for (const uint64 chunkHash : chunkHashes)
+    {
+        hash = Mix(std::rotl(hash, 23) ^ chunkHash);
+    }
+    return hash;
+}
+
+void MeshCacheFile::Close()
+{
+    Meshes.clear();
+    File.Close();
+}
+
+bool MeshCacheFile::Open(const std::filesystem::path& path, uint64 layoutSignature, uint32 vertexStride)
+{
+    Close();
+    if (!File.Open(path))
+        return false;
+
+    const std::span<const uint8> data = File.GetData();
+    if (data.size() < sizeof(MeshCacheHeader))
+    {
+        Close();
+        return Fail(path, "TRUNCATED");
+    }
+
+    MeshCacheHeader header;
+    CopyMemory(data.data(), &header, sizeof(header));
+    const char* error = nullptr;
+    if (header.Magic != MeshCacheHeader::MagicValue)
+        error = "NOT_A_MESH_CACHE";
+    else if (header.Version != MeshCacheHeader::CurrentVersion)
+        error = "VERSION_MISMATCH";
+    else if (header.FileSize != data.size())
+        error = "TRUNCATED";
+    else if (header.LayoutSignature != layoutSignature)
+        error = "VERTEX_LAYOUT_MISMATCH";
+    else if (header.SectionCount < 3 || sizeof(MeshCacheHeader) + static_cast<uint64>(header.SectionCount) * sizeof(MeshCacheSection) > data.size())
+        error = "INVALID_SECTION_TABLE";
+
+    // Every section must lie inside the file, start aligned and hold what its type says
+    const MeshCacheSection* sections = DataAt<MeshCacheSection>(data, sizeof(MeshCacheHeader));
+    for (uint32 i = 0; error == nullptr && i < header.SectionCount; ++i)
+    {
+        const MeshCacheSection& section = sections[i];
+        if (section.Offset % BlobAlignment != 0 || section.Offset > data.size() || section.Size > data.size() - section.Offset)
+            error = "INVALID_SECTION_TABLE";
+    }
+    if (error == nullptr && (sections[0].Type != MeshCacheSectionType::MeshTable || sections[0].Size != header.MeshCount * sizeof(MeshCacheEntry)
+        || sections[1].Type != MeshCacheSectionType::Lods || sections[1].Size % sizeof(MeshLod) != 0
+        || sections[2].Type != MeshCacheSectionType::Names))
+    {
+        error = "INVALID_SECTION_TABLE";
+    }
+
+    // Hashing reads the whole file, so it runs only once the cheap checks passed
+    if (error == nullptr && HashContent(data.subspan(sizeof(MeshCacheHeader))) != header.ContentHash)
+        error = "HASH_MISMATCH";
+    if (error != nullptr)
+    {
+        Close();
+        return Fail(path, error);
+    }
+
+    const MeshCacheEntry* entries = DataAt<MeshCacheEntry>(data, sections[0].Offset);
+    const std::span<const MeshLod> lods(DataAt<MeshLod>(data, sections[1].Offset), sections[1].Size / sizeof(MeshLod));
+    const std::string_view names(DataAt<char>(data, sections[2].Offset), sections[2].Size);
+
+    Meshes.resize(header.MeshCount);
+    for (uint32 i = 0; i < header.MeshCount && error == nullptr; ++i)
+    {
+        const MeshCacheEntry& entry = entries[i];
+        const uint32 indexSize = entry.IndexType == GL_UNSIGNED_SHORT ? 2u : entry.IndexType == GL_UNSIGNED_INT ? 4u : 0u;
+        if (entry.VertexSection >= header.SectionCount || entry.IndexSection >= header.SectionCount || indexSize == 0
+            || static_cast<uint64>(entry.NameOffset) + entry.NameLength > names.size()
+            || static_cast<uint64>(entry.FirstLod) + entry.LodCount > lods.size() || entry.LodCount == 0)
+        {
+            error = "INVALID_MESH_TABLE";
+            break;
+        }
+
+        const MeshCacheSection& vertexSection = sections[entry.VertexSection];
+        const MeshCacheSection& indexSection = sections[entry.IndexSection];
+        if (vertexSection.Type != MeshCacheSectionType::Vertices || vertexSection.Size != static_cast<uint64>(entry.VertexCount) * vertexStride
+            || indexSection.Type != MeshCacheSectionType::Indices || indexSection.Size != static_cast<uint64>(entry.IndexCount) * indexSize)
+        {
+            error = "INVALID_MESH_TABLE";
+            break;
+        }
+
+        Mesh& mesh = Meshes[i];
+        mesh.Name = names.substr(entry.NameOffset, entry.NameLength);
+        mesh.Vertices = data.data() + vertexSection.Offset;
+        mesh.VertexCount = entry.VertexCount;
+        mesh.Indices = data.data() + indexSection.Offset;
+        mesh.IndexCount = entry.IndexCount;
+        mesh.IndexType = entry.IndexType;
+        mesh.Lods = lods.subspan(entry.FirstLod, entry.LodCount);
+        for (const MeshLod& lod : mesh.Lods)
+        {
+            if (static_cast<uint64>(lod.FirstIndex) + lod.IndexCount > entry.IndexCount)
+                error = "INVALID_MESH_TABLE";
+        }
+    }
+
+    if (error != nullptr)
+    {
+        Close();
+        return Fail(path, error);
+    }
+    return true;
+}
+
+bool MeshCacheFile::Write(const std::filesystem::path& path, uint64 layoutSignature, uint32 vertexStride, std::span<const Mesh> meshes)
+{
+    // Section table: mesh table, levels, names, then vertices and indices of every mesh
+    const uint32 sectionCount = 3 + static_cast<uint32>(meshes.size()) * 2;
+    std::vector<MeshCacheSection> sections(sectionCount);
+    std::vector<MeshCacheEntry> entries(meshes.size());
+    std::vector<MeshLod> lods;
+    std::string names;
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const Mesh& mesh = meshes[i];
+        MeshCacheEntry& entry = entries[i];
+        entry = MeshCacheEntry{};
+        entry.NameOffset = static_cast<uint32>(names.size());
+        entry.NameLength = static_cast<uint32>(mesh.Name.size());
+        entry.VertexSection = 3 + static_cast<uint32>(i) * 2;
+        entry.VertexCount = mesh.VertexCount;
+        entry.IndexSection = entry.VertexSection + 1;
+        entry.IndexCount = mesh.IndexCount;
+        entry.IndexType = mesh.IndexType;
+        entry.FirstLod = static_cast<uint32>(lods.size());
+        entry.LodCount = static_cast<uint32>(mesh.Lods.size());
+        names += mesh.Name;
+        lods.insert(lods.end(), mesh.Lods.begin(), mesh.Lods.end());
+
+        sections[entry.VertexSection] = { MeshCacheSectionType::Vertices, 0, 0, static_cast<uint64>(mesh.VertexCount) * vertexStride };
+        sections[entry.IndexSection] = { MeshCacheSectionType::Indices, 0, 0,
+            static_cast<uint64>(mesh.IndexCount) * MeshOptimizer::GetIndexSize(mesh.IndexType) };
+    }
+    sections[0] = { MeshCacheSectionType::MeshTable, 0, 0, entries.size() * sizeof(MeshCacheEntry) };
+    sections[1] = { MeshCacheSectionType::Lods, 0, 0, lods.size() * sizeof(MeshLod) };
+    sections[2] = { MeshCacheSectionType::Names, 0, 0, names.size() };
+
+    uint64 offset = sizeof(MeshCacheHeader) + sectionCount * sizeof(MeshCacheSection);
+    for (MeshCacheSection& section : sections)
+    {
+        section.Offset = AlignUp(offset, BlobAlignment);
+        offset = section.Offset + section.Size;
+    }
+
+    // The whole file is assembled in memory, the blobs are copied in parallel
+    std::vector<uint8> image(offset, 0);
+    CopyMemory(sections.data(), image.data() + sizeof(MeshCacheHeader), static_cast<uint32>(sections.size() * sizeof(MeshCacheSection)));
+    const auto copySection = [&image](const MeshCacheSection& section, const void* source) {
+        if (section.Size > 0)
+            std::copy_n(static_cast<const uint8*>(source), section.Size, image.begin() + static_cast<std::ptrdiff_t>(section.Offset));
+    };
+    copySection(sections[0], entries.data());
+    copySection(sections[1], lods.data());
+    copySection(sections[2], names.data());
+    JobSystem::GetInstance().ParallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            copySection(sections[entries[i].VertexSection], meshes[i].Vertices);
+            copySection(sections[entries[i].IndexSection], meshes[i].Indices);
+        }
+    });
+
+    MeshCacheHeader header;
+    header.FileSize = image.size();
+    header.LayoutSignature = layoutSignature;
+    header.SectionCount = sectionCount;
+    header.MeshCount = static_cast<uint32>(meshes.size());
+    header.ContentHash = HashContent(std::span<const uint8>(image).subspan(sizeof(MeshCacheHeader)));
+    CopyMemory(&header, image.data(), sizeof(header));
+
+    // Readers never see a half-written file: the data goes to a temporary file that replaces the cache at the end
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size())))
+            return Fail(temporaryPath, "WRITE_FAILED");
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryPath, path, errorCode);
+    if (errorCode)
+    {
+        std::filesystem::remove(temporaryPath, errorCode);
+        return Fail(path, "WRITE_FAILED");
+    }
+    return true;
+}
+
+std::filesystem::path MeshCacheFile::GetCachePath(const std::filesystem::path& source)
+{
+    std::filesystem::path cachePath = source;
+    cachePath += ".meshcache";
+    return cachePath;
+}
+
+bool MeshCacheFile::IsUpToDate(const std::filesystem::path& source, const std::filesystem::path& cachePath)
+{
+    std::error_code errorCode;
+    const std::filesystem::file_time_type cacheTime = std::filesystem::last_write_time(cachePath, errorCode);
+    if (errorCode)
+        return false;
+    const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(source, errorCode);
+    return !errorCode && cacheTime >= sourceTime;
+}
@@ -0,0 +1,1146 @@
+#include "MeshImporter.h"
+#include "JobSystem.h"
+#include "Json.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    // Bytes of OBJ text parsed by one job; lines are never split, chunks end at the next line break
+    constexpr size_t ObjChunkSize = 1 << 20;
+
+    // Triangles welded by one job; vertices shared across a slice border are merged again when the slices are stitched
+    constexpr size_t WeldSliceTriangles = 1 << 16;
+
+    // Elements per job for the per-triangle and per-vertex loops of normal and tangent generation
+    constexpr size_t ElementGrain = 1 << 14;
+
+    constexpr uint32 MissingIndex = ~0u;
+
+    template <typename VertexType>
+    constexpr bool HasTangent = requires(VertexType vertex) { vertex.tangent; };
+
+    bool ReadFile(const std::filesystem::path& path, std::vector<char>& data)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            std::cerr << "ERROR::MESH_IMPORTER::FILE_NOT_FOUND " << path.string() << std::endl;
+            return false;
+        }
+
+        const std::streamsize size = file.tellg();
+        file.seekg(0);
+        data.resize(static_cast<size_t>(size));
+        if (!file.read(data.data(), size))
+        {
+            std::cerr << "ERROR::MESH_IMPORTER::FILE_NOT_READ " << path.string() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Triangles around every vertex, as offsets into one flat list
+    struct TriangleAdjacency
+    {
+        std::vector<uint32> Offsets;
+        std::vector<uint32> Triangles;
+    };
+
+    TriangleAdjacency BuildAdjacency(size_t vertexCount, std::span<const uint32> indices)
+    {
+        TriangleAdjacency adjacency;
+        adjacency.Offsets.assign(vertexCount + 1, 0);
+        for (const uint32 index : indices)
+        {
+            ++adjacency.Offsets[index + 1];
+        }
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            adjacency.Offsets[vertex + 1] += adjacency.Offsets[vertex];
+        }
+
+        adjacency.Triangles.resize(indices.size());
+        std::vector<uint32> fill(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            adjacency.Triangles[fill[indices[i]]++] = static_cast<uint32>(i / 3);
+        }
+        return adjacency;
+    }
+
+    // Keeps whole triangles and drops those referencing a vertex that does not exist
+    bool ValidateIndices(std::vector<uint32>& indices, size_t vertexCount)
+    {
+        indices.resize(indices.size() / 3 * 3);
+        const size_t before = indices.size();
+        size_t kept = 0;
+        for (size_t i = 0; i < before; i += 3)
+        {
+            if (indices[i] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount)
+            {
+                std::copy_n(indices.begin() + static_cast<std::ptrdiff_t>(i), 3, indices.begin() + static_cast<std::ptrdiff_t>(kept));
+                kept += 3;
+            }
+        }
+        indices.resize(kept);
+        return kept == before;
+    }
+
+    // Fills in what the file did not provide and prepares the buffers for upload
+    template <typename VertexType>
+    void FinishMesh(ImportedMesh<VertexType>& mesh, bool hasNormals, bool hasTangents, const MeshImporter::Options& options)
+    {
+        if (!hasNormals && options.GenerateNormals)
+        {
+            MeshImporter::GenerateNormals<VertexType>(mesh.Vertices, mesh.Indices);
+        }
+        if constexpr (HasTangent<VertexType>)
+        {
+            // Without texture coordinates every tangent falls back to some direction perpendicular to the normal
+            if (!hasTangents && options.GenerateTangents)
+            {
+                MeshImporter::GenerateTangents(mesh.Vertices, mesh.Indices);
+            }
+        }
+
+        if (options.Optimize && !mesh.Indices.empty())
+        {
+            MeshOptimizer::Result<VertexType> optimized = MeshOptimizer::Optimize<VertexType>(mesh.Vertices, mesh.Indices);
+            mesh.Vertices = std::move(optimized.Vertices);
+            mesh.Indices = std::move(optimized.Indices);
+        }
+        mesh.IndexType = MeshOptimizer::SelectIndexType(mesh.Vertices.size());
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // Wavefront OBJ
+    // -----------------------------------------------------------------------------------------------------------------
+
+    // Indices as resolved inside a chunk: absolute ones are final, relative ones still need the chunk base
+    struct ObjCorner
+    {
+        int64 Position = 0;
+        int64 TexCoord = 0;
+        int64 Normal = 0;
+        uint8 RelativeMask = 0;  // Bit 0 position, 1 texcoord, 2 normal
+        uint8 MissingMask = 0;
+    };
+
+    struct ObjGroup
+    {
+        size_t FirstTriangle = 0;
+        std::string Name;
+    };
+
+    struct ObjChunk
+    {
+        std::vector<glm::vec3> Positions;
+        std::vector<glm::vec2> TexCoords;
+        std::vector<glm::vec3> Normals;
+        std::vector<ObjCorner> Corners;  // Three per triangle, polygons are fanned
+        std::vector<ObjGroup> Groups;    // FirstTriangle is relative to the chunk
+    };
+
+    struct ObjVertexKey
+    {
+        uint32 Position;
+        uint32 TexCoord;
+        uint32 Normal;
+
+        bool operator==(const ObjVertexKey&) const noexcept = default;
+    };
+
+    struct ObjVertexKeyHash
+    {
+        size_t operator()(const ObjVertexKey& key) const noexcept
+        {
+            uint64 hash = key.Position * 0x9E3779B97F4A7C15ull;
+            hash ^= (key.TexCoord + 0x632BE59Bull) * 0xC2B2AE3D27D4EB4Full;
+            hash ^= (key.Normal + 0x85157AF5ull) * 0x165667B19E3779F9ull;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+    };
+
+    const char* SkipSpaces(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+        {
+            ++p;
+        }
+        return p;
+    }
+
+    std::string_view Trim(std::string_view text)
+    {
+        const size_t first = text.find_first_not_of(" \t");
+        if (first == std::string_view::npos)
+            return {};
+        return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+    }
+
+    bool ParseFloat(const char*& p, const char* end, float& value)
+    {
+        p = SkipSpaces(p, end);
+        if (p < end && *p == '+')
+            ++p;
+        const auto [next, result] = std::from_chars(p, end, value);
+        if (result != std::errc())
+            return false;
+        p = next;
+        return true;
+    }
+
+    bool ParseInt(const char*& p, const char* end, int64& value)
+    {
+        const auto [next, result] = std::from_chars(p, end, value);
+        if (result != std::errc())
+            return false;
+        p = next;
+        return true;
+    }
+
+    // One index of a face corner: absolute (1-based) or relative (negative), resolved against the chunk-local count
+    void StoreIndex(int64 written, size_t localCount, int64& index, uint8& relativeMask, uint8 bit)
+    {
+        if (written < 0)
+        {
+            index = static_cast<int64>(localCount) + written;
+            relativeMask |= bit;
+        }
+        else
+        {
+            index = written - 1;
+        }
+    }
+
+    // Parses "v", "v/t", "v//n" or "v/t/n"
+    bool ParseCorner(const char*& p, const char* end, const ObjChunk& chunk, ObjCorner& corner)
+    {
+        int64 position = 0;
+        if (!ParseInt(p, end, position) || position == 0)
+            return false;
+        StoreIndex(position, chunk.Positions.size(), corner.Position, corner.RelativeMask, 1);
+        corner.MissingMask = 2 | 4;
+
+        if (p < end && *p == '/')
+        {
+            ++p;
+            int64 texCoord = 0;
+            if (p < end && *p != '/')
+            {
+                if (!ParseInt(p, end, texCoord) || texCoord == 0)
+                    return false;
+                StoreIndex(texCoord, chunk.TexCoords.size(), corner.TexCoord, corner.RelativeMask, 2);
+                corner.MissingMask &= static_cast<uint8>(~2);
+            }
+
+            if (p < end && *p == '/')
+            {
+                ++p;
+                int64 normal = 0;
+                if (!ParseInt(p, end, normal) || normal == 0)
+                    return false;
+                StoreIndex(normal, chunk.Normals.size(), corner.Normal, corner.RelativeMask, 4);
+                corner.MissingMask &= static_cast<uint8>(~4);
+            }
+        }
+        return true;
+    }
+
+    void ParseObjChunk(const char* p, const char* end, ObjChunk& chunk, std::vector<ObjCorner>& polygon, size_t& errors)
+    {
+        while (p < end)
+        {
+            const char* lineEnd = std::find(p, end, '\n');
+            const char* next = lineEnd < end ? lineEnd + 1 : end;
+            if (lineEnd > p && lineEnd[-1] == '\r')
+                --lineEnd;
+
+            p = SkipSpaces(p, lineEnd);
+            if (p == lineEnd || *p == '#')
+            {
+                p = next;
+                continue;
+            }
+
+            const char* keywordEnd = p;
+            while (keywordEnd < lineEnd && *keywordEnd != ' ' && *keywordEnd != '\t')
+            {
+                ++keywordEnd;
+            }
+            const std::string_view keyword(p, static_cast<size_t>(keywordEnd - p));
+            p = keywordEnd;
+
+            bool valid = true;
+            if (keyword == "v")
+            {
+                glm::vec3& position = chunk.Positions.emplace_back();
+                valid = ParseFloat(p, lineEnd, position.x) && ParseFloat(p, lineEnd, position.y) && ParseFloat(p, lineEnd, position.z);
+            }
+            else if (keyword == "vt")
+            {
+                glm::vec2& texCoord = chunk.TexCoords.emplace_back(0.0f);
+                valid = ParseFloat(p, lineEnd, texCoord.x);
+                ParseFloat(p, lineEnd, texCoord.y);  // Optional, 1D texture coordinates leave it at 0
+            }
+            else if (keyword == "vn")
+            {
+                glm::vec3& normal = chunk.Normals.emplace_back();
+                valid = ParseFloat(p, lineEnd, normal.x) && ParseFloat(p, lineEnd, normal.y) && ParseFloat(p, lineEnd, normal.z);
+            }
+            else if (keyword == "f")
+            {
+                polygon.clear();
+                for (p = SkipSpaces(p, lineEnd); p < lineEnd && valid; p = SkipSpaces(p, lineEnd))
+                {
+                    valid = ParseCorner(p, lineEnd, chunk, polygon.emplace_back());
+                }
+
+                valid = valid && polygon.size() >= 3;
+                for (size_t i = 1; valid && i + 1 < polygon.size(); ++i)
+                {
+                    chunk.Corners.push_back(polygon[0]);
+                    chunk.Corners.push_back(polygon[i]);
+                    chunk.Corners.push_back(polygon[i + 1]);
+                }
+            }
+            else if (keyword == "o" || keyword == "g")
+            {
+                chunk.Groups.push_back({ chunk.Corners.size() / 3, std::string(Trim(std::string_view(p, static_cast<size_t>(lineEnd - p)))) });
+            }
+            // Materials, smoothing groups, lines and points are ignored
+
+            if (!valid)
+                ++errors;
+            p = next;
+        }
+    }
+
+    uint32 ResolveIndex(int64 index, int64 base, size_t count, uint8 relativeMask, uint8 missingMask, uint8 bit)
+    {
+        if ((missingMask & bit) != 0)
+            return MissingIndex;
+
+        const int64 resolved = (relativeMask & bit) != 0 ? base + index : index;
+        return resolved >= 0 && resolved < static_cast<int64>(count) ? static_cast<uint32>(resolved) : MissingIndex;
+    }
+
+    template <typename VertexType>
+    std::vector<ImportedMesh<VertexType>> ImportObj(const std::filesystem::path& path, const MeshImporter::Options& options)
+    {
+        std::vector<char> text;
+        if (!ReadFile(path, text))
+            return {};
+
+        JobSystem& jobs = JobSystem::GetInstance();
+
+        // Chunk borders move forward to the next line break, so every line is parsed by exactly one job
+        std::vector<size_t> borders{ 0 };
+        while (borders.back() < text.size())
+        {
+            const size_t nominal = std::min(borders.back() + ObjChunkSize, text.size());
+            const auto lineBreak = std::find(text.begin() + static_cast<std::ptrdiff_t>(nominal), text.end(), '\n');
+            borders.push_back(lineBreak == text.end() ? text.size() : static_cast<size_t>(lineBreak - text.begin()) + 1);
+        }
+
+        const size_t chunkCount = borders.size() - 1;
+        std::vector<ObjChunk> chunks(chunkCount);
+        std::vector<size_t> chunkErrors(chunkCount, 0);
+        jobs.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+            std::vector<ObjCorner> polygon;
+            for (size_t i = begin; i < end; ++i)
+            {
+                ParseObjChunk(text.data() + borders[i], text.data() + borders[i + 1], chunks[i], polygon, chunkErrors[i]);
+            }
+        });
+
+        // Prefix sums place every chunk in the file-wide arrays
+        struct ChunkBase
+        {
+            size_t Positions = 0;
+            size_t TexCoords = 0;
+            size_t Normals = 0;
+            size_t Triangles = 0;
+        };
+        std::vector<ChunkBase> bases(chunkCount + 1);
+        size_t parseErrors = 0;
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            bases[i + 1].Positions = bases[i].Positions + chunks[i].Positions.size();
+            bases[i + 1].TexCoords = bases[i].TexCoords + chunks[i].TexCoords.size();
+            bases[i + 1].Normals = bases[i].Normals + chunks[i].Normals.size();
+            bases[i + 1].Triangles = bases[i].Triangles + chunks[i].Corners.size() / 3;
+            parseErrors += chunkErrors[i];
+        }
+        if (parseErrors > 0)
+        {
+            std::cerr << "ERROR::MESH_IMPORTER::OBJ_INVALID_LINES " << parseErrors << " in " << path.string() << std::endl;
+        }
+
+        const ChunkBase& totals = bases.back();
+        std::vector<glm::vec3> positions(totals.Positions);
+        std::vector<glm::vec2> texCoords(totals.TexCoords);
+        std::vector<glm::vec3> normals(totals.Normals);
+        std::vector<ObjVertexKey> corners(totals.Triangles * 3);
+        jobs.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const ObjChunk& chunk = chunks[i];
+                const ChunkBase& base = bases[i];
+                std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + static_cast<std::ptrdiff_t>(base.Positions));
+                std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), texCoords.begin() + static_cast<std::ptrdiff_t>(base.TexCoords));
+                std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + static_cast<std::ptrdiff_t>(base.Normals));
+
+                ObjVertexKey* out = corners.data() + base.Triangles * 3;
+                for (const ObjCorner& corner : chunk.Corners)
+                {
+                    *out++ = ObjVertexKey{
+                        ResolveIndex(corner.Position, static_cast<int64>(base.Positions), totals.Positions, corner.RelativeMask, 0, 1),
+                        ResolveIndex(corner.TexCoord, static_cast<int64>(base.TexCoords), totals.TexCoords, corner.RelativeMask, corner.MissingMask, 2),
+                        ResolveIndex(corner.Normal, static_cast<int64>(base.Normals), totals.Normals, corner.RelativeMask, corner.MissingMask, 4)
+                    };
+                }
+            }
+        });
+
+        // Objects and groups split the file into meshes; a group that starts where the previous one starts replaces it
+        std::vector<ObjGroup> groups{ ObjGroup{ 0, path.stem().string() } };
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            for (ObjGroup& group : chunks[i].Groups)
+            {
+                group.FirstTriangle += bases[i].Triangles;
+                if (group.FirstTriangle == groups.back().FirstTriangle)
+                    groups.back().Name = std::move(group.Name);
+                else
+                    groups.push_back(std::move(group));
+            }
+        }
+        chunks.clear();
+        groups.push_back(ObjGroup{ totals.Triangles, {} });
+
+        // Welding: one job per slice of a mesh turns unique position/texcoord/normal triples into vertices
+        struct WeldSlice
+        {
+            size_t Mesh = 0;
+            size_t FirstTriangle = 0;
+            size_t LastTriangle = 0;
+            std::vector<VertexType> Vertices;
+            std::vector<ObjVertexKey> Keys;  // Of every vertex, to find the ones the next slices share
+            std::vector<uint32> Indices;
+            bool HasNormals = true;
+            bool Valid = true;
+        };
+        std::vector<WeldSlice> slices;
+        for (size_t mesh = 0; mesh + 1 < groups.size(); ++mesh)
+        {
+            for (size_t first = groups[mesh].FirstTriangle; first < groups[mesh + 1].FirstTriangle; first += WeldSliceTriangles)
+            {
+                WeldSlice& slice = slices.emplace_back();
+                slice.Mesh = mesh;
+                slice.FirstTriangle = first;
+                slice.LastTriangle = std::min(first + WeldSliceTriangles, groups[mesh + 1].FirstTriangle);
+            }
+        }
+
+        jobs.ParallelFor(slices.size(), 1, [&](size_t begin, size_t end) {
+            std::unordered_map<ObjVertexKey, uint32, ObjVertexKeyHash> vertexIndices;
+            for (size_t s = begin; s < end; ++s)
+            {
+                WeldSlice& slice = slices[s];
+                vertexIndices.clear();
+                slice.Indices.reserve((slice.LastTriangle - slice.FirstTriangle) * 3);
+                for (size_t triangle = slice.FirstTriangle; triangle < slice.LastTriangle; ++triangle)
+                {
+                    const ObjVertexKey* triangleCorners = &corners[triangle * 3];
+                    if (triangleCorners[0].Position == MissingIndex || triangleCorners[1].Position == MissingIndex
+                        || triangleCorners[2].Position == MissingIndex)
+                    {
+                        slice.Valid = false;
+                        continue;
+                    }
+
+                    for (size_t c = 0; c < 3; ++c)
+                    {
+                        const ObjVertexKey& key = triangleCorners[c];
+                        const auto [it, inserted] = vertexIndices.try_emplace(key, static_cast<uint32>(slice.Vertices.size()));
+                        if (inserted)
+                        {
+                            slice.Keys.push_back(key);
+                            VertexType& vertex = slice.Vertices.emplace_back();
+                            vertex.pos = positions[key.Position];
+                            vertex.normal = key.Normal != MissingIndex ? normals[key.Normal] : glm::vec3(0.0f);
+                            vertex.uv = key.TexCoord != MissingIndex ? texCoords[key.TexCoord] : glm::vec2(0.0f);
+                            if constexpr (HasTangent<VertexType>)
+                            {
+                                vertex.tangent = glm::vec3(0.0f);
+                            }
+                            slice.HasNormals = slice.HasNormals && key.Normal != MissingIndex;
+                        }
+                        slice.Indices.push_back(it->second);
+                    }
+                }
+            }
+        });
+
+        // Meshes are stitched from their slices and finished in parallel. Keys seen in an earlier slice map to the vertex
+        // already stitched, so every triple ends up as one vertex, exactly as a single weld pass would make it, and the
+        // generated normals and tangents sum over all of its triangles instead of stopping at the slice border.
+        std::vector<ImportedMesh<VertexType>> meshes(groups.size() - 1);
+        std::vector<size_t> firstSlice(meshes.size() + 1, slices.size());
+        for (size_t s = slices.size(); s-- > 0;)
+        {
+            firstSlice[slices[s].Mesh] = s;
+        }
+        for (size_t mesh = meshes.size(); mesh-- > 0;)
+        {
+            firstSlice[mesh] = std::min(firstSlice[mesh], firstSlice[mesh + 1]);
+        }
+
+        bool invalidFaces = false;
+        for (const WeldSlice& slice : slices)
+        {
+            invalidFaces = invalidFaces || !slice.Valid;
+        }
+        if (invalidFaces)
+        {
+            std::cerr << "ERROR::MESH_IMPORTER::OBJ_INDEX_OUT_OF_RANGE faces skipped in " << path.string() << std::endl;
+        }
+
+        jobs.ParallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; ++m)
+            {
+                ImportedMesh<VertexType>& mesh = meshes[m];
+                mesh.Name = groups[m].Name;
+
+                bool hasNormals = true;
+                std::unordered_map<ObjVertexKey, uint32, ObjVertexKeyHash> vertexIndices;
+                std::vector<uint32> remap;
+                for (size_t s = firstSlice[m]; s < firstSlice[m + 1]; ++s)
+                {
+                    WeldSlice& slice = slices[s];
+                    hasNormals = hasNormals && slice.HasNormals;
+                    if (firstSlice[m + 1] - firstSlice[m] == 1)
+                    {
+                        mesh.Vertices = std::move(slice.Vertices);
+                        mesh.Indices = std::move(slice.Indices);
+                        break;
+                    }
+
+                    remap.resize(slice.Vertices.size());
+                    for (size_t v = 0; v < slice.Vertices.size(); ++v)
+                    {
+                        const auto [it, inserted] = vertexIndices.try_emplace(slice.Keys[v], static_cast<uint32>(mesh.Vertices.size()));
+                        if (inserted)
+                        {
+                            mesh.Vertices.push_back(slice.Vertices[v]);
+                        }
+                        remap[v] = it->second;
+                    }
+                    for (const uint32 index : slice.Indices)
+                    {
+                        mesh.Indices.push_back(remap[index]);
+                    }
+                    std::vector<VertexType>().swap(slice.Vertices);
+                    std::vector<ObjVertexKey>().swap(slice.Keys);
+                    std::vector<uint32>().swap(slice.Indices);
+                }
+
+                FinishMesh(mesh, hasNormals, false, options);
+            }
+        });
+
+        std::erase_if(meshes, [](const ImportedMesh<VertexType>& mesh) { return mesh.Indices.empty(); });
+        return meshes;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // glTF 2.0
+    // -----------------------------------------------------------------------------------------------------------------
+
+    constexpr uint32 GlbMagic = 0x46546C67;      // "glTF"
+    constexpr uint32 GlbChunkJson = 0x4E4F534A;  // "JSON"
+    constexpr uint32 GlbChunkBin = 0x004E4942;   // "BIN\0"
+
+    constexpr uint32 GltfByte = 5120;
+    constexpr uint32 GltfUnsignedByte = 5121;
+    constexpr uint32 GltfShort = 5122;
+    constexpr uint32 GltfUnsignedShort = 5123;
+    constexpr uint32 GltfUnsignedInt = 5125;
+    constexpr uint32 GltfFloat = 5126;
+    constexpr uint32 GltfTriangles = 4;
+
+    // Elements of an accessor inside a loaded buffer, Data is null for accessors without a buffer view (all zeros)
+    struct AccessorView
+    {
+        const uint8* Data = nullptr;
+        size_t Count = 0;
+        size_t Stride = 0;
+        uint32 ComponentType = 0;
+        uint32 Components = 0;
+        bool Normalized = false;
+    };
+
+    uint32 ReadUint32(const std::vector<char>& data, size_t offset)
+    {
+        uint32 value = 0;
+        CopyMemory(data.data() + offset, &value, sizeof(value));
+        return value;
+    }
+
+    bool DecodeBase64(std::string_view text, std::vector<uint8>& out)
+    {
+        const auto decode = [](char c) -> int32 {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+' || c == '-') return 62;
+            if (c == '/' || c == '_') return 63;
+            return -1;
+        };
+
+        out.clear();
+        out.reserve(text.size() / 4 * 3);
+        uint32 bits = 0;
+        uint32 bitCount = 0;
+        for (const char c : text)
+        {
+            if (c == '=')
+                break;
+            const int32 value = decode(c);
+            if (value < 0)
+                return false;
+
+            bits = (bits << 6) | static_cast<uint32>(value);
+            bitCount += 6;
+            if (bitCount >= 8)
+            {
+                bitCount -= 8;
+                out.push_back(static_cast<uint8>(bits >> bitCount));
+            }
+        }
+        return true;
+    }
+
+    std::string DecodeUri(std::string_view uri)
+    {
+        std::string path;
+        for (size_t i = 0; i < uri.size(); ++i)
+        {
+            uint32 value = 0;
+            if (uri[i] == '%' && i + 2 < uri.size() && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ptr == uri.data() + i + 3)
+            {
+                path += static_cast<char>(value);
+                i += 2;
+            }
+            else
+            {
+                path += uri[i];
+            }
+        }
+        return path;
+    }
+
+    uint32 ComponentSize(uint32 componentType)
+    {
+        switch (componentType)
+        {
+        case GltfByte:
+        case GltfUnsignedByte:
+            return 1;
+        case GltfShort:
+        case GltfUnsignedShort:
+            return 2;
+        case GltfUnsignedInt:
+        case GltfFloat:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    uint32 ComponentCount(std::string_view type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    // Element `index` of a top-level array like "accessors", null if the index is missing or out of range
+    const JsonValue& GetIndexed(const JsonValue& gltf, std::string_view array, const JsonValue& index)
+    {
+        const double value = index.GetNumber(-1.0);
+        return gltf[array][value >= 0.0 ? static_cast<size_t>(value) : gltf[array].Size()];
+    }
+
+    bool GetAccessor(const JsonValue& gltf, const std::vector<std::vector<uint8>>& buffers, const JsonValue& accessorIndex,
+        AccessorView& view, std::string& error)
+    {
+        const JsonValue& accessor = GetIndexed(gltf, "accessors", accessorIndex);
+        if (!accessor.IsObject())
+        {
+            error = "missing accessor";
+            return false;
+        }
+        if (accessor.Find("sparse") != nullptr)
+        {
+            error = "sparse accessors are not supported";
+            return false;
+        }
+
+        view.Count = static_cast<size_t>(accessor["count"].GetNumber());
+        view.ComponentType = static_cast<uint32>(accessor["componentType"].GetNumber());
+        view.Components = ComponentCount(accessor["type"].GetString());
+        view.Normalized = accessor["normalized"].GetBool();
+        const size_t elementSize = static_cast<size_t>(ComponentSize(view.ComponentType)) * view.Components;
+        if (elementSize == 0)
+        {
+            error = "unsupported accessor type";
+            return false;
+        }
+
+        const JsonValue* bufferViewIndex = accessor.Find("bufferView");
+        if (bufferViewIndex == nullptr)
+            return true;
+
+        const JsonValue& bufferView = GetIndexed(gltf, "bufferViews", *bufferViewIndex);
+        const double bufferIndex = bufferView["buffer"].GetNumber(-1.0);
+        if (!bufferView.IsObject() || bufferIndex < 0.0 || bufferIndex >= static_cast<double>(buffers.size()))
+        {
+            error = "missing buffer view";
+            return false;
+        }
+
+        const size_t viewOffset = static_cast<size_t>(bufferView["byteOffset"].GetNumber());
+        const size_t viewLength = static_cast<size_t>(bufferView["byteLength"].GetNumber());
+        const size_t accessorOffset = static_cast<size_t>(accessor["byteOffset"].GetNumber());
+        view.Stride = static_cast<size_t>(bufferView["byteStride"].GetNumber(static_cast<double>(elementSize)));
+
+        const std::vector<uint8>& buffer = buffers[static_cast<size_t>(bufferIndex)];
+        const size_t lastByte = view.Count > 0 ? accessorOffset + view.Stride * (view.Count - 1) + elementSize : 0;
+        if (viewOffset + viewLength > buffer.size() || lastByte > viewLength)
+        {
+            error = "accessor outside of its buffer";
+            return false;
+        }
+
+        view.Data = buffer.data() + viewOffset + accessorOffset;
+        return true;
+    }
+
+    float ReadComponent(const AccessorView& view, size_t element, uint32 component)
+    {
+        if (view.Data == nullptr || component >= view.Components)
+            return 0.0f;
+
+        const uint8* data = view.Data + element * view.Stride + component * ComponentSize(view.ComponentType);
+        switch (view.ComponentType)
+        {
+        case GltfFloat:
+        {
+            float value;
+            CopyMemory(data, &value, sizeof(value));
+            return value;
+        }
+        case GltfUnsignedByte:
+            return view.Normalized ? *data / 255.0f : static_cast<float>(*data);
+        case GltfByte:
+        {
+            const float value = static_cast<float>(static_cast<int8>(*data));
+            return view.Normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case GltfUnsignedShort:
+        {
+            uint16 value;
+            CopyMemory(data, &value, sizeof(value));
+            return view.Normalized ? value / 65535.0f : static_cast<float>(value);
+        }
+        case GltfShort:
+        {
+            int16 value;
+            CopyMemory(data, &value, sizeof(value));
+            return view.Normalized ? std::max(value / 32767.0f, -1.0f) : static_cast<float>(value);
+        }
+        case GltfUnsignedInt:
+        {
+            uint32 value;
+            CopyMemory(data, &value, sizeof(value));
+            return static_cast<float>(value);
+        }
+        default:
+            return 0.0f;
+        }
+    }
+
+    uint32 ReadIndex(const AccessorView& view, size_t element)
+    {
+        if (view.Data == nullptr)
+            return 0;
+
+        const uint8* data = view.Data + element * view.Stride;
+        switch (view.ComponentType)
+        {
+        case GltfUnsignedByte:
+            return *data;
+        case GltfUnsignedShort:
+        {
+            uint16 value;
+            CopyMemory(data, &value, sizeof(value));
+            return value;
+        }
+        case GltfUnsignedInt:
+        {
+            uint32 value;
+            CopyMemory(data, &value, sizeof(value));
+            return value;
+        }
+        default:
+            return MissingIndex;
+        }
+    }
+
+    glm::vec3 ReadVec3(const AccessorView& view, size_t element)
+    {
+        return glm::vec3(ReadComponent(view, element, 0), ReadComponent(view, element, 1), ReadComponent(view, element, 2));
+    }
+
+    // Reads the document and every buffer it references; buffers are loaded in parallel
+    bool LoadGltf(const std::filesystem::path& path, JsonValue& gltf, std::vector<std::vector<uint8>>& buffers)
+    {
+        std::vector<char> file;
+        if (!ReadFile(path, file))
+            return false;
+
+        // Binary glTF: a 12 byte header, then a JSON chunk and an optional binary chunk
+        std::string_view jsonText(file.data(), file.size());
+        std::vector<uint8> binaryChunk;
+        bool hasBinaryChunk = false;
+        if (file.size() >= 12 && ReadUint32(file, 0) == GlbMagic)
+        {
+            size_t offset = 12;
+            jsonText = {};
+            while (offset + 8 <= file.size())
+            {
+                const size_t length = ReadUint32(file, offset);
+                const uint32 type = ReadUint32(file, offset + 4);
+                if (offset + 8 + length > file.size())
+                    break;
+
+                if (type == GlbChunkJson && jsonText.empty())
+                {
+                    jsonText = std::string_view(file.data() + offset + 8, length);
+                }
+                else if (type == GlbChunkBin && !hasBinaryChunk)
+                {
+                    binaryChunk.assign(file.begin() + static_cast<std::ptrdiff_t>(offset + 8),
+                        file.begin() + static_cast<std::ptrdiff_t>(offset + 8 + length));
+                    hasBinaryChunk = true;
+                }
+                offset += 8 + length;
+            }
+        }
+
+        std::string error;
+        if (!JsonValue::Parse(jsonText, gltf, error))
+        {
+            std::cerr << "ERROR::MESH_IMPORTER::GLTF_INVALID_JSON " << path.string() << ": " << error << std::endl;
+            return false;
+        }
+
+        const JsonValue& bufferList = gltf["buffers"];
+        buffers.resize(bufferList.Size());
+        std::vector<std::string> errors(buffers.size());
+        JobSystem::GetInstance().ParallelFor(buffers.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const JsonValue& buffer = bufferList[i];
+                const JsonValue* uri = buffer.Find("uri");
+                if (uri == nullptr)
+                {
+                    // Only the first buffer of a .glb may omit the uri, it is the binary chunk
+                    if (i == 0 && hasBinaryChunk)
+                        buffers[i] = std::move(binaryChunk);
+                    else
+                        errors[i] = "buffer without uri";
+                }
+                else if (uri->GetString().starts_with("data:"))
+                {
+                    const std::string_view data = uri->GetString();
+                    const size_t comma = data.find(',');
+                    if (comma == std::string_view::npos || data.substr(0, comma).find(";base64") == std::string_view::npos
+                        || !DecodeBase64(data.substr(comma + 1), buffers[i]))
+                    {
+                        errors[i] = "invalid data uri";
+                    }
+                }
+                else
+                {
+                    std::vector<char> data;
+                    if (ReadFile(path.parent_path() / DecodeUri(uri->GetString()), data))
+                        buffers[i].assign(data.begin(), data.end());
+                    else
+                        errors[i] = "cannot read " + uri->GetString();
+                }
+
+                if (errors[i].empty() && buffers[i].size() < static_cast<size_t>(buffer["byteLength"].GetNumber()))
+                {
+                    errors[i] = "buffer shorter than its byteLength";
+                }
+            }
+        });
+
+        bool valid = true;
+        for (size_t i = 0; i < errors.size(); ++i)
+        {
+            if (!errors[i].empty())
+            {
+                std::cerr << "ERROR::MESH_IMPORTER::GLTF_BUFFER " << i << " in " << path.string() << ": " << errors[i] << std::endl;
+                valid = false;
+            }
+        }
+        return valid;
+    }
+
+    template <typename VertexType>
+    bool DecodePrimitive(const JsonValue& gltf, const std::vector<std::vector<uint8>>& buffers, const JsonValue& primitive,
+        ImportedMesh<VertexType>& mesh, const MeshImporter::Options& options, std::string& error)
+    {
+        if (static_cast<uint32>(primitive["mode"].GetNumber(GltfTriangles)) != GltfTriangles)
+        {
+            error = "only triangle lists are supported";
+            return false;
+        }
+
+        const JsonValue& attributes = primitive["attributes"];
+        AccessorView positions;
+        if (!GetAccessor(gltf, buffers, attributes["POSITION"], positions, error))
+            return false;
+
+        // Optional attributes must match the vertex count, otherwise they are generated
+        const auto optionalAccessor = [&](std::string_view name, AccessorView& view) {
+            const JsonValue* index = attributes.Find(name);
+            std::string ignored;
+            return index != nullptr && GetAccessor(gltf, buffers, *index, view, ignored) && view.Count == positions.Count;
+        };
+        AccessorView normals;
+        AccessorView texCoords;
+        AccessorView tangents;
+        const bool hasNormals = optionalAccessor("NORMAL", normals);
+        const bool hasTexCoords = optionalAccessor("TEXCOORD_0", texCoords);
+        const bool hasTangents = HasTangent<VertexType> && optionalAccessor("TANGENT", tangents);
+
+        mesh.Vertices.resize(positions.Count);
+        for (size_t i = 0; i < positions.Count; ++i)
+        {
+            VertexType& vertex = mesh.Vertices[i];
+            vertex.pos = ReadVec3(positions, i);
+            vertex.normal = hasNormals ? ReadVec3(normals, i) : glm::vec3(0.0f);
+
+            // glTF puts the texture origin at the top left
+            vertex.uv = hasTexCoords ? glm::vec2(ReadComponent(texCoords, i, 0), 1.0f - ReadComponent(texCoords, i, 1)) : glm::vec2(0.0f);
+            if constexpr (HasTangent<VertexType>)
+            {
+                vertex.tangent = hasTangents ? ReadVec3(tangents, i) : glm::vec3(0.0f);
+            }
+        }
+
+        if (const JsonValue* indexAccessor = primitive.Find("indices"))
+        {
+            AccessorView indices;
+            if (!GetAccessor(gltf, buffers, *indexAccessor, indices, error))
+                return false;
+            if (indices.Components != 1 || indices.ComponentType == GltfFloat)
+            {
+                error = "invalid index accessor";
+                return false;
+            }
+
+            mesh.Indices.resize(indices.Count);
+            for (size_t i = 0; i < indices.Count; ++i)
+            {
+                mesh.Indices[i] = ReadIndex(indices, i);
+            }
+        }
+        else
+        {
+            mesh.Indices.resize(positions.Count);
+            for (size_t i = 0; i < positions.Count; ++i)
+            {
+                mesh.Indices[i] = static_cast<uint32>(i);
+            }
+        }
+
+        if (!ValidateIndices(mesh.Indices, mesh.Vertices.size()))
+        {
+            error = "triangles referencing missing vertices were skipped";
+        }
+
+        FinishMesh(mesh, hasNormals, hasTangents, options);
+        return true;
+    }
+
+    template <typename VertexType>
+    std::vector<ImportedMesh<VertexType>> ImportGltf(const std::filesystem::path& path, const MeshImporter::Options& options)
+    {
+        JsonValue gltf;
+        std::vector<std::vector<uint8>> buffers;
+        if (!LoadGltf(path, gltf, buffers))
+            return {};
+
+        // Every primitive becomes one mesh and one job
+        struct PrimitiveJob
+        {
+            const JsonValue* Primitive = nullptr;
+            std::string Name;
+            std::string Error;
+            bool Valid = false;
+        };
+        std::vector<PrimitiveJob> primitives;
+        const JsonValue& meshList = gltf["meshes"];
+        for (size_t m = 0; m < meshList.Size(); ++m)
+        {
+            const JsonValue& mesh = meshList[m];
+            const std::string meshName = mesh["name"].IsString() ? mesh["name"].GetString() : "Mesh" + std::to_string(m);
+            const JsonValue& primitiveList = mesh["primitives"];
+            for (size_t p = 0; p < primitiveList.Size(); ++p)
+            {
+                PrimitiveJob& job = primitives.emplace_back();
+                job.Primitive = &primitiveList[p];
+                job.Name = primitiveList.Size() > 1 ? meshName + "/" + std::to_string(p) : meshName;
+            }
+        }
+
+        std::vector<ImportedMesh<VertexType>> meshes(primitives.size());
+        JobSystem::GetInstance().ParallelFor(primitives.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                meshes[i].Name = primitives[i].Name;
+                primitives[i].Valid = DecodePrimitive(gltf, buffers, *primitives[i].Primitive, meshes[i], options, primitives[i].Error);
+            }
+        });
+
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            if (!primitives[i].Error.empty())
+            {
+                std::cerr << "ERROR::MESH_IMPORTER::GLTF_PRIMITIVE " << primitives[i].Name << " in " << path.string() << ": "
+                    << primitives[i].Error << std::endl;
+            }
+            if (!primitives[i].Valid)
+                meshes[i].Indices.clear();
+        }
+
+        std::erase_if(meshes, [](const ImportedMesh<VertexType>& mesh) { return mesh.Indices.empty(); });
+        return meshes;
+    }
+}
+
+template <ImportableVertex VertexType>
+std::vector<ImportedMesh<VertexType>> MeshImporter::Import(const std::filesystem::path& path, const Options& options)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".obj")
+        return ImportObj<VertexType>(path, options);
+    if (extension == ".gltf" || extension == ".glb")
+        return ImportGltf<VertexType>(path, options);
+
+    std::cerr << "ERROR::MESH_IMPORTER::UNKNOWN_FORMAT " << path.string() << std::endl;
+    return {};
+}
+
+template <ImportableVertex VertexType>
+void MeshImporter::GenerateNormals(std::span<VertexType> vertices, std::span<const uint32> indices)
+{
+    JobSystem& jobs = JobSystem::GetInstance();
+
+    // The cross product is twice the triangle area along the normal, so larger triangles weigh more
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    jobs.ParallelFor(triangleCount, ElementGrain, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t)
+        {
+            const glm::vec3& a = vertices[indices[t * 3]].pos;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].pos;
+            const glm::vec3& c = vertices[indices[t * 3 + 2]].pos;
+            faceNormals[t] = glm::cross(b - a, c - a);
+        }
+    });
+
+    const TriangleAdjacency adjacency = BuildAdjacency(vertices.size(), indices);
+    jobs.ParallelFor(vertices.size(), ElementGrain, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+        {
+            glm::vec3 sum(0.0f);
+            for (uint32 i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; ++i)
+            {
+                sum += faceNormals[adjacency.Triangles[i]];
+            }
+            const float length = glm::length(sum);
+            vertices[v].normal = length > 0.0f ? sum / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    });
+}
+
+void MeshImporter::GenerateTangents(std::span<VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices)
+{
+    JobSystem& jobs = JobSystem::GetInstance();
+
+    // Direction of +u on every triangle, scaled by its area so small slivers do not dominate
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<glm::vec3> faceTangents(triangleCount);
+    jobs.ParallelFor(triangleCount, ElementGrain, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t)
+        {
+            const VertexPosNormalTangentUV3D& a = vertices[indices[t * 3]];
+            const VertexPosNormalTangentUV3D& b = vertices[indices[t * 3 + 1]];
+            const VertexPosNormalTangentUV3D& c = vertices[indices[t * 3 + 2]];
+            const glm::vec3 edge1 = b.pos - a.pos;
+            const glm::vec3 edge2 = c.pos - a.pos;
+            const glm::vec2 deltaUV1 = b.uv - a.uv;
+            const glm::vec2 deltaUV2 = c.uv - a.uv;
+
+            const float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+            const glm::vec3 tangent = edge1 * deltaUV2.y - edge2 * deltaUV1.y;
+            faceTangents[t] = determinant < 0.0f ? -tangent : tangent;
+        }
+    });
+
+    const TriangleAdjacency adjacency = BuildAdjacency(vertices.size(), indices);
+    jobs.ParallelFor(vertices.size(), ElementGrain, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v)
+        {
+            glm::vec3 sum(0.0f);
+            for (uint32 i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; ++i)
+            {
+                sum += faceTangents[adjacency.Triangles[i]];
+            }
+
+            // Gram-Schmidt against the normal; without a usable uv gradient any perpendicular direction will do
+            const glm::vec3& normal = vertices[v].normal;
+            glm::vec3 tangent = sum - normal * glm::dot(normal, sum);
+            float length = glm::length(tangent);
+            if (length <= 1e-12f)
+            {
+                tangent = glm::cross(normal, std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+                length = glm::length(tangent);
+            }
+            vertices[v].tangent = length > 0.0f ? tangent / length : glm::vec3(1.0f, 0.0f, 0.0f);
+        }
+    });
+}
+
+template std::vector<ImportedMesh<VertexPosNormalTangentUV3D>> MeshImporter::Import<VertexPosNormalTangentUV3D>(const std::filesystem::path&, const Options&);
+template std::vector<ImportedMesh<VertexPosNormalUV3D>> MeshImporter::Import<VertexPosNormalUV3D>(const std::filesystem::path&, const Options&);
+template void MeshImporter::GenerateNormals<VertexPosNormalTangentUV3D>(std::span<VertexPosNormalTangentUV3D>, std::span<const uint32>);
+template void MeshImporter::GenerateNormals<VertexPosNormalUV3D>(std::span<VertexPosNormalUV3D>, std::span<const uint32>);
@@ -0,0 +1,382 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace
+{
+    // Scoring constants from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    constexpr uint32 ForsythCacheSize = 32;
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.0f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    constexpr uint32 InvalidTriangle = ~0u;
+
+    float VertexScore(int32 cachePosition, uint32 remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // The vertices of the last triangle get a fixed score, so the next triangle does not reuse all of them
+            if (cachePosition < 3)
+            {
+                score = LastTriangleScore;
+            }
+            else
+            {
+                const float scale = 1.0f / static_cast<float>(ForsythCacheSize - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, CacheDecayPower);
+            }
+        }
+
+        // Vertices with few triangles left are finished first, so they do not linger as dead ends
+        return score + ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+    }
+
+    // FIFO post-transform cache: a vertex hits while fewer than Size misses happened since its own
+    class FifoCache
+    {
+    public:
+        FifoCache(uint32 vertexCount, uint32 size)
+            : Timestamps(vertexCount, 0)
+            , Time(size + 1)
+            , Size(size)
+        {
+        }
+
+        // Returns true on a miss
+        bool Access(uint32 vertex)
+        {
+            if (Time - Timestamps[vertex] <= Size)
+                return false;
+
+            Timestamps[vertex] = Time++;
+            return true;
+        }
+
+        void Flush() { Time += Size + 1; }
+
+    private:
+        std::vector<uint32> Timestamps;
+        uint32 Time;
+        uint32 Size;
+    };
+
+    uint32 AccessTriangle(FifoCache& cache, std::span<const uint32> indices, size_t triangle)
+    {
+        uint32 misses = 0;
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            misses += cache.Access(indices[triangle * 3 + corner]) ? 1u : 0u;
+        }
+        return misses;
+    }
+
+    uint32 MaxIndex(std::span<const uint32> indices)
+    {
+        uint32 maxIndex = 0;
+        for (const uint32 index : indices)
+        {
+            maxIndex = std::max(maxIndex, index);
+        }
+        return maxIndex;
+    }
+
+    // Cuts a cluster after every prefix whose ACMR stays under the threshold, so each piece is a
+    // cache-friendly patch of its own and reordering the pieces costs at most `threshold` in ACMR
+    // `cache` is shared between calls and flushed here, so no vertex-sized array is allocated per cluster
+    void SplitCluster(std::span<const uint32> indices, FifoCache& cache, float threshold, size_t first, size_t last,
+        std::vector<size_t>& clusters)
+    {
+        cache.Flush();
+        uint32 clusterMisses = 0;
+        for (size_t triangle = first; triangle < last; ++triangle)
+        {
+            clusterMisses += AccessTriangle(cache, indices, triangle);
+        }
+        const float maxAcmr = threshold * static_cast<float>(clusterMisses) / static_cast<float>(last - first);
+
+        cache.Flush();
+        clusters.push_back(first);
+        uint32 misses = 0;
+        size_t start = first;
+        for (size_t triangle = first; triangle < last; ++triangle)
+        {
+            misses += AccessTriangle(cache, indices, triangle);
+            const float acmr = static_cast<float>(misses) / static_cast<float>(triangle - start + 1);
+            if (acmr <= maxAcmr && triangle + 1 < last)
+            {
+                start = triangle + 1;
+                clusters.push_back(start);
+                misses = 0;
+                cache.Flush();
+            }
+        }
+    }
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(std::span<const uint32> indices, uint32 vertexCount, uint32 cacheSize)
+{
+    VertexCacheStats stats;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return stats;
+
+    vertexCount = std::max(vertexCount, MaxIndex(indices) + 1);
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint8> referenced(vertexCount, 0);
+    uint32 referencedCount = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        stats.VerticesTransformed += AccessTriangle(cache, indices, triangle);
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            uint8& seen = referenced[indices[triangle * 3 + corner]];
+            referencedCount += seen == 0 ? 1u : 0u;
+            seen = 1;
+        }
+    }
+
+    stats.ACMR = static_cast<float>(stats.VerticesTransformed) / static_cast<float>(triangleCount);
+    stats.ATVR = static_cast<float>(stats.VerticesTransformed) / static_cast<float>(referencedCount);
+    return stats;
+}
+
+std::vector<uint32> MeshOptimizer::OptimizeVertexCache(std::span<const uint32> indices, uint32 vertexCount)
+{
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<uint32> result;
+    result.reserve(triangleCount * 3);
+    if (triangleCount == 0)
+        return result;
+
+    vertexCount = std::max(vertexCount, MaxIndex(indices) + 1);
+
+    // Triangles of every vertex, emitted ones are swapped behind the remaining ones
+    std::vector<uint32> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        ++remaining[indices[i]];
+    }
+    std::vector<uint32> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remaining[vertex];
+    }
+    std::vector<uint32> adjacency(triangleCount * 3);
+    std::vector<uint32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        adjacency[fill[indices[i]]++] = static_cast<uint32>(i / 3);
+    }
+
+    std::vector<int32> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        vertexScores[vertex] = VertexScore(-1, remaining[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8> emitted(triangleCount, 0);
+    uint32 bestTriangle = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]]
+            + vertexScores[indices[triangle * 3 + 2]];
+        if (triangleScores[triangle] > triangleScores[bestTriangle])
+            bestTriangle = static_cast<uint32>(triangle);
+    }
+
+    std::vector<uint32> cache;
+    std::vector<uint32> nextCache;
+    cache.reserve(ForsythCacheSize + 3);
+    nextCache.reserve(ForsythCacheSize + 3);
+    size_t scanCursor = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (bestTriangle == InvalidTriangle)
+        {
+            // Dead end: no triangle touches the cache, continue with the next one in input order
+            while (emitted[scanCursor] != 0)
+            {
+                ++scanCursor;
+            }
+            bestTriangle = static_cast<uint32>(scanCursor);
+        }
+
+        const uint32* corners = &indices[bestTriangle * 3];
+        result.insert(result.end(), corners, corners + 3);
+        emitted[bestTriangle] = 1;
+
+        // The triangle's vertices move to the front, the rest keep their order behind them
+        nextCache.assign(corners, corners + 3);
+        for (const uint32 vertex : cache)
+        {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+                nextCache.push_back(vertex);
+        }
+
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32 vertex = corners[corner];
+            uint32* triangles = &adjacency[adjacencyOffsets[vertex]];
+            uint32* last = triangles + remaining[vertex] - 1;
+            *std::find(triangles, last + 1, bestTriangle) = *last;
+            *last = bestTriangle;
+            --remaining[vertex];
+        }
+
+        for (size_t position = 0; position < nextCache.size(); ++position)
+        {
+            const uint32 vertex = nextCache[position];
+            cachePositions[vertex] = position < ForsythCacheSize ? static_cast<int32>(position) : -1;
+            vertexScores[vertex] = VertexScore(cachePositions[vertex], remaining[vertex]);
+        }
+
+        // Only triangles around the touched vertices changed their score
+        bestTriangle = InvalidTriangle;
+        float bestScore = -1.0f;
+        for (const uint32 vertex : nextCache)
+        {
+            const uint32 first = adjacencyOffsets[vertex];
+            for (uint32 i = first; i < first + remaining[vertex]; ++i)
+            {
+                const uint32 triangle = adjacency[i];
+                const float score = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]]
+                    + vertexScores[indices[triangle * 3 + 2]];
+                triangleScores[triangle] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+
+        if (nextCache.size() > ForsythCacheSize)
+        {
+            nextCache.resize(ForsythCacheSize);
+        }
+        std::swap(cache, nextCache);
+    }
+
+    return result;
+}
+
+std::vector<uint32> MeshOptimizer::OptimizeOverdraw(std::span<const uint32> indices, std::span<const glm::vec3> positions,
+    const Options& options)
+{
+    const size_t triangleCount = indices.size() / 3;
+    const uint32 vertexCount = static_cast<uint32>(positions.size());
+    if (triangleCount == 0)
+        return {};
+
+    // Hard boundaries: triangles whose three vertices all miss start a new patch, the cache holds nothing of value there
+    std::vector<size_t> hardClusters;
+    FifoCache cache(vertexCount, options.CacheSize);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (AccessTriangle(cache, indices, triangle) == 3 || triangle == 0)
+            hardClusters.push_back(triangle);
+    }
+    hardClusters.push_back(triangleCount);
+
+    std::vector<size_t> clusters;
+    for (size_t i = 0; i + 1 < hardClusters.size(); ++i)
+    {
+        SplitCluster(indices, cache, options.OverdrawThreshold, hardClusters[i], hardClusters[i + 1], clusters);
+    }
+    clusters.push_back(triangleCount);
+
+    // Area weighted centroid and normal of every cluster; cross products are twice the area along the normal
+    struct ClusterKey
+    {
+        size_t First;
+        size_t Last;
+        float Key;
+    };
+    std::vector<ClusterKey> keys(clusters.size() - 1);
+    std::vector<glm::vec3> centroids(keys.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(keys.size(), glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t cluster = 0; cluster < keys.size(); ++cluster)
+    {
+        float clusterArea = 0.0f;
+        for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+        {
+            const glm::vec3& a = positions[indices[triangle * 3]];
+            const glm::vec3& b = positions[indices[triangle * 3 + 1]];
+            const glm::vec3& c = positions[indices[triangle * 3 + 2]];
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float area = glm::length(normal);
+
+            centroids[cluster] += (a + b + c) * (area / 3.0f);
+            normals[cluster] += normal;
+            clusterArea += area;
+        }
+
+        meshCentroid += centroids[cluster];
+        meshArea += clusterArea;
+        centroids[cluster] = clusterArea > 0.0f ? centroids[cluster] / clusterArea : glm::vec3(0.0f);
+        keys[cluster] = ClusterKey{ clusters[cluster], clusters[cluster + 1], 0.0f };
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+    // Clusters that face away from the center are on the outside and occlude the rest for most views
+    for (size_t cluster = 0; cluster < keys.size(); ++cluster)
+    {
+        const float length = glm::length(normals[cluster]);
+        const glm::vec3 normal = length > 0.0f ? normals[cluster] / length : glm::vec3(0.0f);
+        keys[cluster].Key = glm::dot(centroids[cluster] - meshCentroid, normal);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const ClusterKey& a, const ClusterKey& b) { return a.Key > b.Key; });
+
+    std::vector<uint32> result;
+    result.reserve(triangleCount * 3);
+    for (const ClusterKey& key : keys)
+    {
+        result.insert(result.end(), indices.begin() + key.First * 3, indices.begin() + key.Last * 3);
+    }
+    return result;
+}
+
+std::vector<uint32> MeshOptimizer::OptimizeVertexFetch(std::span<uint32> indices, uint32 vertexCount)
+{
+    std::vector<uint32> remap(vertexCount, UnusedVertex);
+    uint32 nextVertex = 0;
+    for (uint32& index : indices)
+    {
+        if (remap[index] == UnusedVertex)
+            remap[index] = nextVertex++;
+        index = remap[index];
+    }
+    return remap;
+}
+
+void MeshOptimizer::OptimizeLodChain(MeshLodChain& lodChain, uint32 vertexCount)
+{
+    // Level 0 is the index buffer Optimize() already ordered for the cache and for overdraw
+    for (size_t level = 1; level < lodChain.Lods.size(); ++level)
+    {
+        const MeshLod& lod = lodChain.Lods[level];
+        const std::span<uint32> levelIndices(lodChain.Indices.data() + lod.FirstIndex, lod.IndexCount);
+        const std::vector<uint32> optimized = OptimizeVertexCache(levelIndices, vertexCount);
+        std::copy(optimized.begin(), optimized.end(), levelIndices.begin());
+    }
+}
+
+void MeshOptimizer::PrintStats(std::ostream& out, std::string_view name, const VertexCacheStats& before, const VertexCacheStats& after)
+{
+    out << "Mesh optimized: " << name << std::fixed << std::setprecision(3)
+        << " ACMR " << before.ACMR << " -> " << after.ACMR
+        << ", ATVR " << before.ATVR << " -> " << after.ATVR << std::endl;
+}
@@ -0,0 +1,127 @@
+#include "MeshRegistry.h"
+#include "InstanceData.h"
+#include <algorithm>
+#include <cmath>
+
+MeshRegistry::MeshRegistry(VertexPulling vertexPulling)
+{
+    if (vertexPulling == VertexPulling::Enabled)
+    {
+        PullPool = GeometryPool::CreateWordPool();
+        PullFormatBuffer = std::make_unique<ShaderStorageBufferObject>();
+    }
+}
+
+MeshHandle MeshRegistry::Find(std::string_view name) const
+{
+    if (auto it = NameToIndex.find(std::string(name)); it != NameToIndex.end())
+    {
+        return MeshHandle{ it->second };
+    }
+    return MeshHandle{};
+}
+
+float MeshRegistry::GetLodScale(float verticalFovRadians, float viewportHeight)
+{
+    return 0.5f * viewportHeight / std::tan(0.5f * verticalFovRadians);
+}
+
+uint32 MeshRegistry::SelectLod(MeshHandle handle, float distance, float lodScale, float objectScale, float maxPixelError) const
+{
+    const std::vector<MeshLod>& lods = Meshes[handle.Index].Lods;
+
+    // Errors grow with the level, so the first acceptable level from the coarse end is the coarsest one
+    const float pixelsPerUnit = lodScale * objectScale / std::max(distance, 1e-3f);
+    for (size_t lod = lods.size() - 1; lod > 0; --lod)
+    {
+        if (lods[lod].Error * pixelsPerUnit <= maxPixelError)
+            return static_cast<uint32>(lod);
+    }
+    return 0;
+}
+
+const void* MeshRegistry::IndexOffset(const Mesh& mesh, const MeshLod& lod) const
+{
+    const GLintptr firstIndex = static_cast<GLintptr>(mesh.Range.Indices.Offset) + lod.FirstIndex;
+    return reinterpret_cast<const void*>(firstIndex * static_cast<GLintptr>(Pools[mesh.Pool]->GetIndexSize()));
+}
+
+void MeshRegistry::Draw(MeshHandle handle, uint32 lod) const
+{
+    const Mesh& mesh = Meshes[handle.Index];
+    const MeshLod& level = mesh.Lods[lod];
+    const GeometryPool& pool = *Pools[mesh.Pool];
+    pool.Bind();
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(level.IndexCount), pool.GetIndexType(),
+        IndexOffset(mesh, level), static_cast<GLint>(mesh.Range.Vertices.Offset));
+}
+
+void MeshRegistry::DrawInstanced(MeshHandle handle, GLsizei instanceCount, uint32 lod, uint32 baseInstance) const
+{
+    const Mesh& mesh = Meshes[handle.Index];
+    const MeshLod& level = mesh.Lods[lod];
+    const GeometryPool& pool = *Pools[mesh.Pool];
+    pool.Bind();
+    glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(level.IndexCount), pool.GetIndexType(),
+        IndexOffset(mesh, level), instanceCount, static_cast<GLint>(mesh.Range.Vertices.Offset), baseInstance);
+}
+
+DrawElementsIndirectCommand MeshRegistry::MakeIndirectCommand(MeshHandle handle, uint32 baseInstance, uint32 instanceCount, uint32 lod) const
+{
+    const Mesh& mesh = Meshes[handle.Index];
+    const MeshLod& level = mesh.Lods[lod];
+    return DrawElementsIndirectCommand{
+        .count = level.IndexCount,
+        .instanceCount = instanceCount,
+        .firstIndex = mesh.Range.Indices.Offset + level.FirstIndex,
+        .baseVertex = static_cast<int32>(mesh.Range.Vertices.Offset),
+        .baseInstance = baseInstance
+    };
+}
+
+void MeshRegistry::MultiDrawIndirect(MeshHandle handle, GLintptr commandOffset, GLsizei drawCount) const
+{
+    const GeometryPool& pool = *Pools[Meshes[handle.Index].Pool];
+    pool.Bind();
+    glMultiDrawElementsIndirect(GL_TRIANGLES, pool.GetIndexType(), reinterpret_cast<const void*>(commandOffset), drawCount, 0);
+}
+
+DrawElementsIndirectCommand MeshRegistry::MakePulledIndirectCommand(MeshHandle handle, uint32 baseInstance, uint32 instanceCount, uint32 lod) const
+{
+    const Mesh& mesh = Meshes[handle.Index];
+    const MeshLod& level = mesh.Lods[lod];
+    return DrawElementsIndirectCommand{
+        .count = level.IndexCount,
+        .instanceCount = instanceCount,
+        .firstIndex = mesh.PullRange.Indices.Offset + level.FirstIndex,
+        .baseVertex = static_cast<int32>(mesh.PullRange.FirstVertex / PullFormats[mesh.PullFormat].StrideWords),
+        .baseInstance = baseInstance
+    };
+}
+
+void MeshRegistry::MultiDrawIndirectPulled(GLintptr commandOffset, GLsizei drawCount) const
+{
+    PullPool->Bind();
+    PullPool->BindVertexStorage(PULLED_VERTEX_BUFFER_BINDING);
+    PullFormatBuffer->BindBase(VERTEX_FORMAT_BUFFER_BINDING);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, PullPool->GetIndexType(), reinterpret_cast<const void*>(commandOffset), drawCount, 0);
+}
+
+uint32 MeshRegistry::FindPullFormat(std::type_index type, const GPUVertexFormat& format)
+{
+    const auto [it, inserted] = PullFormatIndices.try_emplace(type, static_cast<uint32>(PullFormats.size()));
+    if (inserted)
+    {
+        PullFormats.push_back(format);
+        PullFormatBuffer->UploadData(PullFormats, GL_STATIC_DRAW);
+    }
+    return it->second;
+}
+
+MeshHandle MeshRegistry::CreateMesh(std::string_view name)
+{
+    const uint32 index = static_cast<uint32>(Meshes.size());
+    Meshes.emplace_back();
+    NameToIndex.emplace(std::string(name), index);
+    return MeshHandle{ index };
+}
@@ -0,0 +1,382 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    // Collapses that turn a triangle by more than ~80 degrees fold the surface over
+    constexpr float MinNormalDot = 0.2f;
+
+    constexpr uint32 DeadTriangle = ~0u;
+
+    // Symmetric 4x4 matrix of the summed squared plane distances, with the summed plane weights
+    struct Quadric
+    {
+        double XX = 0.0, XY = 0.0, XZ = 0.0, XW = 0.0;
+        double YY = 0.0, YZ = 0.0, YW = 0.0;
+        double ZZ = 0.0, ZW = 0.0;
+        double WW = 0.0;
+        double Weight = 0.0;
+
+        void AddPlane(double a, double b, double c, double d, double weight)
+        {
+            XX += weight * a * a; XY += weight * a * b; XZ += weight * a * c; XW += weight * a * d;
+            YY += weight * b * b; YZ += weight * b * c; YW += weight * b * d;
+            ZZ += weight * c * c; ZW += weight * c * d;
+            WW += weight * d * d;
+            Weight += weight;
+        }
+
+        void Add(const Quadric& other)
+        {
+            XX += other.XX; XY += other.XY; XZ += other.XZ; XW += other.XW;
+            YY += other.YY; YZ += other.YZ; YW += other.YW;
+            ZZ += other.ZZ; ZW += other.ZW;
+            WW += other.WW;
+            Weight += other.Weight;
+        }
+
+        // Weighted mean of the squared distances from `p` to the planes
+        [[nodiscard]] double MeanSquaredDistance(const glm::vec3& p) const
+        {
+            if (Weight <= 0.0)
+                return 0.0;
+
+            const double x = p.x, y = p.y, z = p.z;
+            const double sum = XX * x * x + YY * y * y + ZZ * z * z + WW
+                + 2.0 * (XY * x * y + XZ * x * z + YZ * y * z + XW * x + YW * y + ZW * z);
+            return std::max(sum, 0.0) / Weight;
+        }
+    };
+
+    struct Collapse
+    {
+        float Cost;
+        uint32 From;  // Removed vertex
+        uint32 To;    // Kept vertex
+    };
+
+    // Mesh prepared for simplification: positions scaled to the unit cube, welded topology and locked vertices
+    struct SimplifyContext
+    {
+        std::vector<glm::vec3> Positions;
+        std::vector<uint32> Canonical;  // First vertex at the same position
+        std::vector<uint8> Locked;
+        std::vector<Quadric> Quadrics;  // Per canonical vertex
+        float Extent = 1.0f;
+    };
+
+    void WeldPositions(std::span<const VertexPosNormalTangentUV3D> vertices, SimplifyContext& context)
+    {
+        const size_t vertexCount = vertices.size();
+        std::vector<uint32> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0u);
+
+        const auto lessPosition = [&](uint32 a, uint32 b) {
+            const glm::vec3& p = vertices[a].pos;
+            const glm::vec3& q = vertices[b].pos;
+            return p.x < q.x || (p.x == q.x && (p.y < q.y || (p.y == q.y && (p.z < q.z || (p.z == q.z && a < b)))));
+        };
+        std::sort(order.begin(), order.end(), lessPosition);
+
+        context.Canonical.resize(vertexCount);
+        context.Locked.assign(vertexCount, 0);
+        for (size_t i = 0; i < vertexCount;)
+        {
+            size_t end = i + 1;
+            while (end < vertexCount && vertices[order[end]].pos == vertices[order[i]].pos)
+                ++end;
+
+            // Several vertices at one position: an attribute seam, collapsing one side would tear it open
+            for (size_t j = i; j < end; ++j)
+            {
+                context.Canonical[order[j]] = order[i];
+                context.Locked[order[j]] = end - i > 1 ? 1 : 0;
+            }
+            i = end;
+        }
+    }
+
+    void LockBorders(std::span<const uint32> indices, SimplifyContext& context)
+    {
+        // Directed edges of the welded mesh, an edge without its reverse lies on a border
+        std::vector<uint64> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t e = 0; e < 3; ++e)
+            {
+                const uint64 a = context.Canonical[indices[i + e]];
+                const uint64 b = context.Canonical[indices[i + (e + 1) % 3]];
+                edges.push_back(a << 32 | b);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            const uint64 edge = edges[i];
+            const uint64 reverse = (edge << 32) | (edge >> 32);
+            const bool duplicate = (i > 0 && edges[i - 1] == edge) || (i + 1 < edges.size() && edges[i + 1] == edge);
+            if (duplicate || !std::binary_search(edges.begin(), edges.end(), reverse))
+            {
+                context.Locked[static_cast<uint32>(edge >> 32)] = 1;
+                context.Locked[static_cast<uint32>(edge)] = 1;
+            }
+        }
+
+        // Lock state belongs to the position, not to one of the vertices sharing it
+        for (size_t v = 0; v < context.Locked.size(); ++v)
+        {
+            if (context.Locked[context.Canonical[v]])
+                context.Locked[v] = 1;
+        }
+    }
+
+    void AccumulateQuadrics(std::span<const uint32> indices, SimplifyContext& context)
+    {
+        context.Quadrics.assign(context.Positions.size(), Quadric{});
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const glm::vec3& p0 = context.Positions[indices[i]];
+            const glm::vec3 normal = glm::cross(context.Positions[indices[i + 1]] - p0, context.Positions[indices[i + 2]] - p0);
+            const float length = std::sqrt(glm::dot(normal, normal));
+            if (length <= 0.0f)
+                continue;
+
+            // Area weighted, so small triangles do not pin their vertices
+            const glm::vec3 n = normal / length;
+            const double area = 0.5 * length;
+            const double d = -static_cast<double>(glm::dot(n, p0));
+            for (size_t k = 0; k < 3; ++k)
+            {
+                context.Quadrics[context.Canonical[indices[i + k]]].AddPlane(n.x, n.y, n.z, d, area);
+            }
+        }
+    }
+
+    float AttributeDistance(const VertexPosNormalTangentUV3D& a, const VertexPosNormalTangentUV3D& b)
+    {
+        const glm::vec3 normal = a.normal - b.normal;
+        const glm::vec2 uv = a.uv - b.uv;
+        return glm::dot(normal, normal) + glm::dot(uv, uv);
+    }
+}
+
+std::vector<uint32> MeshSimplifier::Simplify(std::span<const VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices,
+    size_t targetIndexCount, const Options& options, float* resultError)
+{
+    std::vector<uint32> result(indices.begin(), indices.end());
+    if (resultError)
+        *resultError = 0.0f;
+    if (vertices.empty() || result.size() <= targetIndexCount)
+        return result;
+
+    SimplifyContext context;
+
+    // Errors are measured in the unit cube, so limits and weights do not depend on the mesh scale
+    glm::vec3 minimum = vertices[0].pos, maximum = vertices[0].pos;
+    for (const VertexPosNormalTangentUV3D& vertex : vertices)
+    {
+        minimum = glm::min(minimum, vertex.pos);
+        maximum = glm::max(maximum, vertex.pos);
+    }
+    const glm::vec3 size = maximum - minimum;
+    context.Extent = std::max(std::max(size.x, size.y), std::max(size.z, 1e-6f));
+    context.Positions.resize(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+        context.Positions[v] = (vertices[v].pos - minimum) / context.Extent;
+    }
+
+    WeldPositions(vertices, context);
+    LockBorders(indices, context);
+    AccumulateQuadrics(indices, context);
+
+    const float maxCost = options.MaxError * options.MaxError;
+    double maxDistanceSquared = 0.0;
+
+    std::vector<uint32> adjacencyOffsets;
+    std::vector<uint32> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint8> touched(vertices.size());
+    std::vector<uint32> neighbours;
+
+    size_t triangleCount = result.size() / 3;
+    const size_t targetTriangles = targetIndexCount / 3;
+    while (triangleCount > targetTriangles)
+    {
+        // Triangles around every canonical vertex, rebuilt once per pass
+        adjacencyOffsets.assign(vertices.size() + 1, 0);
+        for (const uint32 index : result)
+            ++adjacencyOffsets[context.Canonical[index] + 1];
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i)
+                adjacency[fill[context.Canonical[result[i]]]++] = static_cast<uint32>(i / 3);
+        }
+        const auto trianglesOf = [&](uint32 canonical) {
+            return std::span<const uint32>(adjacency.data() + adjacencyOffsets[canonical], adjacencyOffsets[canonical + 1] - adjacencyOffsets[canonical]);
+        };
+
+        // Every edge in both directions, cheapest first
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (size_t e = 0; e < 3; ++e)
+            {
+                const uint32 a = result[i + e];
+                const uint32 b = result[i + (e + 1) % 3];
+                for (const auto& [from, to] : { std::pair{ a, b }, std::pair{ b, a } })
+                {
+                    if (context.Locked[from] || context.Canonical[from] == context.Canonical[to])
+                        continue;
+
+                    const double distance = context.Quadrics[from].MeanSquaredDistance(context.Positions[to]);
+                    const float cost = static_cast<float>(distance) + options.AttributeWeight * AttributeDistance(vertices[from], vertices[to]);
+                    collapses.push_back({ cost, from, to });
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t collapsed = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (triangleCount <= targetTriangles || collapse.Cost > maxCost)
+                break;
+
+            // `From` is never on a seam, so it is its own canonical vertex
+            const uint32 from = collapse.From;
+            const uint32 to = context.Canonical[collapse.To];
+            if (touched[from] || touched[to])
+                continue;
+
+            // Link condition: the two vertices may only share the neighbours of their shared triangles
+            neighbours.clear();
+            uint32 sharedTriangles = 0;
+            for (const uint32 triangle : trianglesOf(from))
+            {
+                bool containsTo = false;
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const uint32 vertex = context.Canonical[result[triangle * 3 + k]];
+                    containsTo |= vertex == to;
+                    if (vertex != from && vertex != to)
+                        neighbours.push_back(vertex);
+                }
+                sharedTriangles += containsTo ? 1 : 0;
+            }
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+            uint32 sharedNeighbours = 0;
+            for (const uint32 neighbour : neighbours)
+            {
+                for (const uint32 triangle : trianglesOf(to))
+                {
+                    const uint32* corners = &result[triangle * 3];
+                    if (context.Canonical[corners[0]] == neighbour || context.Canonical[corners[1]] == neighbour || context.Canonical[corners[2]] == neighbour)
+                    {
+                        ++sharedNeighbours;
+                        break;
+                    }
+                }
+            }
+            if (sharedNeighbours != sharedTriangles)
+                continue;
+
+            // Reject collapses that fold a remaining triangle over
+            const glm::vec3& target = context.Positions[collapse.To];
+            bool flips = false;
+            for (const uint32 triangle : trianglesOf(from))
+            {
+                const uint32* corners = &result[triangle * 3];
+                if (context.Canonical[corners[0]] == to || context.Canonical[corners[1]] == to || context.Canonical[corners[2]] == to)
+                    continue;
+
+                glm::vec3 before[3], after[3];
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    before[k] = context.Positions[corners[k]];
+                    after[k] = corners[k] == from ? target : before[k];
+                }
+                const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                const float lengths = std::sqrt(glm::dot(normalBefore, normalBefore) * glm::dot(normalAfter, normalAfter));
+                if (glm::dot(normalBefore, normalAfter) <= MinNormalDot * lengths)
+                {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips)
+                continue;
+
+            // Move every corner of `from` onto `to`, triangles that had both become degenerate
+            for (const uint32 triangle : trianglesOf(from))
+            {
+                uint32* corners = &result[triangle * 3];
+                if (context.Canonical[corners[0]] == to || context.Canonical[corners[1]] == to || context.Canonical[corners[2]] == to)
+                {
+                    corners[0] = corners[1] = corners[2] = DeadTriangle;
+                    --triangleCount;
+                    continue;
+                }
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    if (corners[k] == from)
+                        corners[k] = collapse.To;
+                }
+            }
+
+            maxDistanceSquared = std::max(maxDistanceSquared, context.Quadrics[from].MeanSquaredDistance(target));
+            context.Quadrics[to].Add(context.Quadrics[from]);
+
+            // The adjacency of the whole neighbourhood is stale until the next pass
+            touched[from] = touched[to] = 1;
+            for (const uint32 neighbour : neighbours)
+                touched[neighbour] = 1;
+            ++collapsed;
+        }
+
+        std::erase(result, DeadTriangle);
+        if (collapsed == 0)
+            break;
+    }
+
+    if (resultError)
+        *resultError = static_cast<float>(std::sqrt(maxDistanceSquared)) * context.Extent;
+    return result;
+}
+
+MeshLodChain MeshSimplifier::BuildLodChain(std::span<const VertexPosNormalTangentUV3D> vertices, std::span<const uint32> indices,
+    const Options& options)
+{
+    MeshLodChain chain;
+    chain.Indices.assign(indices.begin(), indices.end());
+    chain.Lods.push_back({ 0, static_cast<uint32>(indices.size()), 0.0f });
+
+    std::vector<uint32> current(indices.begin(), indices.end());
+    float error = 0.0f;
+    while (chain.Lods.size() < options.MaxLods)
+    {
+        const size_t target = static_cast<size_t>(static_cast<float>(current.size() / 3) * options.ReductionRatio) * 3;
+
+        float levelError = 0.0f;
+        std::vector<uint32> next = Simplify(vertices, current, target, options, &levelError);
+        if (static_cast<float>(next.size()) > static_cast<float>(current.size()) * (1.0f - options.MinReduction))
+            break;
+
+        // Every level is simplified from the previous one, so the errors add up
+        error += levelError;
+        chain.Lods.push_back({ static_cast<uint32>(chain.Indices.size()), static_cast<uint32>(next.size()), error });
+        chain.Indices.insert(chain.Indices.end(), next.begin(), next.end());
+        current = std::move(next);
+    }
+    return chain;
+}
@@ -0,0 +1,357 @@
+#include "Meshlet.h"
+#include "InstanceData.h"
+#include "JobSystem.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    struct MeshletArrays
+    {
+        const float* CenterX;
+        const float* CenterY;
+        const float* CenterZ;
+        const float* Radius;
+        const float* AxisX;
+        const float* AxisY;
+        const float* AxisZ;
+        const float* Cutoff;
+    };
+
+    // Visible when the sphere is not entirely behind any plane (dot(n, c) + d >= -r)
+    // and the eye is not inside the region from which the whole normal cone faces away
+    template <typename V>
+    size_t CullMeshlets(const MeshletArrays& arrays, const Frustum& frustum, const glm::vec3& eye, size_t count, uint32* visible)
+    {
+        using Float = typename V::Float;
+
+        Float planeX[Frustum::Count], planeY[Frustum::Count], planeZ[Frustum::Count], planeW[Frustum::Count];
+        for (int p = 0; p < Frustum::Count; ++p)
+        {
+            planeX[p] = V::Set(frustum.Planes[p].x);
+            planeY[p] = V::Set(frustum.Planes[p].y);
+            planeZ[p] = V::Set(frustum.Planes[p].z);
+            planeW[p] = V::Set(frustum.Planes[p].w);
+        }
+        const Float eyeX = V::Set(eye.x);
+        const Float eyeY = V::Set(eye.y);
+        const Float eyeZ = V::Set(eye.z);
+
+        const Float zero = V::Set(0.0f);
+        size_t visibleCount = 0;
+        for (size_t i = 0; i < count; i += V::Width)
+        {
+            const Float x = V::Load(arrays.CenterX + i);
+            const Float y = V::Load(arrays.CenterY + i);
+            const Float z = V::Load(arrays.CenterZ + i);
+            const Float radius = V::Load(arrays.Radius + i);
+
+            const auto inFront = [&](int p) {
+                const Float distance = V::Add(V::Add(V::Mul(planeX[p], x), V::Mul(planeY[p], y)), V::Add(V::Mul(planeZ[p], z), planeW[p]));
+                return V::GreaterEqual(V::Add(distance, radius), zero);
+            };
+
+            Float inside = inFront(0);
+            for (int p = 1; p < Frustum::Count; ++p)
+            {
+                inside = V::And(inside, inFront(p));
+            }
+
+            const Float toCenterX = V::Sub(x, eyeX);
+            const Float toCenterY = V::Sub(y, eyeY);
+            const Float toCenterZ = V::Sub(z, eyeZ);
+            const Float alongAxis = V::Add(V::Add(V::Mul(toCenterX, V::Load(arrays.AxisX + i)), V::Mul(toCenterY, V::Load(arrays.AxisY + i))),
+                V::Mul(toCenterZ, V::Load(arrays.AxisZ + i)));
+            const Float distance = V::Sqrt(V::Add(V::Add(V::Mul(toCenterX, toCenterX), V::Mul(toCenterY, toCenterY)), V::Mul(toCenterZ, toCenterZ)));
+            const Float frontFacing = V::Less(alongAxis, V::Add(V::Mul(V::Load(arrays.Cutoff + i), distance), radius));
+
+            uint32 mask = V::MoveMask(V::And(inside, frontFacing));
+            if (count - i < V::Width)
+            {
+                mask &= (1u << (count - i)) - 1u;
+            }
+
+            while (mask != 0)
+            {
+                visible[visibleCount++] = static_cast<uint32>(i + std::countr_zero(mask));
+                mask &= mask - 1u;
+            }
+        }
+        return visibleCount;
+    }
+}
+
+MeshletBuilder::Result MeshletBuilder::Build(std::span<const uint32> indices, std::span<const glm::vec3> positions)
+{
+    Result result;
+    result.Indices.reserve(indices.size());
+
+    // Meshlet that last referenced every vertex, so the open meshlet's vertex count is known without a set
+    std::vector<uint32> lastMeshlet(positions.size(), ~0u);
+    Meshlet current{};
+    uint32 currentIndex = 0;
+
+    const auto countNewVertices = [&](uint32 a, uint32 b, uint32 c) {
+        return static_cast<uint32>(lastMeshlet[a] != currentIndex) + static_cast<uint32>(lastMeshlet[b] != currentIndex && b != a) +
+            static_cast<uint32>(lastMeshlet[c] != currentIndex && c != a && c != b);
+    };
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const uint32 a = indices[i];
+        const uint32 b = indices[i + 1];
+        const uint32 c = indices[i + 2];
+
+        uint32 newVertices = countNewVertices(a, b, c);
+        if (current.TriangleCount == MaxTriangles || current.VertexCount + newVertices > MaxVertices)
+        {
+            result.Meshlets.push_back(current);
+            current = Meshlet{};
+            current.FirstIndex = static_cast<uint32>(result.Indices.size());
+            ++currentIndex;
+            newVertices = countNewVertices(a, b, c);
+        }
+
+        lastMeshlet[a] = lastMeshlet[b] = lastMeshlet[c] = currentIndex;
+        current.VertexCount += newVertices;
+        ++current.TriangleCount;
+        result.Indices.insert(result.Indices.end(), { a, b, c });
+    }
+    if (current.TriangleCount > 0)
+    {
+        result.Meshlets.push_back(current);
+    }
+
+    JobSystem::GetInstance().ParallelFor(result.Meshlets.size(), 64, [&result, positions](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            Meshlet& meshlet = result.Meshlets[i];
+            ComputeBounds(meshlet, std::span<const uint32>(result.Indices).subspan(meshlet.FirstIndex, meshlet.TriangleCount * 3), positions);
+        }
+    });
+    return result;
+}
+
+void MeshletBuilder::ComputeBounds(Meshlet& meshlet, std::span<const uint32> triangles, std::span<const glm::vec3> positions)
+{
+    // Sphere around the center of the bounding box, tight enough for clusters this small
+    glm::vec3 minimum(FLT_MAX);
+    glm::vec3 maximum(-FLT_MAX);
+    for (const uint32 index : triangles)
+    {
+        minimum = glm::min(minimum, positions[index]);
+        maximum = glm::max(maximum, positions[index]);
+    }
+    const glm::vec3 center = (minimum + maximum) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (const uint32 index : triangles)
+    {
+        const glm::vec3 offset = positions[index] - center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    meshlet.Sphere = glm::vec4(center, std::sqrt(radiusSquared));
+
+    // The cone axis is the average normal, its half angle reaches the normal farthest from it
+    const auto triangleNormal = [&](size_t i, glm::vec3& normal) {
+        const glm::vec3& p0 = positions[triangles[i]];
+        normal = glm::cross(positions[triangles[i + 1]] - p0, positions[triangles[i + 2]] - p0);
+        const float length = glm::length(normal);
+        if (length <= FLT_MIN)
+            return false;
+        normal /= length;
+        return true;
+    };
+
+    glm::vec3 axis(0.0f);
+    glm::vec3 normal;
+    for (size_t i = 0; i < triangles.size(); i += 3)
+    {
+        if (triangleNormal(i, normal))
+            axis += normal;
+    }
+
+    meshlet.Cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    const float axisLength = glm::length(axis);
+    if (axisLength <= 1e-6f)
+        return;
+    axis /= axisLength;
+
+    float minimumDot = 1.0f;
+    for (size_t i = 0; i < triangles.size(); i += 3)
+    {
+        if (triangleNormal(i, normal))
+            minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+    }
+
+    // Normals more than 90 degrees apart from the axis can never all face away at once
+    const float cutoff = minimumDot > 0.0f ? std::sqrt(1.0f - minimumDot * minimumDot) : 1.0f;
+    meshlet.Cone = glm::vec4(axis, cutoff);
+}
+
+void MeshletCuller::Upload(std::span<const Meshlet> meshlets)
+{
+    Count = meshlets.size();
+    VisibleCount = 0;
+    Visible.resize(Count);
+
+    // Padding lanes are masked off in CullMeshlets, their values only have to be finite
+    const size_t padded = (Count + BatchWidth - 1) / BatchWidth * BatchWidth;
+    for (AlignedVector<float>* array : { &CenterX, &CenterY, &CenterZ, &Radius, &AxisX, &AxisY, &AxisZ, &Cutoff })
+    {
+        array->assign(padded, 0.0f);
+    }
+
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const Meshlet& meshlet = meshlets[i];
+        CenterX[i] = meshlet.Sphere.x;
+        CenterY[i] = meshlet.Sphere.y;
+        CenterZ[i] = meshlet.Sphere.z;
+        Radius[i] = meshlet.Sphere.w;
+        AxisX[i] = meshlet.Cone.x;
+        AxisY[i] = meshlet.Cone.y;
+        AxisZ[i] = meshlet.Cone.z;
+        Cutoff[i] = meshlet.Cone.w;
+    }
+}
+
+size_t MeshletCuller::Cull(const Frustum& frustum, const glm::vec3& eye)
+{
+    const MeshletArrays arrays{ CenterX.data(), CenterY.data(), CenterZ.data(), Radius.data(), AxisX.data(), AxisY.data(), AxisZ.data(), Cutoff.data() };
+    VisibleCount = CullMeshlets<Simd::Native>(arrays, frustum, eye, Count, Visible.data());
+    return VisibleCount;
+}
+
+void MeshletMesh::Upload(const void* vertices, uint32 vertexCount, uint32 vertexStride, std::span<const uint32> indices, AttributeSetup setupAttributes)
+{
+    IndexType = MeshOptimizer::SelectIndexType(vertexCount);
+
+#if !USE_DSA
+    VAO.Bind();
+    VBO.Bind();
+#endif
+    VBO.UploadData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexCount) * vertexStride, vertices, GL_STATIC_DRAW);
+    VAO.AttachVertexBuffer(VBO.GetBufferID());
+    setupAttributes(VAO);
+
+#if !USE_DSA
+    EBO.Bind();
+#endif
+    if (IndexType == GL_UNSIGNED_SHORT)
+    {
+        EBO.UploadData(std::vector<uint16>(indices.begin(), indices.end()), GL_STATIC_DRAW);
+    }
+    else
+    {
+        EBO.UploadData(static_cast<GLsizeiptr>(indices.size_bytes()), indices.data(), GL_STATIC_DRAW);
+    }
+    VAO.AttachElementBuffer(EBO.GetBufferID());
+#if !USE_DSA
+    VAO.Unbind();
+#endif
+
+    MeshletBuffer.UploadData(Meshlets, GL_STATIC_DRAW);
+    MeshletBuffer.Unbind();
+    Culler.Upload(Meshlets);
+}
+
+MeshletCullingPass::MeshletCullingPass(std::string_view shaderPath)
+    : Shader(shaderPath)
+{
+    GroupSizeX = std::max(Shader.GetWorkGroupSize().x, 1u);
+
+    const uint32 zero = 0;
+    CountBuffer.UploadData(sizeof(zero), &zero, GL_DYNAMIC_DRAW);
+    CountBuffer.Unbind();
+}
+
+void MeshletCullingPass::Reserve(uint32 meshletCount)
+{
+    DrawCount = meshletCount;
+    if (meshletCount <= CommandCapacity)
+        return;
+
+    // Worst case every meshlet is visible
+    CommandCapacity = meshletCount;
+    CommandBuffer.UploadData(static_cast<GLsizeiptr>(meshletCount * sizeof(DrawElementsIndirectCommand)), nullptr, GL_DYNAMIC_DRAW);
+    CommandBuffer.Unbind();
+}
+
+uint32 MeshletCullingPass::RunCPU(MeshletMesh& mesh, const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& eye, uint32 baseInstance)
+{
+    Reserve(mesh.GetMeshletCount());
+
+    // Planes of viewProjection * model are in object space, normalized to object-space distances
+    const Frustum frustum = Frustum::FromMatrix(viewProjection * model);
+    const glm::vec3 objectEye = glm::vec3(glm::inverse(model) * glm::vec4(eye, 1.0f));
+
+    MeshletCuller& culler = mesh.GetCuller();
+    const uint32 visibleCount = static_cast<uint32>(culler.Cull(frustum, objectEye));
+
+    const std::span<const Meshlet> meshlets = mesh.GetMeshlets();
+    Commands.resize(visibleCount);
+    for (uint32 i = 0; i < visibleCount; ++i)
+    {
+        const Meshlet& meshlet = meshlets[culler.GetVisible()[i]];
+        Commands[i] = DrawElementsIndirectCommand{ meshlet.TriangleCount * 3, 1, meshlet.FirstIndex, 0, baseInstance };
+    }
+
+    if (visibleCount > 0)
+    {
+        CommandBuffer.UpdateData(0, static_cast<GLsizeiptr>(visibleCount * sizeof(DrawElementsIndirectCommand)), Commands.data());
+        CommandBuffer.Unbind();
+    }
+    CountBuffer.UpdateData(0, sizeof(visibleCount), &visibleCount);
+    CountBuffer.Unbind();
+    return visibleCount;
+}
+
+void MeshletCullingPass::RunGPU(const MeshletMesh& mesh, const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& eye,
+    uint32 baseInstance)
+{
+    Reserve(mesh.GetMeshletCount());
+    if (DrawCount == 0) [[unlikely]]
+        return;
+
+    const Frustum frustum = Frustum::FromMatrix(viewProjection * model);
+    const glm::vec3 objectEye = glm::vec3(glm::inverse(model) * glm::vec4(eye, 1.0f));
+
+    const uint32 zero = 0;
+    CountBuffer.UpdateData(0, sizeof(zero), &zero);
+    CountBuffer.Unbind();
+
+    mesh.BindMeshlets(MESHLET_BUFFER_BINDING);
+    CommandBuffer.BindStorage(MESHLET_COMMAND_BUFFER_BINDING);
+    CountBuffer.BindBase(MESHLET_COUNT_BUFFER_BINDING);
+
+    Shader.Bind();
+    Shader.SetVec4Array("FrustumPlanes", frustum.Planes);
+    Shader.SetVec3("Eye", objectEye);
+    Shader.SetInt("MeshletCount", static_cast<int>(DrawCount));
+    Shader.SetInt("BaseInstance", static_cast<int>(baseInstance));
+
+    const GLuint groups = (DrawCount + GroupSizeX - 1) / GroupSizeX;
+    Shader.DispatchWithBarrier(groups, 1, 1, GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+}
+
+void MeshletCullingPass::Draw(const MeshletMesh& mesh) const
+{
+    if (DrawCount == 0) [[unlikely]]
+        return;
+
+    mesh.Bind();
+    CommandBuffer.Bind();
+    GLStateCache::GetInstance().BindBuffer(GL_PARAMETER_BUFFER, CountBuffer.GetBufferID());
+    glMultiDrawElementsIndirectCount(GL_TRIANGLES, mesh.GetIndexType(), nullptr, 0, static_cast<GLsizei>(DrawCount), 0);
+}
+
+uint32 MeshletCullingPass::ReadVisibleCount() const
+{
+    uint32 count = 0;
+    CountBuffer.Bind();
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(count), &count);
+    return count;
+}
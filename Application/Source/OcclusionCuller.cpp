@@ -0,0 +1,312 @@
+#include "OcclusionCuller.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace
+{
+    // Candidates per occlusion test job
+    constexpr size_t TestGrainSize = 256;
+
+    // Clip-space w below this counts as touching the eye
+    constexpr float MinClipW = 1e-5f;
+
+    // Unit cube corners: bit 0 = +x, bit 1 = +y, bit 2 = +z
+    constexpr float CubeCorner(uint32 corner, uint32 axis) { return (corner >> axis) & 1u ? 0.5f : -0.5f; }
+
+    float Cross(const glm::vec2& origin, const glm::vec2& a, const glm::vec2& b)
+    {
+        return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+    }
+
+    // Counter-clockwise convex hull (Andrew's monotone chain), returns the number of hull points written to `hull`
+    uint32 ConvexHull(glm::vec2 (&points)[8], glm::vec2 (&hull)[16])
+    {
+        std::sort(std::begin(points), std::end(points), [](const glm::vec2& a, const glm::vec2& b) {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        });
+
+        uint32 count = 0;
+        for (const glm::vec2& point : points)
+        {
+            while (count >= 2 && Cross(hull[count - 2], hull[count - 1], point) <= 0.0f)
+                --count;
+            hull[count++] = point;
+        }
+        const uint32 lowerCount = count + 1;
+        for (int32 i = 6; i >= 0; --i)
+        {
+            while (count >= lowerCount && Cross(hull[count - 2], hull[count - 1], points[i]) <= 0.0f)
+                --count;
+            hull[count++] = points[i];
+        }
+        return count - 1;  // The last point repeats the first
+    }
+}
+
+OcclusionCuller::OcclusionCuller(uint32 width, uint32 height, uint32 maxOccluders)
+    : Width((std::max(width, TileSize) + TileSize - 1) / TileSize * TileSize)
+    , Height((std::max(height, TileSize) + TileSize - 1) / TileSize * TileSize)
+    , TilesX(Width / TileSize)
+    , TilesY(Height / TileSize)
+    , MaxOccluders(maxOccluders)
+    , Depth(static_cast<size_t>(Width) * Height, 1.0f)
+    , TileMaxDepth(static_cast<size_t>(TilesX) * TilesY, 1.0f)
+{
+}
+
+size_t OcclusionCuller::Cull(const glm::mat4& view, const glm::mat4& projection, std::span<const uint32> candidates,
+    std::span<const glm::vec4> spheres, std::span<const glm::mat4> models)
+{
+    FrameStats = {};
+    Visible.clear();
+
+    SelectOccluders(view, candidates, spheres);
+    ProjectOccluders(projection * view, models);
+
+    // Tile rows never share pixels, so every job clears and rasterizes its own rows
+    JobSystem& jobs = JobSystem::GetInstance();
+    jobs.ParallelFor(TilesY, 1, [this](size_t begin, size_t end) {
+        for (size_t tileRow = begin; tileRow < end; ++tileRow)
+        {
+            RasterizeTileRow(static_cast<uint32>(tileRow));
+        }
+    });
+
+    OccludedFlags.resize(candidates.size());
+    jobs.ParallelFor(candidates.size(), TestGrainSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            OccludedFlags[i] = IsOccluded(spheres[candidates[i]], view, projection) ? 1 : 0;
+        }
+    });
+
+    Visible.reserve(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (!OccludedFlags[i])
+        {
+            Visible.push_back(candidates[i]);
+        }
+    }
+
+    FrameStats.Occluders = static_cast<uint32>(Shapes.size());
+    FrameStats.Tested = static_cast<uint32>(candidates.size());
+    FrameStats.Occluded = static_cast<uint32>(candidates.size() - Visible.size());
+    return Visible.size();
+}
+
+void OcclusionCuller::SelectOccluders(const glm::mat4& view, std::span<const uint32> candidates, std::span<const glm::vec4> spheres)
+{
+    // The nearest candidates cover the most screen and hide the most
+    CandidateDepths.clear();
+    CandidateDepths.reserve(candidates.size());
+    for (const uint32 id : candidates)
+    {
+        const glm::vec4& sphere = spheres[id];
+        const float viewDepth = -(view * glm::vec4(glm::vec3(sphere), 1.0f)).z;
+        CandidateDepths.emplace_back(viewDepth - sphere.w, id);
+    }
+
+    const size_t count = std::min<size_t>(MaxOccluders, CandidateDepths.size());
+    std::nth_element(CandidateDepths.begin(), CandidateDepths.begin() + static_cast<ptrdiff_t>(count), CandidateDepths.end(),
+        [](const std::pair<float, uint32>& a, const std::pair<float, uint32>& b) { return a.first < b.first; });
+
+    Occluders.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        Occluders.push_back(CandidateDepths[i].second);
+    }
+}
+
+void OcclusionCuller::ProjectOccluders(const glm::mat4& viewProjection, std::span<const glm::mat4> models)
+{
+    Shapes.clear();
+    for (const uint32 id : Occluders)
+    {
+        const glm::mat4 modelViewProjection = viewProjection * models[id];
+
+        glm::vec2 corners[8];
+        float farthest = -1.0f;
+        bool crossesNearPlane = false;
+        for (uint32 corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec4 clip = modelViewProjection * glm::vec4(CubeCorner(corner, 0), CubeCorner(corner, 1), CubeCorner(corner, 2), 1.0f);
+
+            // Boxes cut by the near plane are skipped rather than clipped, which only loses occlusion
+            if (clip.w < MinClipW || clip.z < -clip.w)
+            {
+                crossesNearPlane = true;
+                break;
+            }
+
+            const float inverseW = 1.0f / clip.w;
+            corners[corner] = glm::vec2(
+                (clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(Width),
+                (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(Height));
+            farthest = std::max(farthest, clip.z * inverseW);
+        }
+        if (crossesNearPlane)
+            continue;
+
+        glm::vec2 hull[16];
+        const uint32 hullCount = ConvexHull(corners, hull);
+        if (hullCount < 3)
+            continue;
+
+        OccluderShape& shape = Shapes.emplace_back();
+        shape.EdgeCount = hullCount;
+        shape.Depth = farthest;
+
+        glm::vec2 minimum = hull[0], maximum = hull[0];
+        for (uint32 i = 0; i < hullCount; ++i)
+        {
+            const glm::vec2& p = hull[i];
+            const glm::vec2& q = hull[(i + 1) % hullCount];
+
+            // Positive to the left of p -> q, moved inwards by half a pixel so only fully covered pixels pass
+            Edge& edge = shape.Edges[i];
+            edge.A = p.y - q.y;
+            edge.B = q.x - p.x;
+            edge.C = -(edge.A * p.x + edge.B * p.y) - 0.5f * (std::abs(edge.A) + std::abs(edge.B));
+
+            minimum = glm::vec2(std::min(minimum.x, p.x), std::min(minimum.y, p.y));
+            maximum = glm::vec2(std::max(maximum.x, p.x), std::max(maximum.y, p.y));
+        }
+
+        shape.XBegin = std::max(0, static_cast<int32>(std::floor(minimum.x)));
+        shape.XEnd = std::min(static_cast<int32>(Width), static_cast<int32>(std::ceil(maximum.x)));
+        shape.YBegin = std::max(0, static_cast<int32>(std::floor(minimum.y)));
+        shape.YEnd = std::min(static_cast<int32>(Height), static_cast<int32>(std::ceil(maximum.y)));
+        if (shape.XBegin >= shape.XEnd || shape.YBegin >= shape.YEnd)
+        {
+            Shapes.pop_back();
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTileRow(uint32 tileRow)
+{
+    const uint32 firstRow = tileRow * TileSize;
+    const uint32 endRow = firstRow + TileSize;
+
+    std::fill(Depth.begin() + static_cast<ptrdiff_t>(firstRow) * Width, Depth.begin() + static_cast<ptrdiff_t>(endRow) * Width, 1.0f);
+
+    for (const OccluderShape& shape : Shapes)
+    {
+        RasterizeShape(shape, static_cast<int32>(firstRow), static_cast<int32>(endRow));
+    }
+
+    // Farthest depth of every tile in the row, one 8-pixel row is two SSE registers
+    for (uint32 tileX = 0; tileX < TilesX; ++tileX)
+    {
+        __m128 farthest = _mm_set1_ps(-1.0f);
+        for (uint32 y = firstRow; y < endRow; ++y)
+        {
+            const float* row = &Depth[static_cast<size_t>(y) * Width + tileX * TileSize];
+            farthest = _mm_max_ps(farthest, _mm_max_ps(_mm_load_ps(row), _mm_load_ps(row + 4)));
+        }
+        farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+        farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+        TileMaxDepth[static_cast<size_t>(tileRow) * TilesX + tileX] = _mm_cvtss_f32(farthest);
+    }
+}
+
+void OcclusionCuller::RasterizeShape(const OccluderShape& shape, int32 firstRow, int32 endRow)
+{
+    const int32 yBegin = std::max(shape.YBegin, firstRow);
+    const int32 yEnd = std::min(shape.YEnd, endRow);
+    if (yBegin >= yEnd)
+        return;
+
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 depth = _mm_set1_ps(shape.Depth);
+    const int32 xAligned = shape.XBegin & ~3;
+
+    for (int32 y = yBegin; y < yEnd; ++y)
+    {
+        const float pixelY = static_cast<float>(y) + 0.5f;
+
+        float* row = &Depth[static_cast<size_t>(y) * Width];
+        for (int32 x = xAligned; x < shape.XEnd; x += 4)
+        {
+            // Width is a whole number of tiles, so the 4 lanes never run past the row
+            const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (uint32 i = 0; i < shape.EdgeCount; ++i)
+            {
+                const Edge& edge = shape.Edges[i];
+                const __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge.A), pixelX), _mm_set1_ps(edge.B * pixelY + edge.C));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+            }
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            const __m128 previous = _mm_load_ps(row + x);
+            const __m128 nearest = _mm_min_ps(previous, depth);
+            _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+        }
+    }
+}
+
+bool OcclusionCuller::IsOccluded(const glm::vec4& sphere, const glm::mat4& view, const glm::mat4& projection) const
+{
+    const glm::vec4 viewCenter = view * glm::vec4(glm::vec3(sphere), 1.0f);
+    const float radius = sphere.w;
+
+    // Nearest point of the sphere, the camera looks down -z
+    const glm::vec4 nearestClip = projection * glm::vec4(viewCenter.x, viewCenter.y, viewCenter.z + radius, 1.0f);
+    if (nearestClip.w < MinClipW || nearestClip.z < -nearestClip.w)
+        return false;
+    const float nearestDepth = nearestClip.z / nearestClip.w;
+
+    // Screen rectangle of the view-space box around the sphere
+    float minX = static_cast<float>(Width), minY = static_cast<float>(Height);
+    float maxX = 0.0f, maxY = 0.0f;
+    for (uint32 corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec4 clip = projection * glm::vec4(
+            viewCenter.x + 2.0f * radius * CubeCorner(corner, 0),
+            viewCenter.y + 2.0f * radius * CubeCorner(corner, 1),
+            viewCenter.z + 2.0f * radius * CubeCorner(corner, 2), 1.0f);
+
+        const float x = (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(Width);
+        const float y = (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float>(Height);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
+    const int32 xBegin = std::max(0, static_cast<int32>(std::floor(minX)));
+    const int32 xEnd = std::min(static_cast<int32>(Width), static_cast<int32>(std::ceil(maxX)));
+    const int32 yBegin = std::max(0, static_cast<int32>(std::floor(minY)));
+    const int32 yEnd = std::min(static_cast<int32>(Height), static_cast<int32>(std::ceil(maxY)));
+    if (xBegin >= xEnd || yBegin >= yEnd)
+        return false;
+
+    const int32 tileSize = static_cast<int32>(TileSize);
+    for (int32 tileY = yBegin / tileSize; tileY <= (yEnd - 1) / tileSize; ++tileY)
+    {
+        for (int32 tileX = xBegin / tileSize; tileX <= (xEnd - 1) / tileSize; ++tileX)
+        {
+            // Every pixel of the tile is nearer than the object
+            if (TileMaxDepth[static_cast<size_t>(tileY) * TilesX + static_cast<size_t>(tileX)] < nearestDepth)
+                continue;
+
+            for (int32 y = std::max(yBegin, tileY * tileSize); y < std::min(yEnd, (tileY + 1) * tileSize); ++y)
+            {
+                const float* row = &Depth[static_cast<size_t>(y) * Width];
+                for (int32 x = std::max(xBegin, tileX * tileSize); x < std::min(xEnd, (tileX + 1) * tileSize); ++x)
+                {
+                    if (row[x] >= nearestDepth)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,159 @@
+#include "OffscreenContext.h"
+#include "Window.h"
+#include <iostream>
+
+#ifdef LINUX
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+OffscreenContext::~OffscreenContext()
+{
+    Destroy();
+}
+
+#ifdef LINUX
+
+bool OffscreenContext::Create(int major, int minor)
+{
+    // Prefer the surfaceless platform, it needs neither a display server nor a GBM device
+    EGLDisplay display = EGL_NO_DISPLAY;
+    const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay)
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint eglMajor = 0, eglMinor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor))
+    {
+        std::cerr << "ERROR::OFFSCREEN::EGL_INITIALIZE_FAILED" << std::endl;
+        return false;
+    }
+    Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "ERROR::OFFSCREEN::EGL_OPENGL_API_UNAVAILABLE" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        // Surfaceless displays may expose no configs at all, contexts can still be created without one
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cerr << "ERROR::OFFSCREEN::EGL_CREATE_CONTEXT_FAILED (OpenGL " << major << "." << minor << " core)" << std::endl;
+        Destroy();
+        return false;
+    }
+    Context = context;
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cerr << "ERROR::OFFSCREEN::EGL_MAKE_CURRENT_FAILED" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    // glewInit() also initializes GLX, which fails without an X display, so only the core entry points are loaded
+    glewExperimental = GL_TRUE;
+    if (glewContextInit() != GLEW_OK)
+    {
+        std::cerr << "ERROR::OFFSCREEN::GLEW_INITIALIZATION_FAILED" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    Valid = true;
+    return true;
+}
+
+void OffscreenContext::Destroy()
+{
+    if (Display)
+    {
+        eglMakeCurrent(Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (Context)
+        {
+            eglDestroyContext(Display, Context);
+        }
+        eglTerminate(Display);
+    }
+
+    Display = nullptr;
+    Context = nullptr;
+    Valid = false;
+}
+
+#else
+
+bool OffscreenContext::Create(int major, int minor)
+{
+    if (!glfwInit())
+    {
+        std::cerr << "ERROR::OFFSCREEN::GLFW_INITIALIZATION_FAILED" << std::endl;
+        return false;
+    }
+
+    OpenGLVersionInit(major, minor);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // The window only owns the context, its size does not matter
+    Window = glfwCreateWindow(1, 1, "Learn OpenGL (headless)", nullptr, nullptr);
+    if (!Window)
+    {
+        std::cerr << "ERROR::OFFSCREEN::GLFW_CREATE_WINDOW_FAILED" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+
+    glfwMakeContextCurrent(Window);
+    glfwSwapInterval(0);
+
+    if (glewInit() != GLEW_OK)
+    {
+        std::cerr << "ERROR::OFFSCREEN::GLEW_INITIALIZATION_FAILED" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    Valid = true;
+    return true;
+}
+
+void OffscreenContext::Destroy()
+{
+    if (Window)
+    {
+        glfwDestroyWindow(Window);
+        glfwTerminate();
+    }
+
+    Window = nullptr;
+    Valid = false;
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+#include <bit>
+
+RangeAllocator::RangeAllocator(uint32 size)
+{
+    BinHeads.fill(InvalidNode);
+    if (size > 0)
+    {
+        Grow(size);
+    }
+}
+
+uint32 RangeAllocator::BinOf(uint32 size) noexcept
+{
+    // Sizes below BinsPerLevel get one exact bin each, larger ones 8 bins per power of two
+    if (size < BinsPerLevel)
+        return size;
+
+    const uint32 log = static_cast<uint32>(std::bit_width(size)) - 1;
+    const uint32 slot = (size >> (log - SecondLevelBits)) & (BinsPerLevel - 1);
+    return (log - SecondLevelBits + 1) * BinsPerLevel + slot;
+}
+
+uint32 RangeAllocator::BinMinimum(uint32 bin) noexcept
+{
+    const uint32 level = bin / BinsPerLevel;
+    const uint32 slot = bin % BinsPerLevel;
+    if (level == 0)
+        return slot;
+
+    const uint32 log = level + SecondLevelBits - 1;
+    return (BinsPerLevel + slot) << (log - SecondLevelBits);
+}
+
+uint32 RangeAllocator::FindBin(uint32 bin) const noexcept
+{
+    const uint32 level = bin / BinsPerLevel;
+    const uint32 slotMask = BinMasks[level] & (0xFFu << (bin % BinsPerLevel));
+    if (slotMask != 0)
+        return level * BinsPerLevel + static_cast<uint32>(std::countr_zero(slotMask));
+
+    const uint32 levels = level + 1 < LevelCount ? LevelMask & (~0u << (level + 1)) : 0;
+    if (levels == 0)
+        return InvalidNode;
+
+    const uint32 found = static_cast<uint32>(std::countr_zero(levels));
+    return found * BinsPerLevel + static_cast<uint32>(std::countr_zero(static_cast<uint32>(BinMasks[found])));
+}
+
+uint32 RangeAllocator::CreateNode(uint32 offset, uint32 size)
+{
+    uint32 node;
+    if (!UnusedNodes.empty())
+    {
+        node = UnusedNodes.back();
+        UnusedNodes.pop_back();
+        Nodes[node] = Node{};
+    }
+    else
+    {
+        node = static_cast<uint32>(Nodes.size());
+        Nodes.emplace_back();
+    }
+
+    Nodes[node].Offset = offset;
+    Nodes[node].Size = size;
+    return node;
+}
+
+void RangeAllocator::ReleaseNode(uint32 node)
+{
+    UnusedNodes.push_back(node);
+}
+
+void RangeAllocator::InsertFree(uint32 node)
+{
+    const uint32 bin = BinOf(Nodes[node].Size);
+    Nodes[node].BinPrevious = InvalidNode;
+    Nodes[node].BinNext = BinHeads[bin];
+    if (BinHeads[bin] != InvalidNode)
+    {
+        Nodes[BinHeads[bin]].BinPrevious = node;
+    }
+    BinHeads[bin] = node;
+
+    BinMasks[bin / BinsPerLevel] |= static_cast<uint8>(1u << (bin % BinsPerLevel));
+    LevelMask |= 1u << (bin / BinsPerLevel);
+}
+
+void RangeAllocator::RemoveFree(uint32 node)
+{
+    const uint32 bin = BinOf(Nodes[node].Size);
+    const uint32 previous = Nodes[node].BinPrevious;
+    const uint32 next = Nodes[node].BinNext;
+
+    if (previous != InvalidNode)
+        Nodes[previous].BinNext = next;
+    else
+        BinHeads[bin] = next;
+    if (next != InvalidNode)
+        Nodes[next].BinPrevious = previous;
+
+    if (BinHeads[bin] == InvalidNode)
+    {
+        const uint32 level = bin / BinsPerLevel;
+        BinMasks[level] &= static_cast<uint8>(~(1u << (bin % BinsPerLevel)));
+        if (BinMasks[level] == 0)
+        {
+            LevelMask &= ~(1u << level);
+        }
+    }
+}
+
+RangeAllocator::Allocation RangeAllocator::Allocate(uint32 size)
+{
+    size = std::max(size, 1u);
+
+    // Round the bin up, so every range in it or after it is large enough
+    const uint32 exactBin = BinOf(size);
+    const uint32 bin = BinMinimum(exactBin) < size ? FindBin(exactBin + 1) : FindBin(exactBin);
+
+    uint32 node = bin != InvalidNode ? BinHeads[bin] : InvalidNode;
+    if (node == InvalidNode)
+    {
+        // Ranges in the rounded-down bin may still fit, e.g. right after Grow() to the exact size
+        for (node = BinHeads[exactBin]; node != InvalidNode && Nodes[node].Size < size; node = Nodes[node].BinNext)
+        {
+        }
+        if (node == InvalidNode)
+            return {};
+    }
+    RemoveFree(node);
+
+    // The rest of the range stays free as its own block right behind the allocation
+    const uint32 remainder = Nodes[node].Size - size;
+    if (remainder > 0)
+    {
+        const uint32 rest = CreateNode(Nodes[node].Offset + size, remainder);
+        Nodes[rest].NeighbourPrevious = node;
+        Nodes[rest].NeighbourNext = Nodes[node].NeighbourNext;
+        if (Nodes[node].NeighbourNext != InvalidNode)
+        {
+            Nodes[Nodes[node].NeighbourNext].NeighbourPrevious = rest;
+        }
+        Nodes[node].NeighbourNext = rest;
+        Nodes[node].Size = size;
+        if (Tail == node)
+        {
+            Tail = rest;
+        }
+        InsertFree(rest);
+    }
+
+    Nodes[node].Used = true;
+    FreeSize -= size;
+    return Allocation{ Nodes[node].Offset, size, node };
+}
+
+void RangeAllocator::Free(const Allocation& allocation)
+{
+    if (!allocation.IsValid())
+        return;
+
+    uint32 node = allocation.Node;
+    Nodes[node].Used = false;
+    FreeSize += Nodes[node].Size;
+
+    // Merge with the free neighbours on both sides
+    const uint32 previous = Nodes[node].NeighbourPrevious;
+    if (previous != InvalidNode && !Nodes[previous].Used)
+    {
+        RemoveFree(previous);
+        Nodes[previous].Size += Nodes[node].Size;
+        Nodes[previous].NeighbourNext = Nodes[node].NeighbourNext;
+        if (Nodes[node].NeighbourNext != InvalidNode)
+        {
+            Nodes[Nodes[node].NeighbourNext].NeighbourPrevious = previous;
+        }
+        if (Tail == node)
+        {
+            Tail = previous;
+        }
+        ReleaseNode(node);
+        node = previous;
+    }
+
+    const uint32 next = Nodes[node].NeighbourNext;
+    if (next != InvalidNode && !Nodes[next].Used)
+    {
+        RemoveFree(next);
+        Nodes[node].Size += Nodes[next].Size;
+        Nodes[node].NeighbourNext = Nodes[next].NeighbourNext;
+        if (Nodes[next].NeighbourNext != InvalidNode)
+        {
+            Nodes[Nodes[next].NeighbourNext].NeighbourPrevious = node;
+        }
+        if (Tail == next)
+        {
+            Tail = node;
+        }
+        ReleaseNode(next);
+    }
+
+    InsertFree(node);
+}
+
+void RangeAllocator::Grow(uint32 newSize)
+{
+    if (newSize <= Size)
+        return;
+
+    const uint32 added = newSize - Size;
+    if (Tail != InvalidNode && !Nodes[Tail].Used)
+    {
+        RemoveFree(Tail);
+        Nodes[Tail].Size += added;
+        InsertFree(Tail);
+    }
+    else
+    {
+        const uint32 node = CreateNode(Size, added);
+        Nodes[node].NeighbourPrevious = Tail;
+        if (Tail != InvalidNode)
+        {
+            Nodes[Tail].NeighbourNext = node;
+        }
+        Tail = node;
+        InsertFree(node);
+    }
+
+    Size = newSize;
+    FreeSize += added;
+}
@@ -0,0 +1,133 @@
+#include "RenderQueue.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr uint32 RadixBits = 8;
+    constexpr uint32 RadixBuckets = 1u << RadixBits;
+    constexpr uint64 RadixMask = RadixBuckets - 1;
+
+    // Below this size the parallel passes cost more than a plain comparison sort
+    constexpr size_t RadixSortThreshold = 2048;
+
+    // Smallest amount of work handed to one worker per pass
+    constexpr size_t MinItemsPerChunk = 4096;
+}
+
+void RenderQueue::Reserve(size_t count)
+{
+    Items.reserve(count);
+    Scratch.reserve(count);
+}
+
+void RenderQueue::Sort()
+{
+    LastStats.StateChangesUnsorted = CountStateChanges(Items);
+
+    if (Items.size() < RadixSortThreshold)
+    {
+        // Stable like the radix sort, so equal keys keep their push order on both paths
+        std::stable_sort(Items.begin(), Items.end(), [](const RenderItem& a, const RenderItem& b) { return a.Key < b.Key; });
+    }
+    else
+    {
+        RadixSort();
+    }
+
+    LastStats.StateChangesSorted = CountStateChanges(Items);
+}
+
+uint32 RenderQueue::CountStateChanges(std::span<const RenderItem> items) noexcept
+{
+    uint32 changes = 0;
+    for (size_t i = 1; i < items.size(); ++i)
+    {
+        const uint64 previous = items[i - 1].Key;
+        const uint64 current = items[i].Key;
+
+        changes += SortKey::GetShader(previous) != SortKey::GetShader(current);
+        changes += SortKey::GetMesh(previous) != SortKey::GetMesh(current);
+        changes += SortKey::GetMaterial(previous) != SortKey::GetMaterial(current);
+    }
+    return changes;
+}
+
+void RenderQueue::RadixSort()
+{
+    JobSystem& jobs = JobSystem::GetInstance();
+    const size_t count = Items.size();
+    const size_t chunkCount = std::clamp<size_t>(count / MinItemsPerChunk, 1, jobs.GetThreadCount());
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    Scratch.resize(count);
+    ChunkHistograms.resize(chunkCount * RadixBuckets);
+
+    // Bytes that are equal in every key cannot change the order, their passes are skipped
+    uint64 differingBits = 0;
+    const uint64 firstKey = Items[0].Key;
+    for (const RenderItem& item : Items)
+    {
+        differingBits |= item.Key ^ firstKey;
+    }
+
+    RenderItem* source = Items.data();
+    RenderItem* destination = Scratch.data();
+
+    for (uint32 shift = 0; shift < 64; shift += RadixBits)
+    {
+        if (((differingBits >> shift) & RadixMask) == 0)
+            continue;
+
+        // 1. Digit histogram of every chunk
+        jobs.ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk) {
+            for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+            {
+                uint32* histogram = &ChunkHistograms[chunk * RadixBuckets];
+                std::fill_n(histogram, RadixBuckets, 0u);
+
+                const size_t begin = chunk * chunkSize;
+                const size_t end = std::min(begin + chunkSize, count);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    ++histogram[(source[i].Key >> shift) & RadixMask];
+                }
+            }
+        });
+
+        // 2. Exclusive prefix sum, digit-major and chunk-minor, turns the counts into scatter offsets
+        uint32 offset = 0;
+        for (uint32 digit = 0; digit < RadixBuckets; ++digit)
+        {
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                uint32& slot = ChunkHistograms[chunk * RadixBuckets + digit];
+                const uint32 digitCount = slot;
+                slot = offset;
+                offset += digitCount;
+            }
+        }
+
+        // 3. Stable scatter, every chunk writes only to the ranges it reserved
+        jobs.ParallelFor(chunkCount, 1, [&](size_t firstChunk, size_t lastChunk) {
+            for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+            {
+                uint32* offsets = &ChunkHistograms[chunk * RadixBuckets];
+
+                const size_t begin = chunk * chunkSize;
+                const size_t end = std::min(begin + chunkSize, count);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    destination[offsets[(source[i].Key >> shift) & RadixMask]++] = source[i];
+                }
+            }
+        });
+
+        std::swap(source, destination);
+    }
+
+    if (source != Items.data())
+    {
+        Items.swap(Scratch);
+    }
+}
@@ -0,0 +1,41 @@
+#include "SSBO.h"
+#include "GLState.h"
+
+ShaderStorageBufferObject::ShaderStorageBufferObject()
+{
+    glGenBuffers(1, &BufferID);
+}
+
+ShaderStorageBufferObject::~ShaderStorageBufferObject()
+{
+    GLStateCache::GetInstance().OnBufferDeleted(BufferID);
+    glDeleteBuffers(1, &BufferID);
+}
+
+void ShaderStorageBufferObject::Bind() const
+{
+    GLStateCache::GetInstance().BindBuffer(GL_SHADER_STORAGE_BUFFER, BufferID);
+}
+
+void ShaderStorageBufferObject::Unbind() const
+{
+    GLStateCache::GetInstance().BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void ShaderStorageBufferObject::BindBase(GLuint bindingIndex) const
+{
+    GLStateCache::GetInstance().BindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingIndex, BufferID);
+}
+
+void ShaderStorageBufferObject::UploadData(GLsizeiptr size, const void* data, GLenum usage)
+{
+    Bind();
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage);
+    Size = size;
+}
+
+void ShaderStorageBufferObject::UpdateData(GLintptr offset, GLsizeiptr size, const void* data) const
+{
+    Bind();
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+}
@@ -0,0 +1,128 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Fence waits are retried in slices of this length and every expired slice is reported, so a hung GPU does not block silently
+    constexpr GLuint64 FenceTimeoutNs = 1'000'000'000;
+
+    GLsizeiptr AlignUp(GLsizeiptr value, GLsizeiptr alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+StreamBuffer::StreamBuffer(GLsizeiptr frameSize, uint32 frameCount)
+    : Fences(std::max(frameCount, 1u), nullptr)
+{
+    GLint storageAlignment = 0;
+    GLint uniformAlignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    DefaultAlignment = std::max<GLsizeiptr>({ DefaultAlignment, storageAlignment, uniformAlignment });
+
+    // Regions start on the default alignment, so offsets inside a region keep it
+    FrameSize = AlignUp(std::max<GLsizeiptr>(frameSize, 1), DefaultAlignment);
+    const GLsizeiptr totalSize = FrameSize * static_cast<GLsizeiptr>(Fences.size());
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &BufferID);
+    GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, BufferID);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+    Mapped = static_cast<uint8*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+
+    if (Mapped == nullptr)
+    {
+        std::cerr << "ERROR::STREAM_BUFFER::MAP_FAILED " << totalSize << " bytes" << std::endl;
+    }
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (GLsync fence : Fences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+        }
+    }
+
+    if (Mapped != nullptr)
+    {
+        GLStateCache::GetInstance().BindBuffer(GL_COPY_WRITE_BUFFER, BufferID);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    GLStateCache::GetInstance().OnBufferDeleted(BufferID);
+    glDeleteBuffers(1, &BufferID);
+}
+
+void StreamBuffer::BeginFrame()
+{
+    Frame = (Frame + 1) % static_cast<uint32>(Fences.size());
+    Head = 0;
+
+    GLsync& fence = Fences[Frame];
+    if (fence == nullptr)
+        return;
+
+    // Already signaled in the common case; otherwise flush once so the fence can ever complete
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        ++StallCount;
+        uint32 expiredSlices = 0;
+        while ((result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeoutNs)) == GL_TIMEOUT_EXPIRED)
+        {
+            ++expiredSlices;
+            std::cerr << "ERROR::STREAM_BUFFER::FENCE_TIMEOUT frame " << Frame << " still busy after " << expiredSlices
+                << " waits of " << FenceTimeoutNs / 1'000'000 << " ms" << std::endl;
+        }
+    }
+    if (result == GL_WAIT_FAILED)
+    {
+        std::cerr << "ERROR::STREAM_BUFFER::FENCE_WAIT_FAILED" << std::endl;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+    GLsync& fence = Fences[Frame];
+    if (fence != nullptr)
+    {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamBuffer::Allocation StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+    if (Mapped == nullptr)
+        return {};
+
+    const GLsizeiptr start = AlignUp(Head, alignment > 0 ? alignment : DefaultAlignment);
+    if (start + size > FrameSize)
+    {
+        std::cerr << "ERROR::STREAM_BUFFER::FRAME_FULL " << size << " bytes requested, "
+            << FrameSize - Head << " left" << std::endl;
+        return {};
+    }
+    Head = start + size;
+
+    const GLintptr offset = static_cast<GLintptr>(Frame) * FrameSize + start;
+    return Allocation{ Mapped + offset, offset, size };
+}
+
+void StreamBuffer::BindRange(GLenum target, GLuint bindingIndex, const Allocation& allocation) const
+{
+    GLStateCache::GetInstance().BindBufferRange(target, bindingIndex, BufferID, allocation.Offset, allocation.Size);
+}
+
+void StreamBuffer::Bind(GLenum target) const
+{
+    GLStateCache::GetInstance().BindBuffer(target, BufferID);
+}
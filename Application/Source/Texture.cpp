@@ -3,11 +3,12 @@
 #include "stb_image.h"
 #include <iostream>
 #include <Shaders.h>
+#include "GLState.h"
 
 Texture::Texture(const std::string& path)
 {
     glGenTextures(1, &Data.ImageData.TextureID);
-    glBindTexture(GL_TEXTURE_2D, Data.ImageData.TextureID);
+    GLStateCache::GetInstance().BindTexture(GL_TEXTURE_2D, Data.ImageData.TextureID);
 
     // Set texture wrapping and filtering options
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -44,23 +45,23 @@ Texture::Texture(const std::string& path)
 
 Texture::~Texture()
 {
+    GLStateCache::GetInstance().OnTextureDeleted(Data.ImageData.TextureID);
     glDeleteTextures(1, &Data.ImageData.TextureID);
 }
 
 void Texture::Bind() const
 {
-    glBindTexture(GL_TEXTURE_2D, Data.ImageData.TextureID);
+    GLStateCache::GetInstance().BindTexture(GL_TEXTURE_2D, Data.ImageData.TextureID);
 }
 
 void Texture::Bind(const uint8 Slot) const
 {
-    glActiveTexture(GL_TEXTURE0 + Slot);
-	glBindTexture(GL_TEXTURE_2D, Data.ImageData.TextureID);
+    GLStateCache::GetInstance().BindTextureUnit(Slot, GL_TEXTURE_2D, Data.ImageData.TextureID);
 }
 
 void Texture::Unbind() const
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::GetInstance().BindTexture(GL_TEXTURE_2D, 0);
 }
 
 unsigned char* Texture::LoadImage(const std::string& path, int* width, int* height, int* nrChannels)
@@ -88,7 +89,7 @@ void Texture::BindTextureToShader(GLuint unit, const GraphicsShader& shader, std
     }
 
     // Activate the specified texture unit.
-    glActiveTexture(GL_TEXTURE0 + unit);
+    GLStateCache::GetInstance().ActiveTexture(unit);
 
     // Bind the texture to the current active texture unit.
     Bind();
@@ -0,0 +1,177 @@
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    // translate(position) * mat4_cast(rotation) * scale(scale)
+    glm::mat4 ComposeLocal(const TransformHierarchy::LocalTransform& local)
+    {
+        glm::mat4 matrix = glm::mat4_cast(local.Rotation);
+        matrix[0] *= local.Scale.x;
+        matrix[1] *= local.Scale.y;
+        matrix[2] *= local.Scale.z;
+        matrix[3] = glm::vec4(local.Position, 1.0f);
+        return matrix;
+    }
+}
+
+void TransformHierarchy::Reserve(size_t count)
+{
+    Locals.reserve(count);
+    Worlds.reserve(count);
+    Parents.reserve(count);
+    FirstChildren.reserve(count);
+    LastChildren.reserve(count);
+    NextSiblings.reserve(count);
+    Dirty.reserve(count);
+    DirtyNodes.reserve(count);
+}
+
+uint32 TransformHierarchy::Add(const LocalTransform& local, uint32 parent)
+{
+    const uint32 index = static_cast<uint32>(Locals.size());
+    if (parent != NoParent && parent >= index) [[unlikely]]
+    {
+        std::cerr << "ERROR::TRANSFORM_HIERARCHY::INVALID_PARENT " << parent << ", added as a root" << std::endl;
+        parent = NoParent;
+    }
+
+    Locals.push_back(local);
+    Worlds.push_back(glm::mat4(1.0f));
+    Parents.push_back(parent);
+    FirstChildren.push_back(NoParent);
+    LastChildren.push_back(NoParent);
+    NextSiblings.push_back(NoParent);
+    Dirty.push_back(0);
+
+    if (parent != NoParent)
+    {
+        if (LastChildren[parent] == NoParent)
+            FirstChildren[parent] = index;
+        else
+            NextSiblings[LastChildren[parent]] = index;
+        LastChildren[parent] = index;
+    }
+
+    MarkDirty(index);
+    return index;
+}
+
+void TransformHierarchy::Clear()
+{
+    Locals.clear();
+    Worlds.clear();
+    Parents.clear();
+    FirstChildren.clear();
+    LastChildren.clear();
+    NextSiblings.clear();
+    Dirty.clear();
+    DirtyNodes.clear();
+    DirtyRoots.clear();
+}
+
+void TransformHierarchy::SetLocal(uint32 index, const LocalTransform& local)
+{
+    Locals[index] = local;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetPosition(uint32 index, const glm::vec3& position)
+{
+    Locals[index].Position = position;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetRotation(uint32 index, const glm::quat& rotation)
+{
+    Locals[index].Rotation = rotation;
+    MarkDirty(index);
+}
+
+size_t TransformHierarchy::Update()
+{
+    if (DirtyNodes.empty())
+        return 0;
+
+    // Dirty nodes below another dirty node are rebuilt with that node's subtree
+    DirtyRoots.clear();
+    for (const uint32 index : DirtyNodes)
+    {
+        if (!HasDirtyAncestor(index))
+            DirtyRoots.push_back(index);
+    }
+    DirtyNodes.clear();
+
+    // The subtrees are disjoint and none contains an ancestor of another, so jobs never write what others read
+    std::atomic<size_t> updated = 0;
+    JobSystem::GetInstance().ParallelFor(DirtyRoots.size(), SubtreesPerTask, [this, &updated](size_t begin, size_t end) {
+        std::vector<uint32> stack;
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            count += UpdateSubtree(DirtyRoots[i], stack);
+        }
+        updated.fetch_add(count, std::memory_order_relaxed);
+    });
+    return updated.load(std::memory_order_relaxed);
+}
+
+void TransformHierarchy::UpdateAll()
+{
+    // Parents precede their children, so their world matrices are always current here
+    for (uint32 index = 0; index < Locals.size(); ++index)
+    {
+        UpdateWorld(index);
+        Dirty[index] = 0;
+    }
+    DirtyNodes.clear();
+}
+
+void TransformHierarchy::MarkDirty(uint32 index)
+{
+    if (Dirty[index] == 0)
+    {
+        Dirty[index] = 1;
+        DirtyNodes.push_back(index);
+    }
+}
+
+bool TransformHierarchy::HasDirtyAncestor(uint32 index) const
+{
+    for (uint32 parent = Parents[index]; parent != NoParent; parent = Parents[parent])
+    {
+        if (Dirty[parent] != 0)
+            return true;
+    }
+    return false;
+}
+
+size_t TransformHierarchy::UpdateSubtree(uint32 root, std::vector<uint32>& stack)
+{
+    size_t count = 0;
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        const uint32 index = stack.back();
+        stack.pop_back();
+
+        UpdateWorld(index);
+        Dirty[index] = 0;
+        ++count;
+
+        for (uint32 child = FirstChildren[index]; child != NoParent; child = NextSiblings[child])
+        {
+            stack.push_back(child);
+        }
+    }
+    return count;
+}
+
+void TransformHierarchy::UpdateWorld(uint32 index)
+{
+    const uint32 parent = Parents[index];
+    Worlds[index] = parent == NoParent ? ComposeLocal(Locals[index]) : Worlds[parent] * ComposeLocal(Locals[index]);
+}
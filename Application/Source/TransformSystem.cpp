@@ -0,0 +1,205 @@
+#include "TransformSystem.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace
+{
+    static_assert(TransformSystem::TaskGrainSize % TransformSystem::BatchWidth == 0, "Tasks must cover whole batches");
+
+    constexpr float DegreesToRadians = 0.01745329251994329577f;
+
+    // Cody-Waite split of pi/2, the leading parts have enough trailing zero bits for exact products
+    constexpr float TwoOverPi = 0.636619772367581343f;
+    constexpr float PiOverTwo1 = 1.5703125f;
+    constexpr float PiOverTwo2 = 4.837512969970703125e-4f;
+    constexpr float PiOverTwo3 = 7.54978995489188216e-8f;
+
+    // Minimax polynomials on [-pi/4, pi/4] (Cephes sinf / cosf)
+    constexpr float Sin1 = -1.6666654611e-1f;
+    constexpr float Sin2 = 8.3321608736e-3f;
+    constexpr float Sin3 = -1.9515295891e-4f;
+    constexpr float Cos1 = 4.166664568298827e-2f;
+    constexpr float Cos2 = -1.388731625493765e-3f;
+    constexpr float Cos3 = 2.443315711809948e-5f;
+
+    // Transposes one matrix column of 4 objects from SoA to AoS and stores it
+    inline void StoreColumn(Simd::Sse2::Float x, Simd::Sse2::Float y, Simd::Sse2::Float z, Simd::Sse2::Float w, glm::mat4* models, int column)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_store_ps(&models[0][column][0], x);
+        _mm_store_ps(&models[1][column][0], y);
+        _mm_store_ps(&models[2][column][0], z);
+        _mm_store_ps(&models[3][column][0], w);
+    }
+
+#ifdef __AVX2__
+    // Same as the SSE2 version, each 128-bit half transposes the columns of 4 objects
+    inline void StoreColumn(Simd::Avx2::Float x, Simd::Avx2::Float y, Simd::Avx2::Float z, Simd::Avx2::Float w, glm::mat4* models, int column)
+    {
+        using Float = Simd::Avx2::Float;
+        const Float xy0 = _mm256_unpacklo_ps(x, y);
+        const Float xy1 = _mm256_unpackhi_ps(x, y);
+        const Float zw0 = _mm256_unpacklo_ps(z, w);
+        const Float zw1 = _mm256_unpackhi_ps(z, w);
+
+        const Float object04 = _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0));
+        const Float object15 = _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2));
+        const Float object26 = _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0));
+        const Float object37 = _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2));
+
+        _mm_store_ps(&models[0][column][0], _mm256_castps256_ps128(object04));
+        _mm_store_ps(&models[1][column][0], _mm256_castps256_ps128(object15));
+        _mm_store_ps(&models[2][column][0], _mm256_castps256_ps128(object26));
+        _mm_store_ps(&models[3][column][0], _mm256_castps256_ps128(object37));
+        _mm_store_ps(&models[4][column][0], _mm256_extractf128_ps(object04, 1));
+        _mm_store_ps(&models[5][column][0], _mm256_extractf128_ps(object15, 1));
+        _mm_store_ps(&models[6][column][0], _mm256_extractf128_ps(object26, 1));
+        _mm_store_ps(&models[7][column][0], _mm256_extractf128_ps(object37, 1));
+    }
+#endif
+
+    // sin and cos of every lane: reduce to [-pi/4, pi/4] by quadrant, evaluate both polynomials, then swap and negate per quadrant
+    template <typename V>
+    inline void SinCos(typename V::Float x, typename V::Float& sine, typename V::Float& cosine)
+    {
+        const typename V::Int quadrant = V::RoundToInt(V::Mul(x, V::Set(TwoOverPi)));
+        const typename V::Float q = V::ToFloat(quadrant);
+
+        typename V::Float r = V::Sub(x, V::Mul(q, V::Set(PiOverTwo1)));
+        r = V::Sub(r, V::Mul(q, V::Set(PiOverTwo2)));
+        r = V::Sub(r, V::Mul(q, V::Set(PiOverTwo3)));
+        const typename V::Float r2 = V::Mul(r, r);
+
+        typename V::Float sinPoly = V::Add(V::Set(Sin2), V::Mul(r2, V::Set(Sin3)));
+        sinPoly = V::Add(V::Set(Sin1), V::Mul(r2, sinPoly));
+        sinPoly = V::Add(r, V::Mul(V::Mul(r, r2), sinPoly));
+
+        typename V::Float cosPoly = V::Add(V::Set(Cos2), V::Mul(r2, V::Set(Cos3)));
+        cosPoly = V::Add(V::Set(Cos1), V::Mul(r2, cosPoly));
+        cosPoly = V::Add(V::Sub(V::Set(1.0f), V::Mul(r2, V::Set(0.5f))), V::Mul(V::Mul(r2, r2), cosPoly));
+
+        // Odd quadrants swap sin and cos, quadrants 2-3 negate sin and 1-2 negate cos
+        const typename V::Float swap = V::EqualMask(V::AndInt(quadrant, 1), 1);
+        const typename V::Float sinSign = V::SignFromBit1(V::AndInt(quadrant, 2));
+        const typename V::Float cosSign = V::SignFromBit1(V::AndInt(V::AddInt(quadrant, 1), 2));
+
+        sine = V::Xor(V::Select(swap, cosPoly, sinPoly), sinSign);
+        cosine = V::Xor(V::Select(swap, sinPoly, cosPoly), cosSign);
+    }
+
+    struct TransformArrays
+    {
+        const float* PositionX;
+        const float* PositionY;
+        const float* PositionZ;
+        const float* AxisX;
+        const float* AxisY;
+        const float* AxisZ;
+        const float* AngularSpeed;
+        glm::mat4* Models;
+    };
+
+    // translate(p) * rotate(angle, a) written out per element, same formula as glm::rotate
+    template <typename V>
+    void BuildModels(const TransformArrays& arrays, float time, size_t begin, size_t end)
+    {
+        using Float = typename V::Float;
+        const Float timeVector = V::Set(time);
+        const Float zero = V::Set(0.0f);
+        const Float one = V::Set(1.0f);
+
+        for (size_t i = begin; i < end; i += V::Width)
+        {
+            const Float ax = V::Load(arrays.AxisX + i);
+            const Float ay = V::Load(arrays.AxisY + i);
+            const Float az = V::Load(arrays.AxisZ + i);
+
+            Float s, c;
+            SinCos<V>(V::Mul(timeVector, V::Load(arrays.AngularSpeed + i)), s, c);
+
+            const Float t = V::Sub(one, c);
+            const Float tx = V::Mul(t, ax);
+            const Float ty = V::Mul(t, ay);
+            const Float tz = V::Mul(t, az);
+            const Float sx = V::Mul(s, ax);
+            const Float sy = V::Mul(s, ay);
+            const Float sz = V::Mul(s, az);
+
+            glm::mat4* models = arrays.Models + i;
+            StoreColumn(V::Add(c, V::Mul(tx, ax)), V::Add(V::Mul(tx, ay), sz), V::Sub(V::Mul(tx, az), sy), zero, models, 0);
+            StoreColumn(V::Sub(V::Mul(ty, ax), sz), V::Add(c, V::Mul(ty, ay)), V::Add(V::Mul(ty, az), sx), zero, models, 1);
+            StoreColumn(V::Add(V::Mul(tz, ax), sy), V::Sub(V::Mul(tz, ay), sx), V::Add(c, V::Mul(tz, az)), zero, models, 2);
+            StoreColumn(V::Load(arrays.PositionX + i), V::Load(arrays.PositionY + i), V::Load(arrays.PositionZ + i), one, models, 3);
+        }
+    }
+
+    constexpr size_t RoundUpToBatch(size_t count)
+    {
+        return (count + TransformSystem::BatchWidth - 1) / TransformSystem::BatchWidth * TransformSystem::BatchWidth;
+    }
+}
+
+void TransformSystem::Reserve(size_t count)
+{
+    const size_t padded = RoundUpToBatch(count);
+    for (AlignedVector<float>* array : { &PositionX, &PositionY, &PositionZ, &AxisX, &AxisY, &AxisZ, &AngularSpeed })
+    {
+        array->reserve(padded);
+    }
+    Models.reserve(padded);
+}
+
+uint32 TransformSystem::Add(const glm::vec3& position, const glm::vec3& axis, float degreesPerSecond)
+{
+    const size_t index = Count++;
+    const size_t padded = RoundUpToBatch(Count);
+
+    // Padding lanes spin around +Y at zero speed, their matrices are valid but never read
+    PositionX.resize(padded, 0.0f);
+    PositionY.resize(padded, 0.0f);
+    PositionZ.resize(padded, 0.0f);
+    AxisX.resize(padded, 0.0f);
+    AxisY.resize(padded, 1.0f);
+    AxisZ.resize(padded, 0.0f);
+    AngularSpeed.resize(padded, 0.0f);
+    Models.resize(padded, glm::mat4(1.0f));
+
+    const glm::vec3 unitAxis = glm::normalize(axis);
+    PositionX[index] = position.x;
+    PositionY[index] = position.y;
+    PositionZ[index] = position.z;
+    AxisX[index] = unitAxis.x;
+    AxisY[index] = unitAxis.y;
+    AxisZ[index] = unitAxis.z;
+    AngularSpeed[index] = degreesPerSecond * DegreesToRadians;
+
+    return static_cast<uint32>(index);
+}
+
+void TransformSystem::Clear()
+{
+    Count = 0;
+    for (AlignedVector<float>* array : { &PositionX, &PositionY, &PositionZ, &AxisX, &AxisY, &AxisZ, &AngularSpeed })
+    {
+        array->clear();
+    }
+    Models.clear();
+}
+
+void TransformSystem::Update(float time)
+{
+    JobSystem::GetInstance().ParallelFor(Count, TaskGrainSize, [this, time](size_t begin, size_t end) {
+        UpdateRange(time, begin, end);
+    });
+}
+
+void TransformSystem::UpdateRange(float time, size_t begin, size_t end)
+{
+    const TransformArrays arrays{
+        PositionX.data(), PositionY.data(), PositionZ.data(),
+        AxisX.data(), AxisY.data(), AxisZ.data(),
+        AngularSpeed.data(), Models.data()
+    };
+
+    BuildModels<Simd::Native>(arrays, time, begin - begin % BatchWidth, std::min(RoundUpToBatch(end), Models.size()));
+}
@@ -1,47 +1,95 @@
 #include "VAO.h"
+#include <cstdint>
 
 // Constructor
 VertexArrayObject::VertexArrayObject()
 {
+#if USE_DSA
+    glCreateVertexArrays(1, &ArrayID);
+#else
     glGenVertexArrays(1, &ArrayID);
+#endif
 }
 
 // Destructor
 VertexArrayObject::~VertexArrayObject()
 {
+    GLStateCache::GetInstance().OnVertexArrayDeleted(ArrayID);
     glDeleteVertexArrays(1, &ArrayID);
 }
 
 // Bind the VAO
 void VertexArrayObject::Bind() const
 {
-    glBindVertexArray(ArrayID);
+    GLStateCache::GetInstance().BindVertexArray(ArrayID);
 }
 
 // Unbind the VAO
 void VertexArrayObject::Unbind() const
 {
-    glBindVertexArray(0);
+    GLStateCache::GetInstance().BindVertexArray(0);
 }
 
 // Attach a Vertex Buffer Object (VBO) to the VAO
 void VertexArrayObject::AttachVertexBuffer(const GLuint vboID) const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, vboID);
+#if USE_DSA
+    VertexBufferID = vboID;
+    glVertexArrayVertexBuffer(ArrayID, 0, VertexBufferID, 0, VertexStride);
+#else
+    GLStateCache::GetInstance().BindBuffer(GL_ARRAY_BUFFER, vboID);
+#endif
 }
 
 // Attach an Element Buffer Object (EBO) to the VAO
 void VertexArrayObject::AttachElementBuffer(const GLuint eboID) const
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboID);
+#if USE_DSA
+    glVertexArrayElementBuffer(ArrayID, eboID);
+#else
+    GLStateCache::GetInstance().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboID);
+#endif
 }
 
 // Enable vertex attribute arrays and set vertex attribute pointers
 void VertexArrayObject::EnableAttribute(
     GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) const
 {
+#if USE_DSA
+    // Integer attributes keep glVertexAttribPointer semantics: converted to float, normalized on request
+    const GLuint relativeOffset = static_cast<GLuint>(reinterpret_cast<uintptr_t>(pointer));
+    glVertexArrayAttribFormat(ArrayID, index, size, type, normalized, relativeOffset);
+    glVertexArrayAttribBinding(ArrayID, index, 0);
+    glEnableVertexArrayAttrib(ArrayID, index);
+
+    if (stride != VertexStride)
+    {
+        VertexStride = stride;
+        glVertexArrayVertexBuffer(ArrayID, 0, VertexBufferID, 0, VertexStride);
+    }
+#else
     glVertexAttribPointer(index, size, type, normalized, stride, pointer);
     glEnableVertexAttribArray(index);
+#endif
+}
+
+// Enable an integer vertex attribute
+void VertexArrayObject::EnableIntegerAttribute(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) const
+{
+#if USE_DSA
+    glVertexArrayAttribIFormat(ArrayID, index, size, type, static_cast<GLuint>(reinterpret_cast<uintptr_t>(pointer)));
+    glVertexArrayAttribBinding(ArrayID, index, 0);
+    glEnableVertexArrayAttrib(ArrayID, index);
+
+    if (stride != VertexStride)
+    {
+        VertexStride = stride;
+        glVertexArrayVertexBuffer(ArrayID, 0, VertexBufferID, 0, VertexStride);
+    }
+#else
+    glVertexAttribIPointer(index, size, type, stride, pointer);
+    glEnableVertexAttribArray(index);
+#endif
 }
 
 // GlobalVAO implementation
\ No newline at end of file
@@ -1,11 +1,58 @@
 #include "VBO.h"
+#include "GLState.h"
 
 VertexBufferObject::VertexBufferObject()
 {
+#if USE_DSA
+    glCreateBuffers(1, &BufferID);
+#else
     glGenBuffers(1, &BufferID);
+#endif
 }
 
 VertexBufferObject::~VertexBufferObject()
 {
+    GLStateCache::GetInstance().OnBufferDeleted(BufferID);
     glDeleteBuffers(1, &BufferID);
-}
\ No newline at end of file
+}
+
+bool VertexBufferObject::UploadData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+#if USE_DSA
+    (void)target;
+
+    // Immutable storage is updated in place while the data fits, so VAOs attached to BufferID stay valid
+    if (Immutable && usage == GL_STATIC_DRAW && size <= StorageSize)
+    {
+        if (data != nullptr)
+        {
+            glNamedBufferSubData(BufferID, 0, size, data);
+        }
+        return false;
+    }
+
+    const bool replaced = Immutable;
+    if (Immutable)
+    {
+        GLStateCache::GetInstance().OnBufferDeleted(BufferID);
+        glDeleteBuffers(1, &BufferID);
+        glCreateBuffers(1, &BufferID);
+        Immutable = false;
+    }
+
+    if (usage == GL_STATIC_DRAW)
+    {
+        glNamedBufferStorage(BufferID, size, data, GL_DYNAMIC_STORAGE_BIT);
+        Immutable = true;
+        StorageSize = size;
+    }
+    else
+    {
+        glNamedBufferData(BufferID, size, data, usage);
+    }
+    return replaced;
+#else
+    glBufferData(target, size, data, usage);
+    return false;
+#endif
+}
@@ -1,115 +1,103 @@
 #include "Vertex.h"
+#include <algorithm>
+#include <cmath>
 
 //==============================================================================
-// 1. Implementation of GetAttributes methods for each VertexLayout specialization
+// 1. Explicit instantiation of Vertex templates
 //==============================================================================
 
-// Specialization for VertexPos2D
-std::vector<VertexAttrib> VertexLayout<VertexPos2D>::GetAttributes()
-{
-    return {// Position: location 0, 2 components (vec2), not normalized
-        {0, 2, GL_FLOAT, sizeof(VertexPos2D), OFFSET_OF(VertexPos2D, pos), GL_FALSE}};
-}
+template class Vertex<VertexPos2D>;
+template class Vertex<VertexPosUV2D>;
+template class Vertex<VertexPosColorUV>;
+template class Vertex<VertexPos3D>;
+template class Vertex<VertexPosNormal3D>;
+template class Vertex<VertexPosNormalUV3D>;
+template class Vertex<VertexPosColor3D>;
+template class Vertex<VertexPosColorUV3D>;
+template class Vertex<VertexPosNormalTangentUV3D>;
+template class Vertex<VertexPackedPosNormalTangentUV3D>;
 
-// Specialization for VertexPosUV2D
-std::vector<VertexAttrib> VertexLayout<VertexPosUV2D>::GetAttributes()
-{
-    return {// Position: location 0, 2 components (vec2)
-        {0, 2, GL_FLOAT, sizeof(VertexPosUV2D), OFFSET_OF(VertexPosUV2D, pos), GL_FALSE},
-        // UV coordinates: location 1, 2 components (vec2)
-        {1, 2, GL_FLOAT, sizeof(VertexPosUV2D), OFFSET_OF(VertexPosUV2D, uv), GL_FALSE}};
-}
+//==============================================================================
+// 2. Conversion between the float and the packed vertex formats
+//==============================================================================
 
-// Specialization for VertexPosUV3D
-std::vector<VertexAttrib> VertexLayout<VertexPosUV3D>::GetAttributes()
+namespace
 {
-    return {// Position: location 0, 2 components (vec2)
-        {0, 3, GL_FLOAT, sizeof(VertexPosUV3D), OFFSET_OF(VertexPosUV3D, pos), GL_FALSE},
-        // UV coordinates: location 1, 2 components (vec2)
-        {1, 2, GL_FLOAT, sizeof(VertexPosUV3D), OFFSET_OF(VertexPosUV3D, uv), GL_FALSE} };
-}
+    // Signed normalized component of `bits` bits, GL maps the most negative value to -1 as well
+    uint32_t PackSnorm(float value, uint32_t bits)
+    {
+        const float scale = static_cast<float>((1u << (bits - 1)) - 1);
+        const int32_t quantized = static_cast<int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * scale));
+        return static_cast<uint32_t>(quantized) & ((1u << bits) - 1);
+    }
 
-// Specialization for VertexPosColorUV
-std::vector<VertexAttrib> VertexLayout<VertexPosColorUV>::GetAttributes()
-{
-    return {// Position: location 0, 2 components (vec2)
-        {0, 2, GL_FLOAT, sizeof(VertexPosColorUV), OFFSET_OF(VertexPosColorUV, pos), GL_FALSE},
-        // Color: location 1, 3 components (vec3)
-        {1, 3, GL_FLOAT, sizeof(VertexPosColorUV), OFFSET_OF(VertexPosColorUV, color), GL_FALSE},
-        // UV coordinates: location 2, 2 components (vec2)
-        {2, 2, GL_FLOAT, sizeof(VertexPosColorUV), OFFSET_OF(VertexPosColorUV, uv), GL_FALSE}};
-}
+    float UnpackSnorm(uint32_t packed, uint32_t bits)
+    {
+        // Shift the sign bit of the field to bit 31 and back to sign-extend it
+        const int32_t value = static_cast<int32_t>(packed << (32 - bits)) >> (32 - bits);
+        const float scale = static_cast<float>((1u << (bits - 1)) - 1);
+        return std::max(static_cast<float>(value) / scale, -1.0f);
+    }
 
-// Specialization for VertexPos3D
-std::vector<VertexAttrib> VertexLayout<VertexPos3D>::GetAttributes()
-{
-    return {// Position: location 0, 3 components (vec3)
-        {0, 3, GL_FLOAT, sizeof(VertexPos3D), OFFSET_OF(VertexPos3D, pos), GL_FALSE}};
+    Half2 PackHalf2(float x, float y)
+    {
+        const uint32_t packed = glm::packHalf2x16(glm::vec2(x, y));
+        return Half2{ static_cast<uint16_t>(packed & 0xFFFFu), static_cast<uint16_t>(packed >> 16) };
+    }
+
+    glm::vec2 UnpackHalf2(uint16_t x, uint16_t y)
+    {
+        return glm::unpackHalf2x16(static_cast<uint32_t>(x) | (static_cast<uint32_t>(y) << 16));
+    }
 }
 
-// Specialization for VertexPosNormal3D
-std::vector<VertexAttrib> VertexLayout<VertexPosNormal3D>::GetAttributes()
+uint32_t PackSnorm2_10_10_10(const glm::vec4& value)
 {
-    return {// Position: location 0, 3 components (vec3)
-        {0, 3, GL_FLOAT, sizeof(VertexPosNormal3D), OFFSET_OF(VertexPosNormal3D, pos), GL_FALSE},
-        // Normal: location 1, 3 components (vec3)
-        {1, 3, GL_FLOAT, sizeof(VertexPosNormal3D), OFFSET_OF(VertexPosNormal3D, normal), GL_FALSE}};
+    return PackSnorm(value.x, 10) | (PackSnorm(value.y, 10) << 10) | (PackSnorm(value.z, 10) << 20) | (PackSnorm(value.w, 2) << 30);
 }
 
-// Specialization for VertexPosNormalUV3D
-std::vector<VertexAttrib> VertexLayout<VertexPosNormalUV3D>::GetAttributes()
+glm::vec4 UnpackSnorm2_10_10_10(uint32_t packed)
 {
-    return {// Position: location 0, 3 components (vec3)
-        {0, 3, GL_FLOAT, sizeof(VertexPosNormalUV3D), OFFSET_OF(VertexPosNormalUV3D, pos), GL_FALSE},
-        // Normal: location 1, 3 components (vec3)
-        {1, 3, GL_FLOAT, sizeof(VertexPosNormalUV3D), OFFSET_OF(VertexPosNormalUV3D, normal), GL_FALSE},
-        // UV coordinates: location 2, 2 components (vec2)
-        {2, 2, GL_FLOAT, sizeof(VertexPosNormalUV3D), OFFSET_OF(VertexPosNormalUV3D, uv), GL_FALSE}};
+    return glm::vec4(UnpackSnorm(packed & 0x3FFu, 10), UnpackSnorm((packed >> 10) & 0x3FFu, 10),
+        UnpackSnorm((packed >> 20) & 0x3FFu, 10), UnpackSnorm(packed >> 30, 2));
 }
 
-// Specialization for VertexPosColor3D
-std::vector<VertexAttrib> VertexLayout<VertexPosColor3D>::GetAttributes()
+VertexPackedPosNormalTangentUV3D PackVertex(const VertexPosNormalTangentUV3D& vertex)
 {
-    return {// Position: location 0, 3 components (vec3)
-        {0, 3, GL_FLOAT, sizeof(VertexPosColor3D), OFFSET_OF(VertexPosColor3D, pos), GL_FALSE},
-        // Color: location 1, 3 components (vec3)
-        {1, 3, GL_FLOAT, sizeof(VertexPosColor3D), OFFSET_OF(VertexPosColor3D, color), GL_FALSE}};
+    const Half2 xy = PackHalf2(vertex.pos.x, vertex.pos.y);
+    const Half2 zw = PackHalf2(vertex.pos.z, 1.0f);
+
+    VertexPackedPosNormalTangentUV3D packed{};
+    packed.pos = Half4{ xy.x, xy.y, zw.x, zw.y };
+
+    // 10 bits per component keep directions within about 0.1 degrees
+    packed.normal.bits = PackSnorm2_10_10_10(glm::vec4(vertex.normal, 0.0f));
+    packed.tangent.bits = PackSnorm2_10_10_10(glm::vec4(vertex.tangent, 1.0f));  // No handedness to store, see the struct
+
+    packed.uv = PackHalf2(vertex.uv.x, vertex.uv.y);
+    return packed;
 }
 
-// Specialization for VertexPosColorUV3D
-std::vector<VertexAttrib> VertexLayout<VertexPosColorUV3D>::GetAttributes()
+VertexPosNormalTangentUV3D UnpackVertex(const VertexPackedPosNormalTangentUV3D& vertex)
 {
-    return {// Position: location 0, 3 components (vec3)
-        {0, 3, GL_FLOAT, sizeof(VertexPosColorUV3D), OFFSET_OF(VertexPosColorUV3D, pos), GL_FALSE},
-        // Color: location 1, 3 components (vec3)
-        {1, 3, GL_FLOAT, sizeof(VertexPosColorUV3D), OFFSET_OF(VertexPosColorUV3D, color), GL_FALSE},
-        // UV coordinates: location 2, 2 components (vec2)
-        {2, 2, GL_FLOAT, sizeof(VertexPosColorUV3D), OFFSET_OF(VertexPosColorUV3D, uv), GL_FALSE}};
+    const glm::vec2 xy = UnpackHalf2(vertex.pos.x, vertex.pos.y);
+    const glm::vec2 zw = UnpackHalf2(vertex.pos.z, vertex.pos.w);
+
+    VertexPosNormalTangentUV3D unpacked{};
+    unpacked.pos = glm::vec3(xy.x, xy.y, zw.x);
+    unpacked.normal = glm::vec3(UnpackSnorm2_10_10_10(vertex.normal.bits));
+    unpacked.tangent = glm::vec3(UnpackSnorm2_10_10_10(vertex.tangent.bits));
+    unpacked.uv = UnpackHalf2(vertex.uv.x, vertex.uv.y);
+    return unpacked;
 }
 
-// Specialization for VertexPosNormalTangentUV3D
-std::vector<VertexAttrib> VertexLayout<VertexPosNormalTangentUV3D>::GetAttributes()
+std::vector<VertexPackedPosNormalTangentUV3D> PackVertices(std::span<const VertexPosNormalTangentUV3D> vertices)
 {
-    return {// Position: location 0, 3 components (vec3)
-        {0, 3, GL_FLOAT, sizeof(VertexPosNormalTangentUV3D), OFFSET_OF(VertexPosNormalTangentUV3D, pos), GL_FALSE},
-        // Normal: location 1, 3 components (vec3)
-        {1, 3, GL_FLOAT, sizeof(VertexPosNormalTangentUV3D), OFFSET_OF(VertexPosNormalTangentUV3D, normal), GL_FALSE},
-        // Tangent: location 2, 3 components (vec3)
-        {2, 3, GL_FLOAT, sizeof(VertexPosNormalTangentUV3D), OFFSET_OF(VertexPosNormalTangentUV3D, tangent), GL_FALSE},
-        // UV coordinates: location 3, 2 components (vec2)
-        {3, 2, GL_FLOAT, sizeof(VertexPosNormalTangentUV3D), OFFSET_OF(VertexPosNormalTangentUV3D, uv), GL_FALSE}};
+    std::vector<VertexPackedPosNormalTangentUV3D> packed;
+    packed.reserve(vertices.size());
+    for (const VertexPosNormalTangentUV3D& vertex : vertices)
+    {
+        packed.push_back(PackVertex(vertex));
+    }
+    return packed;
 }
-
-//==============================================================================
-// 2. Explicit instantiation of Vertex templates
-//==============================================================================
-
-template class Vertex<VertexPos2D>;
-template class Vertex<VertexPosUV2D>;
-template class Vertex<VertexPosColorUV>;
-template class Vertex<VertexPos3D>;
-template class Vertex<VertexPosNormal3D>;
-template class Vertex<VertexPosNormalUV3D>;
-template class Vertex<VertexPosColor3D>;
-template class Vertex<VertexPosColorUV3D>;
-template class Vertex<VertexPosNormalTangentUV3D>;
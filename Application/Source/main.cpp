@@ -9,12 +9,33 @@
 #include "Light.h"
 #include "Cube.h"
 #include "Maths.h"
+#include "MeshRegistry.h"
+#include "IndirectBuffer.h"
+#include "InstanceData.h"
+#include "GPUCulling.h"
+#include "Frustum.h"
+#include "Material.h"
+#include "RenderQueue.h"
+#include "GLState.h"
+#include "Benchmark.h"
+#include "OffscreenContext.h"
+#include "FBO.h"
+#include "TransformSystem.h"
+#include "JobSystem.h"
+#include "CullingSystem.h"
+#include "LooseOctree.h"
+#include "OcclusionCuller.h"
+#include "StreamBuffer.h"
+#include "MeshCache.h"
+#include "Meshlet.h"
 
 #include <array>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <string_view>
 #include <vector>
 #include <random>
-#include <execution>
 #include <future>
 
 
@@ -22,39 +43,91 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// Model matrices live in TransformSystem and bounds in CullingSystem, both indexed like the draw commands
 struct DrawCommand {
-	glm::mat4 model;
+	MeshHandle mesh;
 	size_t materialIndex;
-	bool visible;
+	uint32_t lod = 0; // Detail level picked from the projected size, refreshed every frame
 };
 
 
-// Material structure
-struct MaterialData {
-	glm::vec3 Color;
-	float Intensity;
-	glm::vec3 Ambient;
-	glm::vec3 Diffuse;
-	glm::vec3 Specular;
-	float Shininess;
-};
-
 // Global variables
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 bool keys[1024] = { false };
 
+// How visible cubes are submitted to the GPU (cycle with I for A/B frame-time comparison)
+enum class SubmitMode {
+	PerDraw,           // One glDrawElements plus model and material index uniforms per cube
+	Instanced,         // One glDrawElementsInstanced over the packed instance buffer
+	MultiDrawIndirect, // One glMultiDrawElementsIndirect over compacted indirect commands
+	VertexPulling,     // Multi-draw indirect without vertex attributes, the shader fetches vertices from storage buffers
+	GPUDriven,         // Compute shader culls and writes the indirect command, no per-object CPU work
+	Meshlet,           // Terrain instead of cubes, a compute shader culls its meshlets into an indirect multi-draw
+	Count
+};
+
+SubmitMode submitMode = SubmitMode::Instanced;
+
+// Vertex pulling keeps a second copy of every mesh and the meshlet terrain has millions of triangles,
+// so both are only set up when the run starts in their mode
+bool vertexPullingAvailable = false;
+bool meshletsAvailable = false;
+
+// Order visible draws by sort key before submission (toggle with O)
+bool sortDraws = true;
+
+// Cull through the loose octree instead of scanning every bounding sphere (toggle with C)
+bool octreeCulling = false;
+
+// Test frustum survivors against a CPU depth buffer of the nearest cubes (toggle with V)
+bool occlusionCulling = true;
+
+static const char* submitModeName(SubmitMode mode) {
+	switch (mode) {
+	case SubmitMode::PerDraw: return "per-draw";
+	case SubmitMode::Instanced: return "instanced";
+	case SubmitMode::MultiDrawIndirect: return "multi-draw indirect";
+	case SubmitMode::VertexPulling: return "vertex pulling";
+	case SubmitMode::GPUDriven: return "GPU-driven";
+	case SubmitMode::Meshlet: return "meshlet";
+	case SubmitMode::Count: break;
+	}
+	return "unknown";
+}
+
+// Short names accepted by --mode
+static bool parseSubmitMode(std::string_view name, SubmitMode& mode) {
+	if (name == "per-draw") mode = SubmitMode::PerDraw;
+	else if (name == "instanced") mode = SubmitMode::Instanced;
+	else if (name == "mdi") mode = SubmitMode::MultiDrawIndirect;
+	else if (name == "pull") mode = SubmitMode::VertexPulling;
+	else if (name == "gpu") mode = SubmitMode::GPUDriven;
+	else if (name == "meshlet") mode = SubmitMode::Meshlet;
+	else return false;
+	return true;
+}
+
+static bool isSubmitModeAvailable(SubmitMode mode) {
+	return (mode != SubmitMode::VertexPulling || vertexPullingAvailable) && (mode != SubmitMode::Meshlet || meshletsAvailable);
+}
+
 // Light constants
 constexpr int NUM_DIRECTIONAL = 1;
-constexpr int NUM_POINT = 10;
-constexpr int NUM_SPOT = 10;
-constexpr size_t NUM_CUBES = 10000;
 constexpr float WORLD_SIZE = 100.0f;
+constexpr float CUBE_BOUNDING_RADIUS = 0.8660254f; // sqrt(3) * half side length
+constexpr float NEAR_PLANE = 0.1f;
+constexpr float FAR_PLANE = 100.0f;
+constexpr float FIELD_OF_VIEW = 45.0f; // Vertical, in degrees
+constexpr float LOD_PIXEL_ERROR = 1.0f; // Largest simplification error allowed on screen
 
 std::vector<DirectionalLight> dirLights(NUM_DIRECTIONAL);
-std::vector<PointLight> pointLights(NUM_POINT);
-std::vector<SpotLight> spotLights(NUM_SPOT);
+// Light and object counts come from the command line (see BenchmarkOptions)
+int numPointLights = 0;
+int numSpotLights = 0;
+std::vector<PointLight> pointLights(BenchmarkOptions::MaxPointLights);
+std::vector<SpotLight> spotLights(BenchmarkOptions::MaxSpotLights);
 
 // Generate random rotation axis for cube based on its index
 static glm::vec3 generateAxisFromIndex(size_t index) {
@@ -80,21 +153,6 @@ static glm::vec3 generateAxisFromIndex(size_t index) {
 	return glm::normalize(axis);
 }
 
-// Frustum culling check
-bool isInFrustum(const glm::vec3& position, const glm::mat4& viewProjection) {
-	glm::vec4 clipPos = viewProjection * glm::vec4(position, 1.0f);
-
-	// Behind camera
-	if (clipPos.w <= 0.0f) return false;
-
-	glm::vec3 ndc = glm::vec3(clipPos) / clipPos.w;
-
-	// Outside screen bounds
-	return !(ndc.x < -1.0f || ndc.x > 1.0f ||
-		ndc.y < -1.0f || ndc.y > 1.0f ||
-		ndc.z < 0.0f || ndc.z > 1.0f);
-}
-
 // Input callbacks
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
 	camera.processMouseMovement(static_cast<float>(xpos), static_cast<float>(ypos));
@@ -137,6 +195,24 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 			camera.setNightMode();
 			std::cout << "Night Mode: 50mm, f/1.4, ISO 1600" << std::endl;
 			break;
+		case GLFW_KEY_O:
+			sortDraws = !sortDraws;
+			std::cout << "Draw sorting: " << (sortDraws ? "on" : "off") << std::endl;
+			break;
+		case GLFW_KEY_C:
+			octreeCulling = !octreeCulling;
+			std::cout << "Culling: " << (octreeCulling ? "octree" : "flat") << std::endl;
+			break;
+		case GLFW_KEY_V:
+			occlusionCulling = !occlusionCulling;
+			std::cout << "Occlusion culling: " << (occlusionCulling ? "on" : "off") << std::endl;
+			break;
+		case GLFW_KEY_I:
+			do {
+				submitMode = static_cast<SubmitMode>((static_cast<int>(submitMode) + 1) % static_cast<int>(SubmitMode::Count));
+			} while (!isSubmitModeAvailable(submitMode));
+			std::cout << "Submission: " << submitModeName(submitMode) << std::endl;
+			break;
 		}
 	}
 }
@@ -175,13 +251,13 @@ void processInput(GLFWwindow* window) {
 	}
 }
 
-void setupLights(GraphicsShader& shader) 
+void setupLights(GraphicsShader& shader, unsigned int seed) 
 {
 	shader.SetInt("NumDirectionalLights", NUM_DIRECTIONAL);
-	shader.SetInt("NumPointLights", NUM_POINT);
-	shader.SetInt("NumSpotLights", NUM_SPOT);
+	shader.SetInt("NumPointLights", numPointLights);
+	shader.SetInt("NumSpotLights", numSpotLights);
 
-	std::mt19937 rng(std::random_device{}());
+	std::mt19937 rng(seed);
 	std::uniform_real_distribution<float> distDir(-1.0f, 1.0f);
 	std::uniform_real_distribution<float> distPos(-50.0f, 50.0f);
 	std::uniform_real_distribution<float> distColor(0.0f, 1.0f);
@@ -198,9 +274,9 @@ void setupLights(GraphicsShader& shader)
 	}
 
 	// Setup point lights
-	if (NUM_POINT > 0)
+	if (numPointLights > 0)
 	{
-		for (int i = 0; i < NUM_POINT; ++i) {
+		for (int i = 0; i < numPointLights; ++i) {
 			pointLights[i].SetPosition(glm::vec3(distPos(rng), distPos(rng), distPos(rng)));
 			pointLights[i].SetColor(glm::vec3(distColor(rng), distColor(rng), distColor(rng)));
 			pointLights[i].SetIntensity(0.5f); // Reduced intensity
@@ -211,9 +287,9 @@ void setupLights(GraphicsShader& shader)
 
 	// Setup spot lights
 
-	if (NUM_SPOT > 0)
+	if (numSpotLights > 0)
 	{
-		for (int i = 0; i < NUM_SPOT; ++i) {
+		for (int i = 0; i < numSpotLights; ++i) {
 			spotLights[i].SetPosition(glm::vec3(distPos(rng), distPos(rng), distPos(rng)));
 			spotLights[i].SetDirection(glm::normalize(glm::vec3(distDir(rng), distDir(rng), distDir(rng))));
 			spotLights[i].SetColor(glm::vec3(distColor(rng), distColor(rng), distColor(rng)));
@@ -226,60 +302,123 @@ void setupLights(GraphicsShader& shader)
 	}
 }
 
-int main() {
-	float startProgramTime = glfwGetTime();
-
-	// Initialize GLFW
-	if (!glfwInit()) {
-		std::cerr << "Failed to initialize GLFW." << std::endl;
-		return -1;
+int main(int argc, char** argv) {
+	const std::optional<BenchmarkOptions> parsedOptions = BenchmarkOptions::Parse(argc, argv);
+	if (!parsedOptions) {
+		return 1;
 	}
+	const BenchmarkOptions& options = *parsedOptions;
 
-	// Initialize OpenGL version
-	OpenGLVersionInit(4, 6);
+	if (!options.Mode.empty() && !parseSubmitMode(options.Mode, submitMode)) {
+		std::cerr << "Unknown submission mode: " << options.Mode << std::endl;
+		BenchmarkOptions::PrintUsage(std::cerr, argv[0]);
+		return 1;
+	}
+	sortDraws = options.SortDraws;
+	octreeCulling = options.OctreeCulling;
+	occlusionCulling = options.OcclusionCulling;
+
+	// CPU-only comparison of the culling paths, no window or GL context
+	if (options.CullingBenchmark) {
+		const glm::mat4 benchmarkProjection = glm::perspective(glm::radians(FIELD_OF_VIEW),
+			static_cast<float>(options.Width) / static_cast<float>(options.Height), NEAR_PLANE, FAR_PLANE);
+		if (!RunOcclusionCheck(std::cout, benchmarkProjection)) {
+			return 1;
+		}
+		if (!RunCullingBenchmark(std::cout, WORLD_SIZE, CUBE_BOUNDING_RADIUS, benchmarkProjection, options.Frames)) {
+			return 1;
+		}
+		RunMeshletBenchmark(std::cout, WORLD_SIZE, benchmarkProjection, options.Frames);
+		return 0;
+	}
+	if (options.TransformBenchmark) {
+		RunTransformBenchmark(std::cout, options.Frames);
+		return 0;
+	}
+	if (options.ImportBenchmark) {
+		if (!RunImportCheck(std::cout)) {
+			return 1;
+		}
+		RunMeshOptimizerReport(std::cout, WORLD_SIZE);
+		return 0;
+	}
 
-	// Window setup
-	constexpr bool fullscreen = true;
-	GLFWwindow* window;
-	uint32_t modeWidth = 1920;
-	uint32_t modeHeight = 1080;
+	const bool headless = options.Headless;
+	const size_t numCubes = options.Cubes;
+	numPointLights = options.PointLights;
+	numSpotLights = options.SpotLights;
+
+	// Headless runs render into an offscreen framebuffer of the requested size, the context outlives all GL objects below
+	OffscreenContext offscreenContext;
+	std::unique_ptr<FrameBufferObject> offscreenTarget;
+	GLFWwindow* window = nullptr;
+	uint32_t modeWidth = options.Width;
+	uint32_t modeHeight = options.Height;
+
+	if (headless) {
+		if (!offscreenContext.Create(4, 6)) {
+			std::cerr << "Failed to create an offscreen OpenGL 4.6 context." << std::endl;
+			return -1;
+		}
 
-	if (!fullscreen) {
-		window = glfwCreateWindow(modeWidth, modeHeight, "Learn OpenGL", nullptr, nullptr);
+		offscreenTarget = std::make_unique<FrameBufferObject>(modeWidth, modeHeight);
+		if (!offscreenTarget->IsComplete()) {
+			std::cerr << "Offscreen framebuffer is incomplete." << std::endl;
+			return -1;
+		}
+		offscreenTarget->Bind();
 	}
 	else {
-		GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-		const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+		// Initialize GLFW
+		if (!glfwInit()) {
+			std::cerr << "Failed to initialize GLFW." << std::endl;
+			return -1;
+		}
 
-		window = glfwCreateWindow(mode->width, mode->height, "Learn OpenGL", monitor, nullptr);
+		// Initialize OpenGL version
+		OpenGLVersionInit(4, 6);
 
-		modeWidth = static_cast<uint32_t>(mode->width);
-		modeHeight = static_cast<uint32_t>(mode->height);
-	}
+		// Window setup
+		constexpr bool fullscreen = true;
 
-	if (!window) {
-		glfwTerminate();
-		return -1;
-	}
+		if (!fullscreen) {
+			window = glfwCreateWindow(modeWidth, modeHeight, "Learn OpenGL", nullptr, nullptr);
+		}
+		else {
+			GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+			const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+
+			window = glfwCreateWindow(mode->width, mode->height, "Learn OpenGL", monitor, nullptr);
+
+			modeWidth = static_cast<uint32_t>(mode->width);
+			modeHeight = static_cast<uint32_t>(mode->height);
+		}
+
+		if (!window) {
+			glfwTerminate();
+			return -1;
+		}
 
-	// Setup window
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-	glfwMakeContextCurrent(window);
-	glfwSetKeyCallback(window, key_callback);
-	glfwSetCursorPosCallback(window, mouse_callback);
-	glfwSetScrollCallback(window, scroll_callback);
-
-	// Initialize GLEW
-	if (glewInit() != GLEW_OK) {
-		std::cerr << "Error: GLEW initialization failed!" << std::endl;
-		return -2;
+		// Setup window
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+		glfwMakeContextCurrent(window);
+		glfwSetKeyCallback(window, key_callback);
+		glfwSetCursorPosCallback(window, mouse_callback);
+		glfwSetScrollCallback(window, scroll_callback);
+
+		// Initialize GLEW
+		if (glewInit() != GLEW_OK) {
+			std::cerr << "Error: GLEW initialization failed!" << std::endl;
+			return -2;
+		}
+
+		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+		glfwSwapInterval(0); // Disable vsync
 	}
 
 	// OpenGL setup
 	glEnable(GL_MULTISAMPLE);
 	glViewport(0, 0, modeWidth, modeHeight);
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-	glfwSwapInterval(0); // Disable vsync
 
 	std::cout << "OpenGL version: " << glGetString(GL_VERSION) << std::endl;
 
@@ -290,7 +429,31 @@ int main() {
 
 	// Initialize shader and mesh
 	GraphicsShader shader("../Application/Resources/Shaders/TestLight.shader");
-	Cube cubeMesh;
+	vertexPullingAvailable = submitMode == SubmitMode::VertexPulling;
+	MeshRegistry meshRegistry(vertexPullingAvailable ? MeshRegistry::VertexPulling::Enabled : MeshRegistry::VertexPulling::Disabled);
+	const MeshHandle cubeMesh = Cube::RegisterMesh(meshRegistry);
+
+	// Imported meshes are only registered for now, the scene still draws cubes
+	if (!options.ImportPath.empty()) {
+		// The first run imports the file and writes a cache next to it, later runs map the cache and upload from the mapping.
+		// The cache holds the packed 20 byte vertices the cube uses as well, so nothing is converted at load time.
+		const auto importStart = std::chrono::steady_clock::now();
+		MeshCacheFile meshCache;
+		if (meshCache.OpenOrImport<VertexPackedPosNormalTangentUV3D>(options.ImportPath)) {
+			size_t importedVertices = 0;
+			size_t importedTriangles = 0;
+			for (const MeshCacheFile::Mesh& mesh : meshCache.GetMeshes()) {
+				importedVertices += mesh.VertexCount;
+				importedTriangles += mesh.IndexCount / 3;
+				meshRegistry.Register<VertexPackedPosNormalTangentUV3D>(options.ImportPath + ":" + std::string(mesh.Name),
+					MeshCacheFile::GetVertices<VertexPackedPosNormalTangentUV3D>(mesh), mesh.Indices, mesh.IndexCount, mesh.IndexType, mesh.Lods);
+			}
+			const double importMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - importStart).count();
+			std::cout << "Loaded " << options.ImportPath << ": " << meshCache.GetMeshes().size() << " meshes, " << importedVertices
+				<< " vertices, " << importedTriangles << " triangles in " << importMs << " ms on "
+				<< JobSystem::GetInstance().GetThreadCount() << " threads" << std::endl;
+		}
+	}
 
 	// Setup camera
 	camera.setMovementSpeed(5.0f);
@@ -298,16 +461,19 @@ int main() {
 
 	// Setup initial matrices
 	glm::mat4 projection = glm::perspective(
-		glm::radians(45.0f),
+		glm::radians(FIELD_OF_VIEW),
 		static_cast<float>(modeWidth) / static_cast<float>(modeHeight),
-		0.1f, 100.0f
+		NEAR_PLANE, FAR_PLANE
 	);
 
 	shader.Bind();
 	shader.SetMat4("projection", projection);
 
+	// Headless runs use a fixed seed so results are comparable between runs
+	const unsigned int sceneSeed = headless ? 0x5EEDu : std::random_device{}();
+
 	// Setup lighting
-	setupLights(shader);
+	setupLights(shader, sceneSeed);
 
 	// Sky color
 	bool BlackSky = true;
@@ -315,108 +481,427 @@ int main() {
 	glm::vec3 skyColor = glm::vec3(0.53f, 0.81f, 0.92f) * glm::vec3(!BlackSky);
 
 	// Generate cubes
-	std::vector<Cube> cubes(NUM_CUBES);
-	std::vector<MaterialData> materials(NUM_CUBES);
+	std::vector<Cube> cubes(numCubes);
+	MaterialTable materials;
 	std::vector<DrawCommand> drawCommands(cubes.size());
 
 
 	// Random number generators
-	std::mt19937 posRng(std::random_device{}());
-	std::mt19937 matRng(std::random_device{}());
+	std::mt19937 posRng(sceneSeed);
+	std::mt19937 matRng(sceneSeed + 1);
 	std::uniform_real_distribution<float> posDist(-WORLD_SIZE, WORLD_SIZE);
 	std::uniform_real_distribution<float> colorDist(0.1f, 0.9f); // Avoid pure black/white
 
 	// Generate cube positions
-	for (auto& cube : cubes) {
+	for (size_t i = 0; i < numCubes; ++i) {
 		glm::vec3 pos(posDist(posRng), posDist(posRng), posDist(posRng));
-		cube.position = pos;
+		cubes[i].position = pos;
+		cubes[i].mesh = cubeMesh;
+		drawCommands[i] = { cubeMesh, i };
 	}
 
 	// Generate materials with better values for PBR-like lighting
-	for (size_t i = 0; i < NUM_CUBES; ++i) {
+	for (size_t i = 0; i < numCubes; ++i) {
+		MaterialData material;
 		// Ambient should be quite low since we have proper lighting
-		materials[i].Color = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng));
-		materials[i].Intensity = colorDist(matRng) * 0.5f + 0.5f; // 0.5 - 1.0 range for more visible colors
-		materials[i].Ambient = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng)) * 0.1f;
-		materials[i].Diffuse = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng));
-		materials[i].Specular = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng)) * 0.3f;
-		materials[i].Shininess = colorDist(matRng) * 96.0f; // 32-128 range for better specular highlights
+		material.Color = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng));
+		material.Intensity = colorDist(matRng) * 0.5f + 0.5f; // 0.5 - 1.0 range for more visible colors
+		material.Ambient = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng)) * 0.1f;
+		material.Diffuse = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng));
+		material.Specular = glm::vec3(colorDist(matRng), colorDist(matRng), colorDist(matRng)) * 0.3f;
+		material.Shininess = colorDist(matRng) * 96.0f; // 32-128 range for better specular highlights
+		materials.Add(material);
+	}
+
+	// All draw paths read materials by index from the material table
+	materials.Upload();
+	materials.Bind();
+
+	// Visible instances, and for indirect submission one command per visible cube (baseInstance points at
+	// its instance slot), are written straight into persistently mapped memory, one region per frame in flight
+	constexpr GLsizeiptr STREAM_ALIGNMENT_SLACK = 4096;
+	StreamBuffer frameStream(static_cast<GLsizeiptr>(numCubes * (sizeof(InstanceData) + sizeof(DrawElementsIndirectCommand)))
+		+ STREAM_ALIGNMENT_SLACK);
+
+	// Consecutive commands whose meshes share a geometry pool (and therefore a VAO) are submitted together
+	struct IndirectRun {
+		uint32_t pool;
+		MeshHandle mesh;
+		GLsizei firstCommand;
+		GLsizei commandCount;
+	};
+	std::vector<IndirectRun> indirectRuns;
+
+	// Consecutive instances with the same mesh and detail level share one instanced draw
+	struct InstanceRun {
+		MeshHandle mesh;
+		uint32_t lod;
+		uint32_t firstInstance;
+		GLsizei instanceCount;
+	};
+	std::vector<InstanceRun> instanceRuns;
+
+	// Simplification errors are projected with the same field of view as the frame
+	const float lodScale = MeshRegistry::GetLodScale(glm::radians(FIELD_OF_VIEW), static_cast<float>(modeHeight));
+
+	// Visible draws ordered by pass, shader, mesh, depth and material
+	RenderQueue renderQueue;
+	renderQueue.Reserve(numCubes);
+	const uint32_t shaderSortId = 0; // Only one program today
+
+	// Spin parameters are fixed per cube: the CPU paths rebuild matrices from them in SIMD batches,
+	// the GPU-driven path gets them with the object bounds, uploaded once
+	TransformSystem transforms;
+	transforms.Reserve(numCubes);
+	CullingSystem culling;
+	culling.Reserve(numCubes);
+	LooseOctree sceneTree(glm::vec3(0.0f), WORLD_SIZE);
+	sceneTree.Reserve(numCubes);
+	std::vector<uint32> treeVisible;
+	treeVisible.reserve(numCubes);
+	OcclusionCuller occlusion;
+	std::vector<glm::vec4> cubeSpheres(numCubes);
+	std::vector<CullObject> cullObjects(numCubes);
+	for (size_t i = 0; i < numCubes; ++i) {
+		const glm::vec3 axis = generateAxisFromIndex(i);
+		const float degreesPerSecond = 20.0f + (i % 5) * 10.0f;
+
+		transforms.Add(cubes[i].position, axis, degreesPerSecond);
+		culling.Add(cubes[i].position, CUBE_BOUNDING_RADIUS);
+		sceneTree.Insert(static_cast<uint32>(i), cubes[i].position, CUBE_BOUNDING_RADIUS);
+		cubeSpheres[i] = glm::vec4(cubes[i].position, CUBE_BOUNDING_RADIUS);
+
+		cullObjects[i].PositionRadius = glm::vec4(cubes[i].position, CUBE_BOUNDING_RADIUS);
+		cullObjects[i].AxisSpeed = glm::vec4(axis, degreesPerSecond);
+		cullObjects[i].MaterialIndex = static_cast<uint32_t>(i);
+	}
+
+	GPUCullingPass gpuCulling("../Application/Resources/Shaders/FrustumCull.shader");
+	gpuCulling.UploadObjects(cullObjects);
+
+	// Meshlet mode draws a terrain instead of the cubes; the CPU culler runs alongside to check the compute pass.
+	// Both round differently, so a meshlet touching a plane to within float precision may land on either side.
+	constexpr uint32_t TERRAIN_TILES_PER_SIDE = 147;
+	constexpr uint32_t MESHLET_COUNT_TOLERANCE = 2;
+	const glm::mat4 terrainModel(1.0f);
+	meshletsAvailable = submitMode == SubmitMode::Meshlet;
+	std::unique_ptr<MeshletMesh> terrainMesh;
+	std::unique_ptr<MeshletCullingPass> meshletCulling;
+	if (meshletsAvailable) {
+		const TerrainGrid terrain = TerrainGrid::Generate(WORLD_SIZE, TERRAIN_TILES_PER_SIDE);
+		terrainMesh = std::make_unique<MeshletMesh>(std::span<const VertexPosNormalTangentUV3D>(terrain.Vertices),
+			std::span<const uint32_t>(terrain.Indices));
+		meshletCulling = std::make_unique<MeshletCullingPass>("../Application/Resources/Shaders/MeshletCull.shader");
+		std::cout << "Terrain: " << terrain.Indices.size() / 3 << " triangles in " << terrainMesh->GetMeshletCount() << " meshlets" << std::endl;
+	}
+	uint32_t cpuVisibleMeshlets = 0;
+	size_t meshletMismatches = 0;
+
+	// Headless runs follow a scripted camera path with a fixed time step, so every run renders the same frames
+	const CameraPath cameraPath(WORLD_SIZE, options.Frames);
+	constexpr float HEADLESS_TIME_STEP = 1.0f / 60.0f;
+	FrameTimings frameTimings;
+	if (headless) {
+		frameTimings.Reserve(options.Frames);
+		std::cout << "Headless benchmark: " << options.Frames << " frames, " << numCubes << " cubes, "
+			<< numPointLights << " point / " << numSpotLights << " spot lights, "
+			<< modeWidth << "x" << modeHeight << ", " << submitModeName(submitMode)
+			<< (sortDraws ? ", sorted" : ", unsorted") << (octreeCulling ? ", octree culling" : ", flat culling")
+			<< (occlusionCulling ? " + occlusion" : "") << std::endl;
 	}
 
 	// Render loop
+	using Clock = std::chrono::steady_clock;
+	JobSystem& jobs = JobSystem::GetInstance();
 	size_t renderedCubes = 0;
-	while (!glfwWindowShouldClose(window)) {
-		float currentFrame = static_cast<float>(glfwGetTime());
+	size_t occludedCubes = 0;
+	float frameTimeAccum = 0.0f;
+	int frameCount = 0;
+	while (headless ? frameCount < static_cast<int>(options.Frames) : !glfwWindowShouldClose(window)) {
+		const Clock::time_point frameStart = Clock::now();
+
+		float currentFrame = headless ? frameCount * HEADLESS_TIME_STEP : static_cast<float>(glfwGetTime());
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		processInput(window);
-		glfwPollEvents();
+		if (headless) {
+			const CameraPath::Sample pathSample = cameraPath.Evaluate(static_cast<uint32_t>(frameCount));
+			camera.setPosition(pathSample.Position);
+			camera.lookAt(pathSample.Target);
+		}
+		else {
+			processInput(window);
+			glfwPollEvents();
+		}
+
+		GLStateCache::GetInstance().ResetFrameCounters();
+		jobs.BeginFrame();
+		frameStream.BeginFrame();
+		occludedCubes = 0;
 
 		glClearColor(skyColor.r, skyColor.g, skyColor.b, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		glm::mat4 view = camera.getViewMatrix();
 		glm::mat4 viewProjection = projection * view;
+		const Frustum frustum = Frustum::FromMatrix(viewProjection);
 
+		// GPU-driven mode culls and builds the transforms in a compute pass instead of the CPU loop below
+		if (submitMode == SubmitMode::GPUDriven) {
+			gpuCulling.Run(frustum, currentFrame,
+				meshRegistry.MakeIndirectCommand(cubeMesh, 0, 0));
+		}
+
+		// The count is only read back for the stats, the CPU check runs on those frames; the GPU run comes
+		// last, its commands are the ones drawn
+		const bool readMeshletCount = headless || (frameCount + 1) % 60 == 0;
+		if (submitMode == SubmitMode::Meshlet) {
+			if (readMeshletCount) {
+				cpuVisibleMeshlets = meshletCulling->RunCPU(*terrainMesh, viewProjection, terrainModel, camera.getPosition(), 0);
+			}
+			meshletCulling->RunGPU(*terrainMesh, viewProjection, terrainModel, camera.getPosition(), 0);
+		}
+
+		// Only materials edited since the last frame are re-uploaded
+		materials.Upload();
+
+		shader.Bind();
 		shader.SetMat4("view", view);
 		shader.SetMat4("projection", projection);
 		shader.SetVec3("ViewPos", camera.getPosition());
 
-		// ===    ===
-		std::for_each(std::execution::par, cubes.begin(), cubes.end(),
-			[&](const Cube& cube) {
-				size_t i = &cube - &cubes[0]; // 
-				DrawCommand cmd{};
-				cmd.materialIndex = i;
+		if (submitMode != SubmitMode::GPUDriven && submitMode != SubmitMode::Meshlet) {
+			// Transforms are rebuilt by jobs while culling runs; the queue is built from the survivors
+			// while transform jobs may still run, they only have to finish before instances are packed
+			JobCounter transformsDone;
+
+			// One time sample for every cube this frame
+			auto transformPass = [&](size_t begin, size_t end) {
+				transforms.UpdateRange(currentFrame, begin, end);
+			};
+			jobs.ParallelForAsync(numCubes, TransformSystem::TaskGrainSize, transformPass, transformsDone);
+
+			// Bounding spheres against the frustum planes: either every sphere in cube order,
+			// or only those in octree nodes that overlap the frustum
+			std::span<const uint32> visibleCubes;
+			if (octreeCulling) {
+				sceneTree.Query(frustum, treeVisible);
+				visibleCubes = treeVisible;
+			}
+			else {
+				culling.Cull(frustum);
+				visibleCubes = culling.GetVisible();
+			}
+
+			// Occluders are rasterized from this frame's model matrices, so this waits for the transforms
+			if (occlusionCulling) {
+				jobs.Wait(transformsDone);
+				occlusion.Cull(view, projection, visibleCubes, cubeSpheres, transforms.GetModels());
+				occludedCubes = occlusion.GetStats().Occluded;
+				visibleCubes = occlusion.GetVisible();
+			}
+
+			// Queue the survivors, then sort front-to-back with minimal state changes
+			renderQueue.Clear();
+			for (const uint32 i : visibleCubes) {
+				const float viewDepth = -(view * glm::vec4(cubes[i].position, 1.0f)).z;
+				const float depth01 = (viewDepth - NEAR_PLANE) / (FAR_PLANE - NEAR_PLANE);
+				drawCommands[i].lod = meshRegistry.SelectLod(drawCommands[i].mesh, viewDepth, lodScale, 1.0f, LOD_PIXEL_ERROR);
+				renderQueue.Push(SortKey::Make(RenderPass::Opaque, shaderSortId, drawCommands[i].mesh.Index, i, depth01), i);
+			}
+			if (sortDraws) {
+				renderQueue.Sort();
+			}
+
+			jobs.Wait(transformsDone);
+		}
 
-				// -
-				if (!isInFrustum(cube.position, viewProjection)) {
-					cmd.visible = false;
+		// ===     ===
+		renderedCubes = 0;
+		if (numPointLights > 0) {
+			pointLights[0].SetPosition(camera.getPosition());
+			pointLights[0].SetAttenuation(1.0f, 0.045f, 0.0075f);
+			pointLights[0].Apply(&shader, 0);
+		}
+
+		shader.SetBool("UseInstancing", submitMode != SubmitMode::PerDraw);
+		shader.SetBool("UseVertexPulling", submitMode == SubmitMode::VertexPulling);
+
+		if (submitMode == SubmitMode::Instanced) {
+			instanceRuns.clear();
+			const std::span<const RenderItem> items = renderQueue.GetItems();
+			StreamBuffer::Allocation instanceAllocation;
+			const std::span<InstanceData> frameInstances = frameStream.Allocate<InstanceData>(items.size(), instanceAllocation);
+			for (uint32_t slot = 0; slot < frameInstances.size(); ++slot) {
+				const RenderItem& item = items[slot];
+				const DrawCommand& cmd = drawCommands[item.CommandIndex];
+
+				InstanceData& instance = frameInstances[slot];
+				instance.model = transforms.GetModel(item.CommandIndex);
+				instance.materialIndex = static_cast<uint32_t>(cmd.materialIndex);
+
+				// Levels follow view depth, so front-to-back order keeps the runs long
+				if (instanceRuns.empty() || instanceRuns.back().mesh != cmd.mesh || instanceRuns.back().lod != cmd.lod) {
+					instanceRuns.push_back({ cmd.mesh, cmd.lod, slot, 0 });
+				}
+				instanceRuns.back().instanceCount++;
+			}
+
+			renderedCubes = frameInstances.size();
+			if (renderedCubes > 0) {
+				frameStream.BindRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceAllocation);
+				for (const InstanceRun& run : instanceRuns) {
+					meshRegistry.DrawInstanced(run.mesh, run.instanceCount, run.lod, run.firstInstance);
+				}
+			}
+		}
+		else if (submitMode == SubmitMode::MultiDrawIndirect || submitMode == SubmitMode::VertexPulling) {
+			// Pulled commands address one word buffer shared by every vertex format, so they need no runs
+			const bool pulling = submitMode == SubmitMode::VertexPulling;
+			indirectRuns.clear();
+			const std::span<const RenderItem> items = renderQueue.GetItems();
+			StreamBuffer::Allocation instanceAllocation;
+			StreamBuffer::Allocation commandAllocation;
+			const std::span<InstanceData> frameInstances = frameStream.Allocate<InstanceData>(items.size(), instanceAllocation);
+			const std::span<DrawElementsIndirectCommand> frameCommands =
+				frameStream.Allocate<DrawElementsIndirectCommand>(frameInstances.size(), commandAllocation);
+			for (uint32_t slot = 0; slot < frameCommands.size(); ++slot) {
+				const RenderItem& item = items[slot];
+				const DrawCommand& cmd = drawCommands[item.CommandIndex];
+
+				InstanceData& instance = frameInstances[slot];
+				instance.model = transforms.GetModel(item.CommandIndex);
+				instance.materialIndex = static_cast<uint32_t>(cmd.materialIndex);
+
+				if (pulling) {
+					instance.vertexFormat = meshRegistry.GetVertexFormat(cmd.mesh);
+					frameCommands[slot] = meshRegistry.MakePulledIndirectCommand(cmd.mesh, slot, 1, cmd.lod);
+					continue;
 				}
-				else {
-					cmd.visible = true;
-					glm::mat4 model = glm::mat4(1.0f);
-					model = glm::translate(model, cube.position);
 
-					glm::vec3 axis = generateAxisFromIndex(i);
-					float angle = glfwGetTime() * (20.0f + (i % 5) * 10.0f);
-					model = glm::rotate(model, glm::radians(angle), axis);
+				frameCommands[slot] = meshRegistry.MakeIndirectCommand(cmd.mesh, slot, 1, cmd.lod);
 
-					cmd.model = model;
+				const uint32_t pool = meshRegistry.GetPoolIndex(cmd.mesh);
+				if (indirectRuns.empty() || indirectRuns.back().pool != pool) {
+					indirectRuns.push_back({ pool, cmd.mesh, static_cast<GLsizei>(slot), 0 });
 				}
-				drawCommands[i] = cmd;
-			});
+				indirectRuns.back().commandCount++;
+			}
 
-		// ===     ===
-		renderedCubes = 0;
-		pointLights[0].SetPosition(camera.getPosition());
-		pointLights[0].SetAttenuation(1.0f, 0.045f, 0.0075f);
-		pointLights[0].Apply(&shader, 0);
+			renderedCubes = frameCommands.size();
+			if (renderedCubes > 0) {
+				frameStream.BindRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceAllocation);
+				frameStream.Bind(GL_DRAW_INDIRECT_BUFFER);
 
-		for (const auto& cmd : drawCommands) {
-			if (!cmd.visible) continue;
+				if (pulling) {
+					meshRegistry.MultiDrawIndirectPulled(commandAllocation.Offset, static_cast<GLsizei>(frameCommands.size()));
+				}
+				for (const IndirectRun& run : indirectRuns) {
+					const GLintptr offset = commandAllocation.Offset
+						+ run.firstCommand * static_cast<GLintptr>(sizeof(DrawElementsIndirectCommand));
+					meshRegistry.MultiDrawIndirect(run.mesh, offset, run.commandCount);
+				}
+			}
+		}
+		else if (submitMode == SubmitMode::GPUDriven) {
+			gpuCulling.Draw(meshRegistry, cubeMesh);
 
-			shader.SetMat4("model", cmd.model);
+			// Reading the count back waits for the GPU, so only do it when the stats are printed
+			if (headless || (frameCount + 1) % 60 == 0) {
+				renderedCubes = gpuCulling.ReadVisibleCount();
+			}
+		}
+		else if (submitMode == SubmitMode::Meshlet) {
+			// One instance for the whole terrain, every command points at it with baseInstance 0
+			StreamBuffer::Allocation instanceAllocation;
+			const std::span<InstanceData> terrainInstance = frameStream.Allocate<InstanceData>(1, instanceAllocation);
+			if (!terrainInstance.empty()) {
+				terrainInstance[0] = InstanceData{ terrainModel, 0, 0, { 0, 0 } };
+				frameStream.BindRange(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, instanceAllocation);
+				meshletCulling->Draw(*terrainMesh);
+			}
+
+			if (readMeshletCount) {
+				const uint32_t gpuVisible = meshletCulling->ReadVisibleCount();
+				renderedCubes = gpuVisible;
+				if (std::max(gpuVisible, cpuVisibleMeshlets) - std::min(gpuVisible, cpuVisibleMeshlets) > MESHLET_COUNT_TOLERANCE) {
+					std::cerr << "ERROR::MESHLET::CPU_GPU_MISMATCH frame " << frameCount << ": GPU " << gpuVisible
+						<< ", CPU " << cpuVisibleMeshlets << " visible meshlets" << std::endl;
+					++meshletMismatches;
+				}
+			}
+		}
+		else {
+			for (const RenderItem& item : renderQueue.GetItems()) {
+				const DrawCommand& cmd = drawCommands[item.CommandIndex];
+
+				shader.SetMat4("model", transforms.GetModel(item.CommandIndex));
+				shader.SetInt("DrawMaterialIndex", static_cast<int>(cmd.materialIndex));
+
+				meshRegistry.Draw(cmd.mesh, cmd.lod);
+				renderedCubes++;
+			}
+		}
 
-			const MaterialData& material = materials[cmd.materialIndex];
-			shader.SetVec3("Material.Color", material.Color);
-			shader.SetFloat("Material.Intensity", material.Intensity);
-			shader.SetVec3("Material.Ambient", material.Ambient);
-			shader.SetVec3("Material.Diffuse", material.Diffuse);
-			shader.SetVec3("Material.Specular", material.Specular);
-			shader.SetFloat("Material.Shininess", material.Shininess);
+		// The region written this frame is reused once the GPU has passed this point
+		frameStream.EndFrame();
 
-			cubeMesh.Draw();
-			renderedCubes++;
+		const Clock::time_point submitEnd = Clock::now();
+		const JobSystem::FrameStats jobStats = jobs.GetFrameStats();
+
+		if (headless) {
+			// Wait for the GPU so the frame time includes the rendering it caused
+			glFinish();
+
+			const std::chrono::duration<double, std::milli> cpuTime = submitEnd - frameStart;
+			const std::chrono::duration<double, std::milli> totalTime = Clock::now() - frameStart;
+			frameTimings.Add({ cpuTime.count(), totalTime.count(), renderedCubes, occludedCubes,
+				jobStats.JobsExecuted, jobStats.Steals, jobStats.WorkerUtilization });
+			++frameCount;
+			continue;
 		}
 
 		glfwSwapBuffers(window);
 
-		static int frameCount = 0;
+		frameTimeAccum += deltaTime;
 		if (++frameCount % 60 == 0) {
-			std::cout << "Rendered cubes: " << renderedCubes << "/" << NUM_CUBES << std::endl;
+			if (submitMode == SubmitMode::Meshlet) {
+				std::cout << "Rendered meshlets: " << renderedCubes << "/" << terrainMesh->GetMeshletCount();
+			}
+			else {
+				std::cout << "Rendered cubes: " << renderedCubes << "/" << numCubes;
+			}
+			std::cout << " (" << submitModeName(submitMode) << ", "
+				<< frameTimeAccum / 60.0f * 1000.0f << " ms/frame)" << std::endl;
+			if (occlusionCulling && submitMode != SubmitMode::GPUDriven && submitMode != SubmitMode::Meshlet) {
+				std::cout << "Occluded cubes: " << occludedCubes << " (" << occlusion.GetStats().Occluders
+					<< " occluders, " << occlusion.GetStats().Tested << " tested)" << std::endl;
+			}
+			if (sortDraws && submitMode != SubmitMode::GPUDriven && submitMode != SubmitMode::Meshlet) {
+				const RenderQueue::Stats& queueStats = renderQueue.GetStats();
+				std::cout << "State changes: " << queueStats.StateChangesSorted
+					<< " (saved " << queueStats.GetSaved() << " by sorting)" << std::endl;
+			}
+			const GLStateCache::Counters& glCounters = GLStateCache::GetInstance().GetFrameCounters();
+			std::cout << "GL binds: " << glCounters.GetTotalIssued() << " issued, "
+				<< glCounters.GetTotalSkipped() << " skipped" << std::endl;
+			std::cout << "Stream buffer: " << frameStream.GetFrameUsage() / 1024 << "/" << frameStream.GetFrameSize() / 1024
+				<< " KB per frame, " << frameStream.GetStallCount() << " stalls" << std::endl;
+			std::cout << "Jobs: " << jobStats.JobsExecuted << " (" << jobStats.Steals << " stolen) on "
+				<< jobs.GetThreadCount() << " threads, worker utilization "
+				<< jobStats.WorkerUtilization * 100.0f << "%" << std::endl;
+			frameTimeAccum = 0.0f;
+		}
+	}
+
+	if (headless) {
+		frameTimings.PrintFrames(std::cout);
+		frameTimings.PrintSummary(std::cout);
+		if (meshletMismatches > 0) {
+			std::cerr << "Meshlet culling: GPU and CPU disagreed in " << meshletMismatches << " frames" << std::endl;
+			return 1;
 		}
+		return 0;
 	}
 
 	glfwTerminate();
@@ -10,6 +10,16 @@ newoption {
     description = "Enable the use of the Clang toolset for building the project, if available. Clang is a highly optimized compiler for C/C++ languages, known for its fast compilation and modern features."
 }
 
+newoption {
+    trigger = "enable_avx2",
+    description = "Compile with AVX2 and FMA. SIMD kernels (e.g. the transform pass) switch from 4-wide SSE2 to 8-wide AVX2 batches; the binary then requires a Haswell or newer CPU."
+}
+
+newoption {
+    trigger = "disable_dsa",
+    description = "Edit buffers and vertex arrays by binding them (GL 3.3 style) instead of through GL 4.5 direct state access. Only useful to compare the two paths or for drivers with broken DSA."
+}
+
 -- Set up the workspace
 workspace(path.getbasename(os.getcwd())) -- Get the current working directory and use its name as the workspace name
 configurations {"Debug", "Release"} -- Define build configurations
@@ -40,6 +50,15 @@ filter {"toolset:clang"}
 defines {"CLANG"}
 buildoptions {"-msse2"} -- Для GCC або Clang
 
+filter {"options:enable_avx2", "toolset:msc*"}
+buildoptions {"/arch:AVX2"} -- MSVC defines __AVX2__ under /arch:AVX2
+
+filter {"options:enable_avx2", "toolset:gcc or clang"}
+buildoptions {"-mavx2", "-mfma"}
+
+filter {"options:disable_dsa"}
+defines {"DISABLE_DSA"}
+
 filter {"platforms:Win32"}
 architecture "x86"
 
@@ -163,4 +182,4 @@ filter "system:windows"
 links {"opengl32"}
 
 filter "system:linux"
-links {"X11", "pthread", "dl", "GL", "glfw"}
+links {"X11", "pthread", "dl", "GL", "EGL", "glfw"} -- EGL provides the surfaceless context for --headless